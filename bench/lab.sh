@@ -0,0 +1,258 @@
+#!/usr/bin/env bash
+# Laboratorio reproducible para medir el escáner: cada host de hosts.conf es un network namespace con
+# un par veth hacia el namespace principal, su firewall (puertos descartados), netem (retardo y pérdida)
+# y bench_target con los puertos abiertos. Se escanea cada host con cada motor, se mide con
+# bench_measure (pared, CPU, RSS máximo) y se compara el resultado contra la verdad del laboratorio
+#
+#   sudo bench/lab.sh run [--save-baseline]   arma, mide, compara contra baseline.tsv y desarma
+#   sudo bench/lab.sh up | down               solo arma o desarma (para probar a mano)
+#
+# Variables: BENCH_ENGINES ("threads reactor pipeline"), BENCH_RUNS (3, se queda la mediana),
+# BENCH_ARGS (opciones extra del escáner), BENCH_TOLERANCE (% antes de marcar regresión, 10),
+# BENCH_HOSTS (hosts.conf), ESCANER (./escaner)
+set -euo pipefail
+
+BENCH_DIR=$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)
+ROOT=$(dirname "$BENCH_DIR")
+ESCANER=${ESCANER:-$ROOT/escaner}
+TARGET=$BENCH_DIR/bin/bench_target
+MEASURE=$BENCH_DIR/bin/bench_measure
+HOSTS_FILE=${BENCH_HOSTS:-$BENCH_DIR/hosts.conf}
+BASELINE=$BENCH_DIR/baseline.tsv
+OUT=$BENCH_DIR/out
+ENGINES=${BENCH_ENGINES:-threads reactor pipeline}
+RUNS=${BENCH_RUNS:-3}
+SCAN_ARGS=${BENCH_ARGS:---timeout 1000}
+TOLERANCE=${BENCH_TOLERANCE:-10}
+
+PREFIX=escbench
+BASE_PORT=10000
+SEED=4242
+
+die() { echo "lab: $*" >&2; exit 1; }
+
+# nombre protocolos puertos tcp_abiertos tcp_descartados udp_abiertos udp_descartados retardo jitter pérdida
+read_hosts() {
+    grep -v '^[[:space:]]*\(#\|$\)' "$HOSTS_FILE"
+}
+
+# Reparte los puertos de un protocolo: "puerto abierto|descartado|cerrado", un puerto por línea.
+# Fisher-Yates con semilla fija, el mismo hosts.conf da siempre el mismo laboratorio
+layout() {
+    local seed=$1 count=$2 open=$3 dropped=$4
+    awk -v seed="$seed" -v base="$BASE_PORT" -v n="$count" -v open="$open" -v dropped="$dropped" 'BEGIN {
+        srand(seed)
+        for (i = 0; i < n; i++) port[i] = base + i
+        for (i = n - 1; i > 0; i--) { j = int(rand() * (i + 1)); t = port[i]; port[i] = port[j]; port[j] = t }
+        for (i = 0; i < n; i++) print port[i], (i < open ? "abierto" : (i < open + dropped ? "descartado" : "cerrado"))
+    }' | sort -n
+}
+
+ports_with() {
+    awk -v state="$1" '$2 == state { printf "%s%s", sep, $1; sep = "," }' "$2"
+}
+
+firewall() {
+    local ns=$1 tcp=$2 udp=$3
+    [[ -z $tcp && -z $udp ]] && return 0
+    if command -v nft >/dev/null; then
+        {
+            echo "table inet bench {"
+            echo "  chain input {"
+            echo "    type filter hook input priority 0; policy accept;"
+            [[ -n $tcp ]] && echo "    tcp dport { $tcp } drop"
+            [[ -n $udp ]] && echo "    udp dport { $udp } drop"
+            echo "  }"
+            echo "}"
+        } | ip netns exec "$ns" nft -f -
+    elif command -v iptables-restore >/dev/null; then
+        {
+            echo "*filter"
+            tr ',' '\n' <<<"$tcp" | awk 'NF { print "-A INPUT -p tcp --dport " $1 " -j DROP" }'
+            tr ',' '\n' <<<"$udp" | awk 'NF { print "-A INPUT -p udp --dport " $1 " -j DROP" }'
+            echo "COMMIT"
+        } | ip netns exec "$ns" iptables-restore
+    else
+        die "hacen falta nft o iptables para los puertos descartados"
+    fi
+}
+
+up() {
+    mkdir -p "$OUT"
+    [[ -x $TARGET ]] || die "falta $TARGET (make bench-tools)"
+    local index=0
+    while read -r name protos count tcp_open tcp_dropped udp_open udp_dropped delay jitter loss; do
+        local ns=$PREFIX-$name veth=ebench$index
+        ip netns add "$ns"
+        ip link add "$veth" type veth peer name eth0 netns "$ns"
+        ip addr add "10.213.$index.1/24" dev "$veth"
+        ip link set "$veth" up
+        ip netns exec "$ns" ip addr add "10.213.$index.2/24" dev eth0
+        ip netns exec "$ns" ip link set eth0 up
+        ip netns exec "$ns" ip link set lo up
+        # Sin esto el kernel limita los ICMP port unreachable y los UDP cerrados se ven abierto|filtrado
+        ip netns exec "$ns" sysctl -qw net.ipv4.icmp_ratemask=0
+
+        layout $((SEED + index)) "$count" "$tcp_open" "$tcp_dropped" > "$OUT/$name.tcp"
+        layout $((SEED + 1000 + index)) "$count" "$udp_open" "$udp_dropped" > "$OUT/$name.udp"
+        firewall "$ns" "$(ports_with descartado "$OUT/$name.tcp")" "$(ports_with descartado "$OUT/$name.udp")"
+
+        if [[ $delay != 0 || $jitter != 0 || $loss != 0 ]]; then
+            local netem="delay ${delay}ms"
+            [[ $jitter != 0 ]] && netem+=" ${jitter}ms"
+            [[ $loss != 0 ]] && netem+=" loss ${loss}%"
+            # El límite por defecto (1000 paquetes) se llena con el retardo a la tasa del escáner
+            ip netns exec "$ns" tc qdisc add dev eth0 root netem limit 100000 $netem \
+                || die "no se pudo aplicar netem en $name (¿falta el módulo sch_netem?)"
+        fi
+
+        ip netns exec "$ns" "$TARGET" --tcp "$(ports_with abierto "$OUT/$name.tcp")" \
+            --udp "$(ports_with abierto "$OUT/$name.udp")" > "$OUT/$name.target.log" 2>&1 &
+        echo $! > "$OUT/$name.pid"
+        index=$((index + 1))
+    done < <(read_hosts)
+    sleep 0.5 # Que los bench_target terminen de abrir sus puertos
+}
+
+down() {
+    local name
+    for pid_file in "$OUT"/*.pid; do
+        [[ -e $pid_file ]] || continue
+        kill "$(cat "$pid_file")" 2>/dev/null || true
+        rm -f "$pid_file"
+    done
+    # Al borrar el namespace se va también su veth (y la punta del lado principal)
+    for name in $(ip netns list | awk -v p="$PREFIX-" 'index($1, p) == 1 { print $1 }'); do
+        ip netns del "$name"
+    done
+}
+
+# Lo que debería reportar el escáner para cada puerto, en el formato de su NDJSON. Los cerrados no salen
+# en el NDJSON; un UDP descartado es abierto|filtrado, que se escribe "unknown"
+truth() {
+    local name=$1 protos=$2
+    if [[ $protos == *t* ]]; then
+        awk '{ print "TCP", $1, ($2 == "abierto" ? "open" : ($2 == "descartado" ? "filtered" : "closed")) }' "$OUT/$name.tcp"
+    fi
+    if [[ $protos == *u* ]]; then
+        awk '{ print "UDP", $1, ($2 == "abierto" ? "open" : ($2 == "descartado" ? "unknown" : "closed")) }' "$OUT/$name.udp"
+    fi
+}
+
+# % de sondeos con el estado correcto: primero la verdad, luego el NDJSON del escaneo
+accuracy() {
+    awk 'FNR == NR { expected[$1 " " $2] = $3; next }
+         match($0, /"port":[0-9]+/) {
+             port = substr($0, RSTART + 7, RLENGTH - 7)
+             match($0, /"protocol":"[A-Z]+"/); protocol = substr($0, RSTART + 12, RLENGTH - 13)
+             match($0, /"status":"[a-z]+"/); status = substr($0, RSTART + 10, RLENGTH - 11)
+             got[protocol " " port] = status
+         }
+         END {
+             for (key in expected) {
+                 total++
+                 if ((key in got ? got[key] : "closed") == expected[key]) ok++
+             }
+             printf "%.2f\n", total ? 100 * ok / total : 0
+         }' "$1" "$2"
+}
+
+# latest.tsv: host motor sondeos pared_s puertos_s cpu_s rss_kb precisión (mediana por puertos/s)
+summarize() {
+    sort -t $'\t' -k1,1 -k2,2 -k5,5n "$OUT/runs.tsv" | awk -F'\t' -v OFS='\t' '
+        { key = $1 OFS $2; rows[key, ++count[key]] = $0; if (!(key in seen)) { seen[key] = 1; order[++keys] = key } }
+        END { for (k = 1; k <= keys; k++) { key = order[k]; print rows[key, int((count[key] + 1) / 2)] } }'
+}
+
+compare() {
+    printf '%-8s %-9s %12s %10s %10s %10s\n' host motor "puertos/s" "cpu s" "RSS KB" "precisión"
+    local baseline=${1:-/dev/null}
+    awk -F'\t' -v tol="$TOLERANCE" -v baseline="$baseline" '
+        FILENAME == baseline { base[$1 "\t" $2] = $0; next }
+        {
+            line = sprintf("%-8s %-9s %12.0f %10.3f %10d %9.2f%%", $1, $2, $5, $6, $7, $8)
+            key = $1 "\t" $2
+            if (!(key in base)) { print line "  (sin baseline)"; next }
+            split(base[key], b, "\t")
+            delta = sprintf("  puertos/s %+.1f%%, cpu %+.1f%%, RSS %+.1f%%, precisión %+.2f",
+                            b[5] ? 100 * ($5 - b[5]) / b[5] : 0, b[6] ? 100 * ($6 - b[6]) / b[6] : 0,
+                            b[7] ? 100 * ($7 - b[7]) / b[7] : 0, $8 - b[8])
+            bad = ""
+            if ($5 < b[5] * (1 - tol / 100)) bad = bad " puertos/s"
+            if ($6 > b[6] * (1 + tol / 100) && $6 - b[6] > 0.05) bad = bad " cpu"
+            if ($7 > b[7] * (1 + tol / 100)) bad = bad " RSS"
+            if ($8 < b[8] - 0.5) bad = bad " precisión"
+            if (bad != "") { regressions++; print line delta "  REGRESIÓN:" bad } else print line delta
+        }
+        END { exit regressions > 0 }' "$baseline" "$OUT/latest.tsv"
+}
+
+run() {
+    local save=0
+    [[ ${1:-} == --save-baseline ]] && save=1
+    [[ $EUID -eq 0 ]] || die "hace falta root (namespaces, veth, captura)"
+    [[ -x $ESCANER && -x $MEASURE ]] || die "falta $ESCANER o $MEASURE (make && make bench-tools)"
+
+    down
+    trap down EXIT
+    up
+    : > "$OUT/runs.tsv"
+
+    local index=0
+    while read -r name protos count tcp_open tcp_dropped udp_open udp_dropped delay jitter loss; do
+        local flags=() probes=$count
+        case $protos in
+            t) ;;
+            u) flags=(-u) ;;
+            tu|ut) flags=(-tu); probes=$((count * 2)) ;;
+            *) die "$name: protocolos debe ser t, u o tu" ;;
+        esac
+        truth "$name" "$protos" > "$OUT/$name.truth"
+
+        for engine in $ENGINES; do
+            for ((r = 1; r <= RUNS; r++)); do
+                local ndjson=$OUT/$name.$engine.$r.ndjson log=$OUT/$name.$engine.$r.log
+                # shellcheck disable=SC2086
+                "$MEASURE" "$ESCANER" "10.213.$index.2" -i "ebench$index" \
+                    -p "$BASE_PORT-$((BASE_PORT + count - 1))" "${flags[@]}" --engine "$engine" \
+                    --ndjson "$ndjson" $SCAN_ARGS > "$log" 2>&1 || true
+                local measured
+                measured=$(grep '^bench_measure ' "$log" | tail -1)
+                [[ -n $measured ]] || die "$name/$engine: no se pudo medir, ver $log"
+                read -r _ wall user sys rss code <<<"$measured"
+                [[ $code == 0 ]] || die "$name/$engine: el escáner salió con $code, ver $log"
+                local acc
+                acc=$(accuracy "$OUT/$name.truth" "$ndjson")
+                printf '%s\t%s\t%d\t%s\t%.1f\t%.3f\t%s\t%s\n' "$name" "$engine" "$probes" "$wall" \
+                    "$(awk -v p="$probes" -v w="$wall" 'BEGIN { print (w > 0 ? p / w : 0) }')" \
+                    "$(awk -v u="$user" -v s="$sys" 'BEGIN { print u + s }')" "$rss" "$acc" >> "$OUT/runs.tsv"
+                echo "$name/$engine #$r: ${wall}s, precisión $acc%" >&2
+            done
+        done
+        index=$((index + 1))
+    done < <(read_hosts)
+
+    summarize > "$OUT/latest.tsv"
+    local status=0
+    if [[ -f $BASELINE ]]; then
+        compare "$BASELINE" || status=$?
+    else
+        compare || true
+        echo "(no hay $BASELINE, se guarda con: make bench-baseline)"
+    fi
+    if [[ $save == 1 ]]; then
+        cp "$OUT/latest.tsv" "$BASELINE"
+        echo "baseline guardado en $BASELINE"
+        status=0
+    fi
+    return $status
+}
+
+# bench/sim.sh lo incluye con source para usar las mismas funciones
+[[ ${BASH_SOURCE[0]} == "$0" ]] || return 0
+case ${1:-} in
+    up) up ;;
+    down) down ;;
+    run) shift; run "$@" ;;
+    *) echo "Uso: $0 run [--save-baseline] | up | down" >&2; exit 1 ;;
+esac
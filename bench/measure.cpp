@@ -0,0 +1,48 @@
+// Corre un comando y reporta lo que consumió, para bench/lab.sh (no hay /usr/bin/time en todos lados):
+//
+//   bench_measure escaner 10.213.0.2 ... -> stderr: "bench_measure <pared s> <user s> <sys s> <RSS máx KB> <salida>"
+//
+// El uso de CPU y el RSS salen de wait4() del hijo, así que solo cuentan al escáner y no al harness
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+static double seconds(const timeval& tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Uso: " << argv[0] << " COMANDO [ARGS...]" << std::endl;
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 2;
+    }
+    if (child == 0) {
+        execvp(argv[1], argv + 1);
+        perror(argv[1]);
+        _exit(127);
+    }
+
+    int status = 0;
+    rusage usage{};
+    if (wait4(child, &status, 0, &usage) < 0) {
+        perror("wait4");
+        return 2;
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+    std::cerr << std::fixed << std::setprecision(3) << "bench_measure " << wall << " " << seconds(usage.ru_utime) << " "
+              << seconds(usage.ru_stime) << " " << usage.ru_maxrss << " " << exit_code << std::endl;
+    return exit_code;
+}
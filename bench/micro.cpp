@@ -0,0 +1,381 @@
+// Micro-benchmarks de las funciones que corren por paquete o por resultado. Para cada una da ns/op,
+// allocs/op (operator new global contado) y operaciones por segundo; con --baseline compara contra una
+// corrida guardada y sale con 1 si algo se puso más lento que la tolerancia o hace más allocs
+//
+//   make microbench              corre y compara contra bench/micro_baseline.tsv (si existe)
+//   make microbench-baseline     guarda la corrida como el nuevo baseline
+//
+// Cada benchmark se calibra hasta que una repetición dura --min-time ms y se queda con la mejor de 5
+#include "sniffer.h"
+#include "JSONGen.h"
+#include "args.h"
+#include "scheduler.h"
+#include "spsc_ring.h"
+#include "pipeline.h"
+#include "mock_net.h"
+#include "utils.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+
+// Cuenta los operator new de todo el proceso (los new alineados no pasan por aquí, solo se usan al armar)
+// noinline para que GCC no vea el malloc/free por dentro y crea que no hacen par con new/delete
+static std::atomic<uint64_t> g_allocations{0};
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* memory) noexcept { std::free(memory); }
+__attribute__((noinline)) void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+namespace {
+
+    // Que el compilador no se salte el cálculo por no usar el resultado
+    template <typename T>
+    inline void keep(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    struct Measurement {
+        std::string name;
+        double ns_per_op = 0;
+        double allocs_per_op = 0;
+        double ops_per_sec = 0;
+    };
+
+    struct Options {
+        std::string filter;
+        std::string baseline;
+        std::string save;
+        double min_time_ms = 200;
+        double tolerance = 15;
+    };
+
+    // body(n) hace unas n operaciones y regresa cuántas hizo de verdad (los de contención van por rondas)
+    template <typename Body>
+    Measurement measure(const Options& options, const std::string& name, Body body) {
+        using Clock = std::chrono::steady_clock;
+        auto timed = [&](size_t iterations, size_t& ops, uint64_t& allocations) {
+            uint64_t allocations_before = g_allocations.load();
+            auto start = Clock::now();
+            ops = body(iterations);
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            allocations = g_allocations.load() - allocations_before;
+            return elapsed;
+        };
+
+        size_t ops = 0;
+        uint64_t allocations = 0;
+        size_t iterations = 1;
+        double target_ns = options.min_time_ms * 1e6;
+        double elapsed = timed(iterations, ops, allocations);
+        while (elapsed < target_ns / 10) {
+            iterations *= 10;
+            elapsed = timed(iterations, ops, allocations);
+        }
+        iterations = static_cast<size_t>(iterations * target_ns / std::max(elapsed, 1.0)) + 1;
+
+        Measurement best;
+        best.name = name;
+        for (int rep = 0; rep < 5; ++rep) {
+            elapsed = timed(iterations, ops, allocations);
+            double ns_per_op = elapsed / std::max<size_t>(ops, 1);
+            if (rep == 0 || ns_per_op < best.ns_per_op) {
+                best.ns_per_op = ns_per_op;
+                best.allocs_per_op = static_cast<double>(allocations) / std::max<size_t>(ops, 1);
+            }
+        }
+        best.ops_per_sec = 1e9 / best.ns_per_op;
+        return best;
+    }
+
+    // Tramas Ethernet + IPv4 como las que le llegan al sniffer desde el objetivo (10.0.0.2 -> 10.0.0.1)
+    std::vector<u_char> frame(uint8_t protocol, const std::vector<u_char>& l4) {
+        std::vector<u_char> data(14 + sizeof(struct ip));
+        data[12] = 0x08; // ETHERTYPE_IP
+        auto* ip_header = reinterpret_cast<struct ip*>(data.data() + 14);
+        ip_header->ip_v = 4;
+        ip_header->ip_hl = 5;
+        ip_header->ip_ttl = 64;
+        ip_header->ip_p = protocol;
+        ip_header->ip_len = htons(sizeof(struct ip) + l4.size());
+        inet_pton(AF_INET, "10.0.0.2", &ip_header->ip_src);
+        inet_pton(AF_INET, "10.0.0.1", &ip_header->ip_dst);
+        data.insert(data.end(), l4.begin(), l4.end());
+        return data;
+    }
+
+    std::vector<u_char> tcp_frame(int port, bool syn_ack) {
+        std::vector<u_char> l4(sizeof(struct tcphdr));
+        auto* tcp_header = reinterpret_cast<struct tcphdr*>(l4.data());
+        tcp_header->source = htons(port);
+        tcp_header->dest = htons(40000);
+        tcp_header->doff = 5;
+        if (syn_ack) { tcp_header->syn = 1; tcp_header->ack = 1; }
+        else { tcp_header->rst = 1; tcp_header->ack = 1; }
+        return frame(IPPROTO_TCP, l4);
+    }
+
+    std::vector<u_char> udp_frame(int port) {
+        std::vector<u_char> l4(sizeof(struct udphdr) + 3);
+        auto* udp_header = reinterpret_cast<struct udphdr*>(l4.data());
+        udp_header->uh_sport = htons(port);
+        udp_header->uh_dport = htons(40001);
+        udp_header->uh_ulen = htons(l4.size());
+        std::memcpy(l4.data() + sizeof(struct udphdr), "ok\n", 3);
+        return frame(IPPROTO_UDP, l4);
+    }
+
+    // ICMP port unreachable con el IP/UDP del sondeo original adentro
+    std::vector<u_char> icmp_unreachable(int port) {
+        std::vector<u_char> l4(8 + sizeof(struct ip) + sizeof(struct udphdr));
+        l4[0] = ICMP_UNREACH;
+        l4[1] = ICMP_UNREACH_PORT;
+        auto* orig_ip = reinterpret_cast<struct ip*>(l4.data() + 8);
+        orig_ip->ip_v = 4;
+        orig_ip->ip_hl = 5;
+        orig_ip->ip_p = IPPROTO_UDP;
+        inet_pton(AF_INET, "10.0.0.1", &orig_ip->ip_src);
+        inet_pton(AF_INET, "10.0.0.2", &orig_ip->ip_dst);
+        auto* orig_udp = reinterpret_cast<struct udphdr*>(l4.data() + 8 + sizeof(struct ip));
+        orig_udp->uh_sport = htons(40001);
+        orig_udp->uh_dport = htons(port);
+        return frame(IPPROTO_ICMP, l4);
+    }
+
+    std::vector<Measurement> run_all(const Options& options) {
+        std::vector<Measurement> results;
+        auto add = [&](const std::string& name, auto body) {
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+            results.push_back(measure(options, name, body));
+            const Measurement& m = results.back();
+            std::cerr << "  " << m.name << ": " << std::fixed << std::setprecision(1) << m.ns_per_op << " ns/op" << std::endl;
+        };
+
+        // Lo que hace el camino de captura por cada paquete: response_key para repartirlo al flujo y
+        // classify_packet con un SnifferResult nuevo, igual que packet_handler y el reactor
+        struct Frame { std::vector<u_char> data; int port; };
+        std::vector<Frame> frames = {
+            {tcp_frame(80, true), 80}, {tcp_frame(81, false), 81},
+            {udp_frame(53), 53}, {icmp_unreachable(161), 161},
+        };
+        uint32_t target_addr = 0;
+        inet_pton(AF_INET, "10.0.0.2", &target_addr);
+        auto classify = [&](const Frame& packet) {
+            ResponseKey key;
+            Sniffer::response_key(packet.data.data(), packet.data.size(), 14, target_addr, key);
+            SnifferResult result;
+            Sniffer::classify_packet(packet.data.data(), packet.data.size(), packet.data.size(), 14, packet.port, result);
+            keep(key);
+            keep(result.status);
+        };
+        const char* frame_names[] = {"tcp syn/ack", "tcp rst", "udp", "icmp unreachable"};
+        for (size_t f = 0; f < frames.size(); ++f) {
+            add(std::string("classify_packet/") + frame_names[f], [&, f](size_t n) {
+                for (size_t i = 0; i < n; ++i) classify(frames[f]);
+                return n;
+            });
+        }
+        add("classify_packet/mezcla", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) classify(frames[i & 3]);
+            return n;
+        });
+
+        const int service_ports[] = {22, 80, 443, 3306, 12345, 53, 161, 5353};
+        add("get_service_name", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                std::string name = get_service_name(service_ports[i & 7], (i & 4) ? Protocol::UDP : Protocol::TCP);
+                keep(name);
+            }
+            return n;
+        });
+
+        std::vector<unsigned char> header(16);
+        for (size_t i = 0; i < header.size(); ++i) header[i] = static_cast<unsigned char>(0x45 + i * 7);
+        add("bytes_to_hex_string/16 bytes", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                std::string hex = JSONGenerator::bytes_to_hex_string(header);
+                keep(hex);
+            }
+            return n;
+        });
+
+        for (const char* spec : {"22,80,443", "1-1024,3306,8000-8100", "1-65535"}) {
+            add(std::string("parsearPuertos/") + spec, [spec](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    std::vector<int> ports = ArgsParser::parsearPuertos(spec);
+                    keep(ports.size());
+                }
+                return n;
+            });
+        }
+
+        // Cola de tareas: N workers sacando lotes del WorkStealingScheduler alimentado por el generador,
+        // como en el motor de hilos. Una ronda son todos los puertos x TCP/UDP
+        std::vector<int> all_ports = ArgsParser::parsearPuertos("1-65535");
+        std::vector<Protocol> both = {Protocol::TCP, Protocol::UDP};
+        size_t round_tasks = all_ports.size() * both.size();
+        for (size_t workers : {1, 4}) {
+            add("scheduler/claim " + std::to_string(workers) + " hilos", [&, workers](size_t n) {
+                size_t done = 0;
+                while (done < n) {
+                    TaskGenerator generator(all_ports, both);
+                    WorkStealingScheduler scheduler(workers);
+                    scheduler.attach(generator);
+                    std::vector<std::thread> threads;
+                    for (size_t w = 0; w < workers; ++w) {
+                        threads.emplace_back([&scheduler, w] {
+                            std::vector<ScanTask> batch;
+                            while (scheduler.claim(w, batch)) keep(batch.size());
+                        });
+                    }
+                    for (auto& thread : threads) thread.join();
+                    done += round_tasks;
+                }
+                return done;
+            });
+        }
+
+        // Entre etapas del pipeline: un productor y un consumidor en hilos distintos, con el mismo backoff
+        // que usan las etapas cuando la cola está llena o vacía
+        add("spsc_ring/push+pop 2 hilos", [](size_t n) {
+            SpscRing<ScanTask> ring(1024);
+            std::thread consumer([&ring, n] {
+                ScanTask task;
+                unsigned spins = 0;
+                for (size_t received = 0; received < n;) {
+                    if (ring.try_pop(task)) {
+                        ++received;
+                        spins = 0;
+                    } else {
+                        SpscRing<ScanTask>::backoff(spins);
+                    }
+                }
+            });
+            for (size_t i = 0; i < n; ++i) ring.push(ScanTask{static_cast<int>(i & 0xffff), Protocol::TCP});
+            consumer.join();
+            return n;
+        });
+
+        // El motor pipeline entero (generador, transmisor, receptor, clasificador y sumidero) contra la red
+        // en memoria de mock_net.h: mide la tabla de flujos y el camino de salida sin kernel. Una ronda es un
+        // escaneo de todos los puertos x TCP/UDP; si algún resultado no coincide con el modelo se avisa
+        AppConfig mock_config;
+        mock_config.target_ip = "10.0.0.2";
+        mock_config.ports = all_ports;
+        mock_config.protocols_to_scan = both;
+        mock_config.max_inflight = 4096;
+        mock_config.timeout_ms = 1000;
+        add("pipeline/mock " + std::to_string(round_tasks) + " sondeos", [&](size_t n) {
+            size_t done = 0;
+            while (done < n) {
+                MockNet net(mock_config, MockNet::Model{});
+                std::vector<ScanResult> scan = Pipeline::run(mock_config, net);
+                size_t wrong = scan.size() == round_tasks ? 0 : round_tasks;
+                for (const ScanResult& result : scan) wrong += result.status != net.expected(result.protocol, result.port);
+                if (wrong > 0) std::cerr << "  pipeline/mock: " << wrong << " resultados no coinciden con el modelo" << std::endl;
+                done += round_tasks;
+            }
+            return done;
+        });
+
+        return results;
+    }
+
+    std::map<std::string, Measurement> load(const std::string& path) {
+        std::map<std::string, Measurement> baseline;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::stringstream fields(line);
+            Measurement m;
+            if (std::getline(fields, m.name, '\t') && fields >> m.ns_per_op >> m.allocs_per_op) baseline[m.name] = m;
+        }
+        return baseline;
+    }
+
+    void usage(const char* prog) {
+        std::cout << "Uso: " << prog << " [opciones]\n\n";
+        std::cout << "  --filter TEXTO            Solo los benchmarks cuyo nombre contiene TEXTO\n";
+        std::cout << "  --min-time MS             Duración de cada repetición (predeterminado: 200)\n";
+        std::cout << "  --baseline ARCHIVO        Compara contra una corrida guardada, sale con 1 si hay regresión\n";
+        std::cout << "  --tolerance PCT           Cuánto más lento se tolera antes de marcarlo (predeterminado: 15)\n";
+        std::cout << "  --save ARCHIVO            Guarda la corrida (TSV: nombre, ns/op, allocs/op)\n";
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) options.min_time_ms = std::atof(argv[++i]);
+        else if (arg == "--baseline" && i + 1 < argc) options.baseline = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc) options.tolerance = std::atof(argv[++i]);
+        else if (arg == "--save" && i + 1 < argc) options.save = argv[++i];
+        else {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::map<std::string, Measurement> baseline;
+    if (!options.baseline.empty()) {
+        baseline = load(options.baseline);
+        if (baseline.empty()) std::cerr << "(no hay baseline en " << options.baseline << ", solo se mide)" << std::endl;
+    }
+
+    std::vector<Measurement> results = run_all(options);
+
+    int regressions = 0;
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "ns/op"
+              << std::setw(12) << "allocs/op" << std::setw(14) << "ops/s" << "\n";
+    for (const Measurement& m : results) {
+        std::cout << std::left << std::setw(40) << m.name << std::right << std::fixed
+                  << std::setw(12) << std::setprecision(1) << m.ns_per_op
+                  << std::setw(12) << std::setprecision(2) << m.allocs_per_op
+                  << std::setw(14) << std::setprecision(0) << m.ops_per_sec;
+        auto it = baseline.find(m.name);
+        if (it != baseline.end()) {
+            const Measurement& base = it->second;
+            double delta = base.ns_per_op > 0 ? 100 * (m.ns_per_op - base.ns_per_op) / base.ns_per_op : 0;
+            std::cout << "   " << std::showpos << std::setprecision(1) << delta << "%" << std::noshowpos;
+            std::string bad;
+            if (delta > options.tolerance) bad += " ns/op";
+            if (m.allocs_per_op > base.allocs_per_op + 0.01) bad += " allocs/op";
+            if (!bad.empty()) {
+                std::cout << "  REGRESIÓN:" << bad;
+                ++regressions;
+            }
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+
+    if (!options.save.empty()) {
+        std::ofstream file(options.save);
+        for (const Measurement& m : results) {
+            file << m.name << '\t' << std::fixed << std::setprecision(2) << m.ns_per_op << '\t'
+                 << std::setprecision(4) << m.allocs_per_op << '\n';
+        }
+        std::cout << "baseline guardado en " << options.save << std::endl;
+        return 0;
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,523 @@
+// Simulador de red en user space sobre un TUN: una población de hosts (por defecto 10000 en 10.99.0.0/16)
+// que contestan los SYN y los sondeos UDP del escáner sin máquinas ni namespaces de por medio
+//
+//   sudo bench_netsim --hosts 10000 --rtt 5-150 --loss 0.01 &
+//   sudo ./escaner 10.99.0.17 -i escsim0 -p 1-1024 --engine reactor
+//
+// Todo sale de un hash de (semilla, IP, protocolo, puerto), así que la misma línea de comandos da siempre
+// la misma red: estado de cada puerto (abierto/cerrado/filtrado), el RTT base de cada host y qué hosts
+// son firewall (lo cerrado se descarta) o tarpit (SYN/ACK con ventana 0 en cualquier puerto TCP y nunca
+// más nada). Los ICMP port unreachable salen por un token bucket por host como el del kernel
+// (icmp_ratelimit), así que un UDP cerrado puede verse abierto|filtrado igual que en una red de verdad
+//
+// Con --truth IP -p PUERTOS imprime lo que debería ver el escáner en ese host (el formato de bench/lab.sh)
+// y con --sample N imprime N hosts repartidos en la población; ninguno de los dos abre el TUN
+#include "args.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+namespace {
+
+    volatile sig_atomic_t g_stop = 0;
+
+    void on_signal(int) { g_stop = 1; }
+
+    struct Config {
+        std::string device = "escsim0";
+        uint32_t network = 0x0a630000; // 10.99.0.0, en orden de host
+        int prefix = 16;
+        uint32_t hosts = 10000;
+        double open = 0.05;       // Fracción de puertos abiertos
+        double filtered = 0.05;   // Fracción de puertos filtrados (el resto, cerrados)
+        double firewalled = 0.3;  // Hosts que descartan todo lo que no está abierto
+        double tarpit = 0.01;     // Hosts tarpit
+        double loss = 0;          // Probabilidad de perder cada sondeo
+        double rtt_min_ms = 5;
+        double rtt_max_ms = 150;
+        double jitter_ms = 2;
+        double icmp_rate = 1;     // ICMP por segundo por host (icmp_ratelimit de 1000 ms)
+        double icmp_burst = 6;    // Igual que XRLIM_BURST_FACTOR del kernel
+        uint64_t seed = 1;
+        int stats_seconds = 0;
+    };
+
+    enum class HostKind { NORMAL, FIREWALLED, TARPIT };
+    enum class PortState { OPEN, CLOSED, FILTERED };
+
+    uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    double unit(uint64_t hash) {
+        return (hash >> 11) * 0x1.0p-53;
+    }
+
+    // La red completa es una función de la configuración, no se guarda nada por host salvo los buckets de ICMP
+    class Model {
+    public:
+        explicit Model(const Config& config) : config(config) {}
+
+        bool in_population(uint32_t ip) const {
+            return ip > config.network && ip <= config.network + config.hosts;
+        }
+
+        HostKind kind(uint32_t ip) const {
+            double u = unit(mix(config.seed ^ (uint64_t(ip) << 20) ^ 0x4b494e44));
+            if (u < config.tarpit) return HostKind::TARPIT;
+            if (u < config.tarpit + config.firewalled) return HostKind::FIREWALLED;
+            return HostKind::NORMAL;
+        }
+
+        PortState state(uint32_t ip, bool tcp, int port) const {
+            HostKind host = kind(ip);
+            if (host == HostKind::TARPIT) return tcp ? PortState::OPEN : PortState::FILTERED;
+            double u = unit(mix(config.seed ^ (uint64_t(ip) << 24) ^ (uint64_t(tcp) << 17) ^ uint64_t(port)));
+            if (u < config.open) return PortState::OPEN;
+            if (u < config.open + config.filtered || host == HostKind::FIREWALLED) return PortState::FILTERED;
+            return PortState::CLOSED;
+        }
+
+        int64_t base_rtt_ns(uint32_t ip) const {
+            double u = unit(mix(config.seed ^ (uint64_t(ip) << 8) ^ 0x525454));
+            return static_cast<int64_t>((config.rtt_min_ms + u * (config.rtt_max_ms - config.rtt_min_ms)) * 1e6);
+        }
+
+        const Config& config;
+    };
+
+    int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    uint32_t checksum_add(const uint8_t* data, size_t len, uint32_t sum) {
+        for (size_t i = 0; i + 1 < len; i += 2) sum += (data[i] << 8) | data[i + 1];
+        if (len & 1) sum += data[len - 1] << 8;
+        return sum;
+    }
+
+    uint16_t checksum_fold(uint32_t sum) {
+        while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+        return htons(static_cast<uint16_t>(~sum));
+    }
+
+    // TCP y UDP llevan la suma sobre el pseudo-header además de su encabezado y datos
+    uint16_t l4_checksum(const uint8_t* packet, size_t ip_len, size_t l4_len) {
+        const auto* ip_header = reinterpret_cast<const struct ip*>(packet);
+        uint32_t sum = checksum_add(reinterpret_cast<const uint8_t*>(&ip_header->ip_src), 8, 0);
+        sum += ip_header->ip_p + l4_len;
+        return checksum_fold(checksum_add(packet + ip_len, l4_len, sum));
+    }
+
+    std::vector<uint8_t> ip_packet(uint32_t src, uint32_t dst, uint8_t protocol, size_t l4_len) {
+        static uint16_t next_id = 1;
+        std::vector<uint8_t> packet(sizeof(struct ip) + l4_len);
+        auto* ip_header = reinterpret_cast<struct ip*>(packet.data());
+        ip_header->ip_v = 4;
+        ip_header->ip_hl = 5;
+        ip_header->ip_len = htons(packet.size());
+        ip_header->ip_id = htons(next_id++);
+        ip_header->ip_off = htons(IP_DF);
+        ip_header->ip_ttl = 64;
+        ip_header->ip_p = protocol;
+        ip_header->ip_src.s_addr = htonl(src);
+        ip_header->ip_dst.s_addr = htonl(dst);
+        ip_header->ip_sum = checksum_fold(checksum_add(packet.data(), sizeof(struct ip), 0));
+        return packet;
+    }
+
+    std::vector<uint8_t> tcp_reply(uint32_t src, uint32_t dst, int sport, int dport, uint32_t seq, uint32_t ack,
+                                   uint8_t flags, uint16_t window) {
+        std::vector<uint8_t> packet = ip_packet(src, dst, IPPROTO_TCP, sizeof(struct tcphdr));
+        auto* tcp_header = reinterpret_cast<struct tcphdr*>(packet.data() + sizeof(struct ip));
+        tcp_header->th_sport = htons(sport);
+        tcp_header->th_dport = htons(dport);
+        tcp_header->th_seq = htonl(seq);
+        tcp_header->th_ack = htonl(ack);
+        tcp_header->th_off = 5;
+        tcp_header->th_flags = flags;
+        tcp_header->th_win = htons(window);
+        tcp_header->th_sum = l4_checksum(packet.data(), sizeof(struct ip), sizeof(struct tcphdr));
+        return packet;
+    }
+
+    std::vector<uint8_t> udp_reply(uint32_t src, uint32_t dst, int sport, int dport) {
+        const char payload[] = "ok\n";
+        size_t l4_len = sizeof(struct udphdr) + 3;
+        std::vector<uint8_t> packet = ip_packet(src, dst, IPPROTO_UDP, l4_len);
+        auto* udp_header = reinterpret_cast<struct udphdr*>(packet.data() + sizeof(struct ip));
+        udp_header->uh_sport = htons(sport);
+        udp_header->uh_dport = htons(dport);
+        udp_header->uh_ulen = htons(l4_len);
+        std::memcpy(packet.data() + sizeof(struct ip) + sizeof(struct udphdr), payload, 3);
+        udp_header->uh_sum = l4_checksum(packet.data(), sizeof(struct ip), l4_len);
+        return packet;
+    }
+
+    // Port unreachable con el encabezado IP del sondeo y los primeros 8 bytes de su UDP
+    std::vector<uint8_t> icmp_unreachable(uint32_t src, uint32_t dst, const uint8_t* probe, size_t probe_ip_len) {
+        size_t quoted = probe_ip_len + 8;
+        std::vector<uint8_t> packet = ip_packet(src, dst, IPPROTO_ICMP, 8 + quoted);
+        uint8_t* icmp = packet.data() + sizeof(struct ip);
+        icmp[0] = ICMP_UNREACH;
+        icmp[1] = ICMP_UNREACH_PORT;
+        std::memcpy(icmp + 8, probe, quoted);
+        uint16_t sum = checksum_fold(checksum_add(icmp, 8 + quoted, 0));
+        std::memcpy(icmp + 2, &sum, 2);
+        return packet;
+    }
+
+    struct Pending {
+        int64_t due_ns;
+        uint64_t order; // Mismo due_ns: en el orden en que se generaron
+        std::vector<uint8_t> packet;
+        bool operator>(const Pending& other) const {
+            return due_ns != other.due_ns ? due_ns > other.due_ns : order > other.order;
+        }
+    };
+
+    struct Bucket {
+        double tokens;
+        int64_t last_ns;
+    };
+
+    struct Counters {
+        uint64_t received = 0;
+        uint64_t syn = 0;
+        uint64_t udp = 0;
+        uint64_t replies = 0;
+        uint64_t lost = 0;
+        uint64_t icmp_limited = 0;
+        uint64_t unknown_hosts = 0;
+    };
+
+    class Simulator {
+    public:
+        Simulator(const Config& config) : config(config), model(config), rng(config.seed) {}
+
+        bool open_device();
+        void run();
+
+    private:
+        void handle(const uint8_t* packet, size_t len);
+        void schedule(uint32_t host, std::vector<uint8_t> packet);
+        bool icmp_allowed(uint32_t host, int64_t now);
+        void flush_due();
+        void print_counters() const;
+
+        const Config& config;
+        Model model;
+        std::mt19937_64 rng;
+        int tun_fd = -1;
+        std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+        uint64_t pending_order = 0;
+        std::unordered_map<uint32_t, Bucket> icmp_buckets;
+        Counters counters;
+    };
+
+    // Crea el TUN y le pone la última dirección de la red, así la ruta conectada manda todo al simulador
+    bool Simulator::open_device() {
+        tun_fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (tun_fd < 0) {
+            std::cerr << "error, no se pudo abrir /dev/net/tun: " << strerror(errno) << std::endl;
+            return false;
+        }
+        ifreq ifr{};
+        ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+        std::strncpy(ifr.ifr_name, config.device.c_str(), IFNAMSIZ - 1);
+        if (ioctl(tun_fd, TUNSETIFF, &ifr) < 0) {
+            std::cerr << "error, TUNSETIFF " << config.device << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        uint32_t mask = config.prefix == 0 ? 0 : ~uint32_t(0) << (32 - config.prefix);
+        uint32_t local = (config.network | ~mask) - 1;
+        auto set_address = [&](unsigned long request, uint32_t address) {
+            auto* addr = reinterpret_cast<sockaddr_in*>(&ifr.ifr_addr);
+            addr->sin_family = AF_INET;
+            addr->sin_addr.s_addr = htonl(address);
+            return ioctl(sock, request, &ifr) == 0;
+        };
+        bool ok = set_address(SIOCSIFADDR, local) && set_address(SIOCSIFNETMASK, mask);
+        ifr.ifr_qlen = 10000; // Las respuestas salen a ráfagas cuando vencen juntas
+        ok = ok && ioctl(sock, SIOCSIFTXQLEN, &ifr) == 0;
+        ok = ok && ioctl(sock, SIOCGIFFLAGS, &ifr) == 0;
+        ifr.ifr_flags |= IFF_UP | IFF_RUNNING;
+        ok = ok && ioctl(sock, SIOCSIFFLAGS, &ifr) == 0;
+        close(sock);
+        if (!ok) {
+            std::cerr << "error, no se pudo configurar " << config.device << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        in_addr first{htonl(config.network + 1)}, me{htonl(local)};
+        std::cerr << "bench_netsim: " << config.device << " con " << config.hosts << " hosts desde " << inet_ntoa(first);
+        std::cerr << " (el escáner sale desde " << inet_ntoa(me) << ")" << std::endl;
+        return true;
+    }
+
+    void Simulator::schedule(uint32_t host, std::vector<uint8_t> packet) {
+        int64_t delay = model.base_rtt_ns(host);
+        if (config.jitter_ms > 0) {
+            std::uniform_real_distribution<double> jitter(0, config.jitter_ms * 1e6);
+            delay += static_cast<int64_t>(jitter(rng));
+        }
+        pending.push({now_ns() + delay, pending_order++, std::move(packet)});
+    }
+
+    bool Simulator::icmp_allowed(uint32_t host, int64_t now) {
+        auto [it, inserted] = icmp_buckets.try_emplace(host, Bucket{config.icmp_burst, now});
+        Bucket& bucket = it->second;
+        bucket.tokens = std::min(config.icmp_burst, bucket.tokens + (now - bucket.last_ns) / 1e9 * config.icmp_rate);
+        bucket.last_ns = now;
+        if (bucket.tokens < 1) return false;
+        bucket.tokens -= 1;
+        return true;
+    }
+
+    void Simulator::handle(const uint8_t* packet, size_t len) {
+        if (len < sizeof(struct ip)) return;
+        const auto* ip_header = reinterpret_cast<const struct ip*>(packet);
+        size_t ip_len = ip_header->ip_hl * 4;
+        if (ip_header->ip_v != 4 || ip_len < sizeof(struct ip) || len < ip_len + 8) return;
+        counters.received++;
+
+        uint32_t host = ntohl(ip_header->ip_dst.s_addr);
+        uint32_t scanner = ntohl(ip_header->ip_src.s_addr);
+        if (!model.in_population(host)) {
+            counters.unknown_hosts++; // Hosts que no existen: no contestan nada
+            return;
+        }
+        std::uniform_real_distribution<double> chance(0, 1);
+
+        if (ip_header->ip_p == IPPROTO_TCP && len >= ip_len + sizeof(struct tcphdr)) {
+            const auto* tcp_header = reinterpret_cast<const struct tcphdr*>(packet + ip_len);
+            int sport = ntohs(tcp_header->th_sport), dport = ntohs(tcp_header->th_dport);
+            uint32_t seq = ntohl(tcp_header->th_seq);
+            uint8_t flags = tcp_header->th_flags;
+            bool tarpit = model.kind(host) == HostKind::TARPIT;
+
+            if ((flags & TH_SYN) && !(flags & TH_ACK)) {
+                counters.syn++;
+                if (config.loss > 0 && chance(rng) < config.loss) { counters.lost++; return; }
+                switch (model.state(host, true, dport)) {
+                    case PortState::OPEN: {
+                        uint32_t isn = static_cast<uint32_t>(mix(config.seed ^ (uint64_t(host) << 32) ^ (dport << 16) ^ sport));
+                        schedule(host, tcp_reply(host, scanner, dport, sport, isn, seq + 1, TH_SYN | TH_ACK, tarpit ? 0 : 64240));
+                        break;
+                    }
+                    case PortState::CLOSED:
+                        schedule(host, tcp_reply(host, scanner, dport, sport, 0, seq + 1, TH_RST | TH_ACK, 0));
+                        break;
+                    case PortState::FILTERED:
+                        return;
+                }
+                counters.replies++;
+                return;
+            }
+            // El escáner cierra la conexión (o manda datos): se corta con RST para que el kernel no
+            // retransmita el FIN. El tarpit se la queda colgada a propósito
+            size_t payload = ntohs(ip_header->ip_len) - ip_len - tcp_header->th_off * 4;
+            if (!tarpit && !(flags & TH_RST) && ((flags & TH_FIN) || payload > 0)) {
+                schedule(host, tcp_reply(host, scanner, dport, sport, ntohl(tcp_header->th_ack), 0, TH_RST, 0));
+            }
+            return;
+        }
+
+        if (ip_header->ip_p == IPPROTO_UDP) {
+            const auto* udp_header = reinterpret_cast<const struct udphdr*>(packet + ip_len);
+            int sport = ntohs(udp_header->uh_sport), dport = ntohs(udp_header->uh_dport);
+            counters.udp++;
+            if (config.loss > 0 && chance(rng) < config.loss) { counters.lost++; return; }
+            switch (model.state(host, false, dport)) {
+                case PortState::OPEN:
+                    schedule(host, udp_reply(host, scanner, dport, sport));
+                    break;
+                case PortState::CLOSED:
+                    if (!icmp_allowed(host, now_ns())) { counters.icmp_limited++; return; }
+                    schedule(host, icmp_unreachable(host, scanner, packet, ip_len));
+                    break;
+                case PortState::FILTERED:
+                    return;
+            }
+            counters.replies++;
+        }
+    }
+
+    void Simulator::flush_due() {
+        int64_t now = now_ns();
+        while (!pending.empty() && pending.top().due_ns <= now) {
+            const std::vector<uint8_t>& packet = pending.top().packet;
+            if (write(tun_fd, packet.data(), packet.size()) < 0 && errno != EAGAIN && errno != ENOBUFS) {
+                perror("write al TUN");
+            }
+            pending.pop();
+        }
+    }
+
+    void Simulator::print_counters() const {
+        std::cerr << "bench_netsim: recibidos " << counters.received << " (SYN " << counters.syn << ", UDP " << counters.udp
+                  << "), respuestas " << counters.replies << ", perdidos " << counters.lost << ", ICMP limitados "
+                  << counters.icmp_limited << ", a hosts inexistentes " << counters.unknown_hosts << std::endl;
+    }
+
+    void Simulator::run() {
+        std::vector<uint8_t> buffer(65536);
+        int64_t next_stats = now_ns() + config.stats_seconds * 1000000000LL;
+        while (!g_stop) {
+            int timeout_ms = 100;
+            if (!pending.empty()) {
+                int64_t wait = pending.top().due_ns - now_ns();
+                timeout_ms = wait <= 0 ? 0 : static_cast<int>(std::min<int64_t>(100, (wait + 999999) / 1000000));
+            }
+            pollfd poll_fd{tun_fd, POLLIN, 0};
+            if (poll(&poll_fd, 1, timeout_ms) > 0) {
+                ssize_t len;
+                while ((len = read(tun_fd, buffer.data(), buffer.size())) > 0) handle(buffer.data(), len);
+            }
+            flush_due();
+            if (config.stats_seconds > 0 && now_ns() >= next_stats) {
+                print_counters();
+                next_stats += config.stats_seconds * 1000000000LL;
+            }
+        }
+        print_counters();
+    }
+
+    bool parse_cidr(const std::string& text, uint32_t& network, int& prefix) {
+        size_t slash = text.find('/');
+        in_addr addr{};
+        if (slash == std::string::npos || inet_pton(AF_INET, text.substr(0, slash).c_str(), &addr) != 1) return false;
+        prefix = std::atoi(text.c_str() + slash + 1);
+        if (prefix < 8 || prefix > 30) return false;
+        network = ntohl(addr.s_addr) & (~uint32_t(0) << (32 - prefix));
+        return true;
+    }
+
+    void usage(const char* prog) {
+        std::cout << "Uso: " << prog << " [opciones]\n\n";
+        std::cout << "  --dev NOMBRE              Dispositivo TUN (predeterminado: escsim0)\n";
+        std::cout << "  --net CIDR                Red simulada (predeterminado: 10.99.0.0/16)\n";
+        std::cout << "  --hosts N                 Hosts vivos, desde la .1 (predeterminado: 10000)\n";
+        std::cout << "  --open F / --filtered F   Fracción de puertos abiertos / filtrados (0.05 / 0.05)\n";
+        std::cout << "  --firewalled F            Hosts que descartan lo cerrado (0.3)\n";
+        std::cout << "  --tarpit F                Hosts tarpit: SYN/ACK con ventana 0 en todo puerto TCP (0.01)\n";
+        std::cout << "  --loss F                  Probabilidad de perder un sondeo (0)\n";
+        std::cout << "  --rtt MIN-MAX             RTT base por host en ms, uniforme en el rango (5-150)\n";
+        std::cout << "  --jitter MS               Se suma a cada respuesta, uniforme de 0 a MS (2)\n";
+        std::cout << "  --icmp-rate N             ICMP unreachable por segundo por host (1, como icmp_ratelimit)\n";
+        std::cout << "  --icmp-burst N            Ráfaga del token bucket de ICMP (6)\n";
+        std::cout << "  --seed N                  Semilla de la red (1)\n";
+        std::cout << "  --stats S                 Imprime contadores cada S segundos\n";
+        std::cout << "  --truth IP -p PUERTOS     Imprime el estado esperado de esos puertos y sale\n";
+        std::cout << "  --sample N                Imprime N hosts repartidos en la población y sale\n";
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    std::string truth_ip, truth_ports;
+    uint32_t sample = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--dev" && has_value) config.device = argv[++i];
+        else if (arg == "--net" && has_value) {
+            if (!parse_cidr(argv[++i], config.network, config.prefix)) {
+                std::cerr << "error, --net espera una red IPv4 entre /8 y /30: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--hosts" && has_value) config.hosts = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--open" && has_value) config.open = std::atof(argv[++i]);
+        else if (arg == "--filtered" && has_value) config.filtered = std::atof(argv[++i]);
+        else if (arg == "--firewalled" && has_value) config.firewalled = std::atof(argv[++i]);
+        else if (arg == "--tarpit" && has_value) config.tarpit = std::atof(argv[++i]);
+        else if (arg == "--loss" && has_value) config.loss = std::atof(argv[++i]);
+        else if (arg == "--rtt" && has_value) {
+            std::string range = argv[++i];
+            size_t dash = range.find('-');
+            config.rtt_min_ms = std::atof(range.c_str());
+            config.rtt_max_ms = dash == std::string::npos ? config.rtt_min_ms : std::atof(range.c_str() + dash + 1);
+        }
+        else if (arg == "--jitter" && has_value) config.jitter_ms = std::atof(argv[++i]);
+        else if (arg == "--icmp-rate" && has_value) config.icmp_rate = std::atof(argv[++i]);
+        else if (arg == "--icmp-burst" && has_value) config.icmp_burst = std::atof(argv[++i]);
+        else if (arg == "--seed" && has_value) config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--stats" && has_value) config.stats_seconds = std::atoi(argv[++i]);
+        else if (arg == "--truth" && has_value) truth_ip = argv[++i];
+        else if (arg == "-p" && has_value) truth_ports = argv[++i];
+        else if (arg == "--sample" && has_value) sample = std::strtoul(argv[++i], nullptr, 10);
+        else {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    uint32_t capacity = (uint32_t(1) << (32 - config.prefix)) - 3; // Sin red, broadcast ni la del escáner
+    if (config.hosts == 0 || config.hosts > capacity) {
+        std::cerr << "error, --hosts tiene que estar entre 1 y " << capacity << " para /" << config.prefix << std::endl;
+        return 1;
+    }
+
+    Model model(config);
+    if (sample > 0) {
+        uint32_t count = std::min(sample, config.hosts);
+        for (uint32_t i = 0; i < count; ++i) {
+            in_addr addr{htonl(config.network + 1 + uint64_t(i) * config.hosts / count)};
+            std::cout << inet_ntoa(addr) << "\n";
+        }
+        return 0;
+    }
+    if (!truth_ip.empty()) {
+        in_addr addr{};
+        std::vector<int> ports = ArgsParser::parsearPuertos(truth_ports);
+        if (inet_pton(AF_INET, truth_ip.c_str(), &addr) != 1 || ports.empty()) {
+            std::cerr << "error, --truth espera una IPv4 y -p PUERTOS" << std::endl;
+            return 1;
+        }
+        uint32_t host = ntohl(addr.s_addr);
+        // Mismos nombres que el NDJSON del escáner; lo cerrado no sale ahí y un UDP filtrado es "unknown"
+        const char* tcp_names[] = {"open", "closed", "filtered"};
+        const char* udp_names[] = {"open", "closed", "unknown"};
+        for (int tcp = 1; tcp >= 0; --tcp) {
+            for (int port : ports) {
+                int state = model.in_population(host) ? static_cast<int>(model.state(host, tcp, port))
+                                                      : static_cast<int>(PortState::FILTERED);
+                std::cout << (tcp ? "TCP " : "UDP ") << port << " " << (tcp ? tcp_names : udp_names)[state] << "\n";
+            }
+        }
+        return 0;
+    }
+
+    Simulator simulator(config);
+    if (!simulator.open_device()) return 1;
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    simulator.run();
+    return 0;
+}
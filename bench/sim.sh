@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+# Escaneo a escala contra el simulador TUN (bench_netsim): levanta la red simulada, escanea una muestra de
+# sus hosts con varios escáneres a la vez (el escáner es de un objetivo por corrida) y compara cada uno
+# contra la verdad del simulador. No necesita red ni namespaces, solo root para el TUN
+#
+#   sudo bench/sim.sh [opciones de bench_netsim...]      ej. sudo bench/sim.sh --hosts 10000 --loss 0.01
+#
+# Variables: SIM_SAMPLE (100 hosts), SIM_PARALLEL (8 escáneres a la vez), SIM_PORTS (1-1024),
+# SIM_PROTOS (t, u o tu; tu), SIM_ENGINE (reactor), BENCH_ARGS (opciones extra del escáner), ESCANER
+set -euo pipefail
+source "$(dirname "${BASH_SOURCE[0]}")/lab.sh"
+
+NETSIM=$BENCH_DIR/bin/bench_netsim
+DEV=escsim0
+SAMPLE=${SIM_SAMPLE:-100}
+PARALLEL=${SIM_PARALLEL:-8}
+PORTS=${SIM_PORTS:-1-1024}
+PROTOS=${SIM_PROTOS:-tu}
+ENGINE=${SIM_ENGINE:-reactor}
+SIM_OUT=$OUT/sim
+
+# Un host: escanea, mide y compara. Imprime "ip pared_s cpu_s rss_kb precisión"
+scan_host() {
+    local ip=$1 flags=()
+    case $PROTOS in
+        t) ;;
+        u) flags=(-u) ;;
+        *) flags=(-tu) ;;
+    esac
+    # shellcheck disable=SC2086
+    "$MEASURE" "$ESCANER" "$ip" -i "$DEV" -p "$PORTS" "${flags[@]}" --engine "$ENGINE" \
+        --ndjson "$SIM_OUT/$ip.ndjson" $SCAN_ARGS > "$SIM_OUT/$ip.log" 2>&1 || true
+    local _ wall user sys rss code
+    read -r _ wall user sys rss code <<<"$(grep '^bench_measure ' "$SIM_OUT/$ip.log" | tail -1)"
+    [[ ${code:-1} == 0 ]] || { echo "sim: $ip: el escáner falló, ver $SIM_OUT/$ip.log" >&2; return; }
+    "$NETSIM" "${SIM_ARGS[@]}" --truth "$ip" -p "$PORTS" \
+        | awk -v protos="$PROTOS" '(protos != "t" || $1 == "TCP") && (protos != "u" || $1 == "UDP")' > "$SIM_OUT/$ip.truth"
+    echo "$ip $wall $(awk -v u="$user" -v s="$sys" 'BEGIN { print u + s }') $rss $(accuracy "$SIM_OUT/$ip.truth" "$SIM_OUT/$ip.ndjson")"
+}
+
+main() {
+    [[ $EUID -eq 0 ]] || die "hace falta root (TUN y captura)"
+    [[ -x $ESCANER && -x $MEASURE && -x $NETSIM ]] || die "falta $ESCANER o las herramientas (make && make bench-tools)"
+    SIM_ARGS=(--dev "$DEV" "$@")
+    rm -rf "$SIM_OUT"
+    mkdir -p "$SIM_OUT"
+
+    "$NETSIM" "${SIM_ARGS[@]}" > "$SIM_OUT/netsim.log" 2>&1 &
+    NETSIM_PID=$!
+    trap 'kill $NETSIM_PID 2>/dev/null || true' EXIT
+    for _ in $(seq 20); do
+        ip link show "$DEV" 2>/dev/null | grep -q UP && break
+        sleep 0.1
+    done
+    kill -0 $NETSIM_PID 2>/dev/null || die "bench_netsim no arrancó, ver $SIM_OUT/netsim.log"
+
+    # Un pool de PARALLEL escaneos; el simulador también es un job, así que se cuentan solo los pids propios
+    local start end scans=()
+    start=$(date +%s.%N)
+    while read -r ip; do
+        scan_host "$ip" >> "$SIM_OUT/hosts.txt" &
+        scans+=($!)
+        while (( ${#scans[@]} >= PARALLEL )); do
+            wait -n "${scans[@]}" || true
+            local running=()
+            for pid in "${scans[@]}"; do kill -0 "$pid" 2>/dev/null && running+=("$pid"); done
+            scans=("${running[@]}")
+        done
+    done < <("$NETSIM" "${SIM_ARGS[@]}" --sample "$SAMPLE")
+    (( ${#scans[@]} == 0 )) || wait "${scans[@]}" || true
+    end=$(date +%s.%N)
+
+    kill -INT $NETSIM_PID 2>/dev/null || true
+    wait $NETSIM_PID 2>/dev/null || true
+    tail -1 "$SIM_OUT/netsim.log"
+
+    local per_host
+    per_host=$(PORT_SPEC=$PORTS awk 'BEGIN { n = split(ENVIRON["PORT_SPEC"], parts, ","); for (i = 1; i <= n; i++) {
+        if (split(parts[i], r, "-") == 2) total += r[2] - r[1] + 1; else total++ } print total }')
+    [[ $PROTOS == tu ]] && per_host=$((per_host * 2))
+    awk -v start="$start" -v end="$end" -v per_host="$per_host" -v parallel="$PARALLEL" '
+        { hosts++; cpu += $3; if ($4 > rss) rss = $4; acc += $5; if (hosts == 1 || $5 < worst) { worst = $5; worst_ip = $1 } }
+        END {
+            if (!hosts) { print "sim: ningún escaneo terminó"; exit 1 }
+            wall = end - start
+            printf "%d hosts x %d sondeos en %.1f s (%d a la vez): %.0f puertos/s\n", hosts, per_host, wall, parallel, hosts * per_host / wall
+            printf "CPU total %.2f s, RSS máximo %d KB, precisión media %.2f%% (peor: %s con %.2f%%)\n", cpu, rss, acc / hosts, worst_ip, worst
+        }' "$SIM_OUT/hosts.txt"
+}
+
+main "$@"
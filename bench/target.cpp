@@ -0,0 +1,109 @@
+// Host objetivo del laboratorio de bench/lab.sh: corre dentro de su network namespace y deja abiertos
+// los puertos TCP y UDP que se le piden. Los cerrados no necesitan nada (el kernel contesta RST o ICMP
+// port unreachable) y los descartados los tira el firewall del namespace
+//
+//   bench_target --tcp 10003,10010-10020 --udp 10001
+//
+// TCP acepta y cierra; UDP contesta cada datagrama con uno de vuelta. Todo en un solo hilo con epoll
+#include "args.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_signal(int) { g_stop = 1; }
+
+static int open_socket(int type, int port, const std::string& bind_ip) {
+    int fd = socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, bind_ip.c_str(), &addr.sin_addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || (type == SOCK_STREAM && listen(fd, 1024) < 0)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<int> tcp_ports, udp_ports;
+    std::string bind_ip = "0.0.0.0";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tcp" && i + 1 < argc) tcp_ports = ArgsParser::parsearPuertos(argv[++i]);
+        else if (arg == "--udp" && i + 1 < argc) udp_ports = ArgsParser::parsearPuertos(argv[++i]);
+        else if (arg == "--bind" && i + 1 < argc) bind_ip = argv[++i];
+        else {
+            std::cerr << "Uso: " << argv[0] << " [--tcp PUERTOS] [--udp PUERTOS] [--bind IP]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Un fd por puerto abierto, con miles de puertos no alcanza el límite por defecto
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<bool> is_udp;
+    auto watch = [&](int type, int port) {
+        int fd = open_socket(type, port, bind_ip);
+        if (fd < 0) {
+            std::cerr << "error, no se pudo abrir " << (type == SOCK_STREAM ? "TCP " : "UDP ") << port << ": "
+                      << strerror(errno) << std::endl;
+            return false;
+        }
+        if (static_cast<size_t>(fd) >= is_udp.size()) is_udp.resize(fd + 1);
+        is_udp[fd] = type == SOCK_DGRAM;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+        return true;
+    };
+    for (int port : tcp_ports) if (!watch(SOCK_STREAM, port)) return 1;
+    for (int port : udp_ports) if (!watch(SOCK_DGRAM, port)) return 1;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    std::cout << "bench_target: " << tcp_ports.size() << " TCP, " << udp_ports.size() << " UDP abiertos" << std::endl;
+
+    epoll_event events[256];
+    char buffer[2048];
+    while (!g_stop) {
+        int count = epoll_wait(epoll_fd, events, 256, 200);
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (is_udp[fd]) {
+                sockaddr_in from{};
+                socklen_t from_len = sizeof(from);
+                while (recvfrom(fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &from_len) >= 0) {
+                    sendto(fd, "ok\n", 3, 0, (struct sockaddr*)&from, from_len);
+                    from_len = sizeof(from);
+                }
+            } else {
+                int client;
+                while ((client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC)) >= 0) close(client);
+            }
+        }
+    }
+    return 0;
+}
@@ -1,56 +1,176 @@
 #include "include/JSONGen.h"
 #include <fstream>
-#include <sstream>
-#include <iomanip>
-#include "../include/nlohmann/json.hpp"
-
-using json = nlohmann::json;
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include "include/json_writer.h"
 
 namespace JSONGenerator {
 
+    // El reporte se vacía al archivo cada vez que el buffer pasa de esto
+    static constexpr size_t FLUSH_BYTES = 1 << 20;
+
     std::string bytes_to_hex_string(const std::vector<unsigned char>& bytes) {
         if (bytes.empty()) {
             return "";
         }
-        std::stringstream ss;
-        ss << std::hex << std::setfill('0');
-        for (size_t i = 0; i < bytes.size(); ++i) {
-            ss << std::setw(2) << static_cast<int>(bytes[i]);
-            if (i < bytes.size() - 1) {
-                ss << " ";
-            }
+        std::string hex(bytes.size() * 3 - 1, ' ');
+        JsonWriter::encode_hex(bytes.data(), bytes.size(), hex.data());
+        return hex;
+    }
+
+    const char* status_name(PortStatus status) {
+        switch(status) {
+            case PortStatus::OPEN:          return "open";
+            case PortStatus::FILTERED:      return "filtered";
+            default:                        return "unknown";
+        }
+    }
+
+    const char* protocol_name(Protocol protocol) {
+        return protocol == Protocol::TCP ? "TCP" : "UDP";
+    }
+
+    // Las llaves van en orden alfabético, que es como las dejaba el DOM de nlohmann
+    static void capture_counters_json(JsonWriter& writer, const ScanStats::InterfaceCounters& counters) {
+        writer.begin_object();
+        writer.key("ignored");            writer.value(counters.ignored);
+        writer.key("interface");          writer.value(counters.interface);
+        writer.key("interface_dropped");  writer.value(counters.interface_dropped);
+        writer.key("kernel_dropped");     writer.value(counters.kernel_dropped);
+        writer.key("received");           writer.value(counters.received);
+        writer.end_object();
+    }
+
+    static void result_entry(JsonWriter& writer, const AppConfig& config, const ScanResult& result) {
+        writer.begin_object();
+        if (!result.banner.empty()) {
+            writer.key("banner");
+            writer.value(result.banner);
+        }
+        writer.key("header_bytes");   writer.hex_value(result.header_bytes.data(), result.header_bytes.size());
+        writer.key("ip");             writer.value(config.target_ip);
+        writer.key("port");           writer.value(result.port);
+        writer.key("protocol");       writer.value(protocol_name(result.protocol));
+        if (result.rtt_ns > 0) {
+            writer.key("rtt_ns");
+            writer.value(result.rtt_ns);
         }
-        return ss.str();
+        writer.key("service");        writer.value(result.service);
+        writer.key("status");         writer.value(status_name(result.status));
+        writer.end_object();
+    }
+
+    void append_result_line(JsonWriter& writer, const AppConfig& config, const ScanResult& result) {
+        result_entry(writer, config, result);
+    }
+
+    std::string result_line(const AppConfig& config, const ScanResult& result) {
+        JsonWriter writer;
+        result_entry(writer, config, result);
+        return std::move(writer.buffer());
     }
 
-    void generate_report(const AppConfig& config, const std::vector<ScanResult>& results) {
-        json report_array = json::array();
+    static void flush(JsonWriter& writer, std::ofstream& o) {
+        o.write(writer.buffer().data(), static_cast<std::streamsize>(writer.size()));
+        writer.clear();
+    }
+
+    void generate_report(const AppConfig& config, const std::vector<ScanResult>& results,
+                         const ScanStats::Summary& stats, const Shutdown::Progress& progress) {
+        // Se ordena igual que en consola, así el reporte es determinista (el replay da el mismo archivo byte a byte)
+        std::vector<const ScanResult*> ordered;
+        ordered.reserve(results.size());
+        for (const auto& result : results) ordered.push_back(&result);
+        std::sort(ordered.begin(), ordered.end(), [](const ScanResult* a, const ScanResult* b) {
+            return result_order(*a, *b);
+        });
+
+        // Se escribe en un temporal y se renombra, así un corte a medio escribir no deja un JSON roto
+        std::string tmp_file = config.output_file + ".tmp";
+        {
+            std::ofstream o(tmp_file, std::ios::binary);
+            JsonWriter writer(4);
+            writer.buffer().reserve(FLUSH_BYTES + 4096);
+            writer.begin_object();
+
+            // Contadores de captura, si hubo pérdida aquí se ve por qué hay tantos filtrados
+            writer.key("capture");
+            writer.begin_object();
+            writer.key("interfaces");
+            writer.begin_array();
+            for (const auto& counters : stats.interfaces) {
+                capture_counters_json(writer, counters);
+            }
+            writer.end_array();
+            writer.key("probes_answered");  writer.value(stats.probes_answered);
+            writer.key("probes_sent");      writer.value(stats.probes_sent);
+            writer.key("total");
+            capture_counters_json(writer, stats.total);
+            writer.end_object();
 
-        for (const auto& result : results) {
-            if (result.status == PortStatus::CLOSED) {
-                continue;
+            if (progress.interrupted) {
+                writer.key("partial");
+                writer.value(true);
             }
 
-            std::string status_str;
-            switch(result.status) {
-                case PortStatus::OPEN:          status_str = "open"; break;
-                case PortStatus::FILTERED:      status_str = "filtered"; break;
-                default:                        status_str = "unknown"; break;
+            writer.key("results");
+            writer.begin_array();
+            for (const ScanResult* entry_ptr : ordered) {
+                const ScanResult& result = *entry_ptr;
+                if (result.status == PortStatus::CLOSED) {
+                    continue;
+                }
+                result_entry(writer, config, result);
+                if (writer.size() >= FLUSH_BYTES) flush(writer, o);
             }
+            writer.end_array();
 
-            json entry;
-            entry["ip"] = config.target_ip;
-            entry["port"] = result.port;
-            entry["status"] = status_str;
-            entry["protocol"] = (result.protocol == Protocol::TCP) ? "TCP" : "UDP";
-            entry["service"] = result.service;
-            entry["header_bytes"] = bytes_to_hex_string(result.header_bytes);
+            // Posición para retomar: las tareas van en orden puerto x protocolo, las primeras "position" ya
+            // se repartieron y de esas las de "incomplete" se quedaron sin resultado
+            if (progress.interrupted) {
+                writer.key("resume");
+                writer.begin_object();
+                writer.key("incomplete");
+                writer.begin_array();
+                for (const ScanTask& task : progress.incomplete) {
+                    writer.begin_object();
+                    writer.key("port");      writer.value(task.port);
+                    writer.key("protocol");  writer.value(protocol_name(task.protocol));
+                    writer.end_object();
+                }
+                writer.end_array();
+                writer.key("position");  writer.value(static_cast<uint64_t>(progress.position));
+                writer.key("total");     writer.value(static_cast<uint64_t>(progress.total));
+                writer.end_object();
+            }
 
-            report_array.push_back(entry);
-        }
+            // Resumen de RTT por host (un escaneo es un solo objetivo), solo si se midió algo
+            if (stats.rtt.samples > 0) {
+                writer.key("rtt");
+                writer.begin_array();
+                writer.begin_object();
+                writer.key("ip");         writer.value(config.target_ip);
+                writer.key("median_ns");  writer.value(stats.rtt.median_ns);
+                writer.key("min_ns");     writer.value(stats.rtt.min_ns);
+                writer.key("p99_ns");     writer.value(stats.rtt.p99_ns);
+                writer.key("samples");    writer.value(stats.rtt.samples);
+                writer.end_object();
+                writer.end_array();
+            }
 
-        std::ofstream o(config.output_file);
-        o << std::setw(4) << report_array << std::endl;
+            writer.end_object();
+            writer.newline();
+            flush(writer, o);
+            o.flush();
+            if (!o) {
+                std::cerr << "Error al escribir " << tmp_file << std::endl;
+                return;
+            }
+        }
+        if (std::rename(tmp_file.c_str(), config.output_file.c_str()) != 0) {
+            perror("Error al renombrar el reporte");
+        }
     }
 
 }
@@ -0,0 +1,220 @@
+#include "include/affinity.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <pthread.h>
+#include <sched.h>
+
+namespace Affinity {
+
+    static Placement g_placement;
+
+    bool parse_cpu_list(const std::string& text, std::vector<int>& cpus) {
+        cpus.clear();
+        std::stringstream ss(text);
+        std::string token;
+        while (std::getline(ss, token, ',')) {
+            token.erase(0, token.find_first_not_of(" \t\n"));
+            token.erase(token.find_last_not_of(" \t\n") + 1);
+            if (token.empty()) continue;
+
+            size_t guion = token.find('-');
+            try {
+                int inicio = std::stoi(token.substr(0, guion));
+                int fin = (guion == std::string::npos) ? inicio : std::stoi(token.substr(guion + 1));
+                if (inicio < 0 || fin < inicio || fin >= CPU_SETSIZE) return false;
+                for (int cpu = inicio; cpu <= fin; ++cpu) cpus.push_back(cpu);
+            } catch (...) {
+                return false;
+            }
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return !cpus.empty();
+    }
+
+    std::string format_cpu_list(const std::vector<int>& cpus) {
+        std::string out;
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+            if (!out.empty()) out += ",";
+            out += std::to_string(cpus[i]);
+            if (j > i) out += "-" + std::to_string(cpus[j]);
+            i = j + 1;
+        }
+        return out.empty() ? "-" : out;
+    }
+
+    static std::string read_first_line(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    int nic_numa_node(const std::string& interface) {
+        std::string value = read_first_line("/sys/class/net/" + interface + "/device/numa_node");
+        try { return value.empty() ? -1 : std::stoi(value); } catch (...) { return -1; }
+    }
+
+    std::vector<int> node_cpus(int node) {
+        std::vector<int> cpus;
+        if (node < 0) return cpus;
+        parse_cpu_list(read_first_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"), cpus);
+        return cpus;
+    }
+
+    // IRQs de la NIC: las MSI/MSI-X salen de sysfs, si no hay se buscan por nombre en /proc/interrupts
+    // (los drivers suelen nombrarlas "eth0-TxRx-0" y parecidos)
+    static std::vector<int> nic_irqs(const std::string& interface) {
+        std::vector<int> irqs;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/class/net/" + interface + "/device/msi_irqs", ec)) {
+            try { irqs.push_back(std::stoi(entry.path().filename().string())); } catch (...) {}
+        }
+        if (!irqs.empty()) return irqs;
+
+        std::ifstream interrupts("/proc/interrupts");
+        std::string line;
+        while (std::getline(interrupts, line)) {
+            if (line.find(interface) == std::string::npos) continue;
+            try { irqs.push_back(std::stoi(line)); } catch (...) {}
+        }
+        return irqs;
+    }
+
+    std::vector<int> nic_irq_cpus(const std::string& interface) {
+        std::vector<int> all;
+        for (int irq : nic_irqs(interface)) {
+            std::vector<int> cpus;
+            if (parse_cpu_list(read_first_line("/proc/irq/" + std::to_string(irq) + "/smp_affinity_list"), cpus)) {
+                all.insert(all.end(), cpus.begin(), cpus.end());
+            }
+        }
+        std::sort(all.begin(), all.end());
+        all.erase(std::unique(all.begin(), all.end()), all.end());
+        return all;
+    }
+
+    // CPUs donde este proceso puede correr (cgroups, taskset...)
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    static std::vector<int> intersect(const std::vector<int>& a, const std::vector<int>& b) {
+        std::vector<int> out;
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+        return out;
+    }
+
+    static std::vector<int> subtract(const std::vector<int>& a, const std::vector<int>& b) {
+        std::vector<int> out;
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(out));
+        return out;
+    }
+
+    // Modo auto: todo en el nodo NUMA de la NIC. La captura va en las CPUs que atienden sus IRQs
+    // (los paquetes ya están calientes en esa caché) y el resto en las demás CPUs del mismo nodo
+    static void auto_placement(const AppConfig& config, Placement& placement) {
+        std::vector<int> allowed = allowed_cpus();
+        placement.numa_node = nic_numa_node(config.interface);
+        std::vector<int> local = intersect(node_cpus(placement.numa_node), allowed);
+        std::vector<int> irq = intersect(nic_irq_cpus(config.interface), local.empty() ? allowed : local);
+
+        if (local.empty() && irq.empty()) {
+            std::cout << "Afinidad: " << config.interface
+                      << " no reporta nodo NUMA ni IRQs, los hilos quedan sin fijar" << std::endl;
+            return;
+        }
+        if (local.empty()) local = allowed;
+
+        placement.rx = irq.empty() ? local : irq;
+        std::vector<int> rest = subtract(local, placement.rx);
+        if (rest.empty()) rest = local;
+        placement.tx = rest;
+        placement.workers = rest;
+    }
+
+    void configure(const AppConfig& config) {
+        g_placement = Placement{};
+        if (config.affinity_auto) auto_placement(config, g_placement);
+
+        // Las listas explícitas ganan sobre lo que haya calculado el modo auto (ya vienen validadas de args)
+        if (!config.cpu_tx.empty()) parse_cpu_list(config.cpu_tx, g_placement.tx);
+        if (!config.cpu_rx.empty()) parse_cpu_list(config.cpu_rx, g_placement.rx);
+        if (!config.cpu_workers.empty()) parse_cpu_list(config.cpu_workers, g_placement.workers);
+
+        if (g_placement.tx.empty() && g_placement.rx.empty() && g_placement.workers.empty()) return;
+        std::cout << "Afinidad: tx=" << format_cpu_list(g_placement.tx)
+                  << " rx=" << format_cpu_list(g_placement.rx)
+                  << " workers=" << format_cpu_list(g_placement.workers);
+        if (g_placement.numa_node >= 0) std::cout << " (nodo NUMA " << g_placement.numa_node << ")";
+        std::cout << std::endl;
+    }
+
+    const Placement& placement() {
+        return g_placement;
+    }
+
+    static const std::vector<int>& cpus_for(Role role) {
+        switch (role) {
+            case Role::TX: return g_placement.tx;
+            case Role::RX: return g_placement.rx;
+            default: return g_placement.workers;
+        }
+    }
+
+    static bool pin_handle(pthread_t handle, Role role, int index) {
+        const std::vector<int>& cpus = cpus_for(role);
+        if (cpus.empty()) return true; // Nada que hacer para este rol
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (index >= 0) {
+            CPU_SET(cpus[index % cpus.size()], &set);
+        } else {
+            for (int cpu : cpus) CPU_SET(cpu, &set);
+        }
+        int rc = pthread_setaffinity_np(handle, sizeof(set), &set);
+        if (rc != 0) {
+            // Solo se avisa una vez, si una CPU no existe o no está permitida fallan todas igual
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true)) {
+                std::cerr << "Afinidad: no se pudo fijar el hilo (" << format_cpu_list(cpus) << "), se sigue sin fijar" << std::endl;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool pin_current_thread(Role role, int index) {
+        return pin_handle(pthread_self(), role, index);
+    }
+
+    bool pin_thread(std::thread& thread, Role role, int index) {
+        return pin_handle(thread.native_handle(), role, index);
+    }
+
+    ScopedPin::ScopedPin(Role role, int index) {
+        if (cpus_for(role).empty()) return; // No se va a tocar la máscara, no hay nada que devolver
+        CPU_ZERO(&saved);
+        if (pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) != 0) return;
+        restore = pin_current_thread(role, index);
+    }
+
+    ScopedPin::~ScopedPin() {
+        if (restore) pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    }
+
+}
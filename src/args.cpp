@@ -1,11 +1,12 @@
 #include "include/args.h"
+#include "include/affinity.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <vector>
 #include <string>
 
-static std::vector<int> parsearPuertos(const std::string& input) {
+std::vector<int> ArgsParser::parsearPuertos(const std::string& input) {
     std::vector<int> puertos;
     std::stringstream ss(input);
     std::string token;
@@ -45,9 +46,38 @@ void ArgsParser::imprimirUso(const char* prog) {
     std::cout << "  -i, --interface INTERFAZ      Interfaz de red a usar (predeterminado: enp109s0)\n\n";
     std::cout << "Opciones de Salida y Rendimiento:\n";
     std::cout << "  -t, --threads N               Número de hilos a usar (predeterminado: máximo posible)\n";
+    std::cout << "  --engine threads|reactor|pipeline\n";
+    std::cout << "                                Motor de escaneo: hilos por sondeo, un bucle epoll o etapas con colas SPSC (predeterminado: threads)\n";
+    std::cout << "  --max-inflight N              Máximo de sondeos en vuelo (predeterminado: según RLIMIT_NOFILE y memoria)\n";
+    std::cout << "  --retries N                   Reintentos para sondeos sin respuesta (solo reactor, predeterminado: 0)\n";
+    std::cout << "  --banner                      Lee el banner de los puertos TCP abiertos (solo reactor)\n";
+    std::cout << "  --affinity auto               Fija los hilos en el nodo NUMA de la NIC (captura en las CPUs de sus IRQs)\n";
+    std::cout << "  --cpu-tx LISTA                CPUs para los hilos que envían (ej. 2-5,8)\n";
+    std::cout << "  --cpu-rx LISTA                CPUs para los hilos de captura\n";
+    std::cout << "  --cpu-workers LISTA           CPUs para workers, clasificador y sumidero\n";
     std::cout << "  --timeout MS            Timeout en milisegundos (predeterminado: 2000)\n";
+    std::cout << "  --grace MS              Al interrumpir (Ctrl-C/SIGTERM), espera a los sondeos en vuelo (predeterminado: 2000)\n";
     std::cout << "  -o, --output ARCHIVO    Archivo de salida para el reporte JSON\n";
-    std::cout << "  -h, --help              Muestra esta ayuda\n";
+    std::cout << "  --binary ARCHIVO        Reporte binario indexado (se consulta con: " << prog << " query ARCHIVO...)\n";
+    std::cout << "  --diff ARCHIVO          Al terminar muestra solo lo que cambió respecto a un reporte anterior\n";
+    std::cout << "                          (también: " << prog << " diff ANTERIOR NUEVO)\n";
+    std::cout << "  --ndjson ARCHIVO        Resultados en streaming, un JSON por línea apenas termina cada puerto (- = stdout)\n";
+    std::cout << "  --phases                Al final imprime percentiles de latencia de cada fase del sondeo\n";
+    std::cout << "  --phases-json ARCHIVO   Lo mismo, también guardado en JSON\n";
+    std::cout << "  --metrics-listen [IP:]PUERTO\n";
+    std::cout << "                          Métricas en vivo en formato Prometheus por HTTP (IP predeterminada: 127.0.0.1)\n";
+    std::cout << "  --metrics-file ARCHIVO  Las mismas métricas, reescritas en el archivo cada segundo\n";
+    std::cout << "  --trace ARCHIVO         Línea de tiempo de cada sondeo en formato Chrome trace (se abre en ui.perfetto.dev)\n";
+    std::cout << "  --trace-sample N        Solo sigue 1 de cada N sondeos en el trace (predeterminado: 1, todos)\n";
+    std::cout << "  --perf-counters         Ciclos, instrucciones, fallos de caché y de saltos y cambios de contexto por sondeo\n";
+    std::cout << "                          en cada fase (envío, recepción, clasificación, salida) con perf_event_open\n";
+    std::cout << "  -h, --help              Muestra esta ayuda\n\n";
+    std::cout << "Checkpoints:\n";
+    std::cout << "  --journal ARCHIVO       Va anotando los resultados en un journal para poder retomar el escaneo\n";
+    std::cout << "  --resume ARCHIVO        Retoma el escaneo del journal (mismo objetivo) sin repetir lo terminado\n\n";
+    std::cout << "Modo Replay (no requiere root):\n";
+    std::cout << "  --replay ARCHIVO        Clasifica las respuestas de una captura pcap/pcapng en lugar de escanear\n";
+    std::cout << "  --replay-timing         Respeta los tiempos originales de la captura (predeterminado: lo más rápido posible)\n";
 }
 
 AppConfig ArgsParser::parse(int argc, char* argv[]) {
@@ -85,11 +115,83 @@ AppConfig ArgsParser::parse(int argc, char* argv[]) {
         else if ((arg == "--timeout") && i + 1 < argc) {
             try { config.timeout_ms = std::stoi(argv[++i]); } catch (...) {}
         } 
+        else if (arg == "--grace" && i + 1 < argc) {
+            try { config.grace_ms = std::max(0, std::stoi(argv[++i])); } catch (...) {}
+        }
         else if ((arg == "-o" || arg == "--output") && i + 1 < argc) {
             config.output_file = argv[++i];
+        } else if (arg == "--binary" && i + 1 < argc) {
+            config.binary_file = argv[++i];
+        } else if (arg == "--diff" && i + 1 < argc) {
+            config.diff_file = argv[++i];
+        } else if (arg == "--ndjson" && i + 1 < argc) {
+            config.ndjson_file = argv[++i];
+        } else if (arg == "--phases") {
+            config.phase_stats = true;
+        } else if (arg == "--phases-json" && i + 1 < argc) {
+            config.phase_stats = true;
+            config.phase_json = argv[++i];
+        } else if (arg == "--metrics-listen" && i + 1 < argc) {
+            config.metrics_listen = argv[++i];
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            config.metrics_file = argv[++i];
+        } else if (arg == "--perf-counters") {
+            config.perf_counters = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            config.trace_file = argv[++i];
+        } else if (arg == "--trace-sample" && i + 1 < argc) {
+            try { config.trace_sample = (uint32_t)std::max(1, std::stoi(argv[++i])); } catch (...) {}
         } else if ((arg == "-i" || arg == "--interface") && i + 1 < argc) {
             config.interface = argv[++i];
         }
+        else if (arg == "--engine" && i + 1 < argc) {
+            std::string engine = argv[++i];
+            if (engine == "threads") config.engine = ScanEngine::THREADS;
+            else if (engine == "reactor") config.engine = ScanEngine::REACTOR;
+            else if (engine == "pipeline") config.engine = ScanEngine::PIPELINE;
+            else {
+                std::cerr << "error, motor desconocido: " << engine << std::endl;
+                config.args_validos = false;
+            }
+        }
+        else if (arg == "--max-inflight" && i + 1 < argc) {
+            try { config.max_inflight = (size_t)std::max(0, std::stoi(argv[++i])); } catch (...) {}
+        }
+        else if (arg == "--retries" && i + 1 < argc) {
+            try { config.retries = std::max(0, std::stoi(argv[++i])); } catch (...) {}
+        } else if (arg == "--banner") {
+            config.banner = true;
+        }
+        else if (arg == "--affinity" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "auto") config.affinity_auto = true;
+            else {
+                std::cerr << "error, modo de afinidad desconocido: " << mode << std::endl;
+                config.args_validos = false;
+            }
+        }
+        else if ((arg == "--cpu-tx" || arg == "--cpu-rx" || arg == "--cpu-workers") && i + 1 < argc) {
+            std::string list = argv[++i];
+            std::vector<int> cpus;
+            if (!Affinity::parse_cpu_list(list, cpus)) {
+                std::cerr << "error, lista de CPUs inválida para " << arg << ": " << list << std::endl;
+                config.args_validos = false;
+            }
+            if (arg == "--cpu-tx") config.cpu_tx = list;
+            else if (arg == "--cpu-rx") config.cpu_rx = list;
+            else config.cpu_workers = list;
+        }
+        else if (arg == "--journal" && i + 1 < argc) {
+            config.journal_file = argv[++i];
+        } else if (arg == "--resume" && i + 1 < argc) {
+            config.journal_file = argv[++i];
+            config.resume = true;
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            config.replay_file = argv[++i];
+        } else if (arg == "--replay-timing") {
+            config.replay_timing = true;
+        }
     }
 
     if (!protocol_explicitly_set) {
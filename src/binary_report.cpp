@@ -0,0 +1,286 @@
+#include "include/binary_report.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::endian::native == std::endian::little, "el formato binario se escribe tal cual en little-endian");
+
+namespace BinaryReport {
+
+    static uint64_t align8(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    bool parse_ipv4(const std::string& text, uint32_t& ipv4) {
+        in_addr addr{};
+        if (inet_pton(AF_INET, text.c_str(), &addr) != 1) return false;
+        ipv4 = ntohl(addr.s_addr);
+        return true;
+    }
+
+    std::string format_ipv4(uint32_t ipv4) {
+        in_addr addr{};
+        addr.s_addr = htonl(ipv4);
+        char text[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr, text, sizeof(text));
+        return text;
+    }
+
+    static void pad_to(std::ofstream& o, uint64_t& offset, uint64_t target) {
+        static const char zeros[8] = {};
+        o.write(zeros, static_cast<std::streamsize>(target - offset));
+        offset = target;
+    }
+
+    bool write(const AppConfig& config, const std::vector<ScanResult>& results) {
+        uint32_t ipv4 = 0;
+        if (!parse_ipv4(config.target_ip, ipv4)) {
+            std::cerr << "El reporte binario solo acepta objetivos IPv4: " << config.target_ip << std::endl;
+            return false;
+        }
+
+        // Mismo criterio que el JSON: sin cerrados y en orden (puerto, protocolo)
+        std::vector<const ScanResult*> ordered;
+        ordered.reserve(results.size());
+        for (const auto& result : results) {
+            if (result.status != PortStatus::CLOSED) ordered.push_back(&result);
+        }
+        std::sort(ordered.begin(), ordered.end(), [](const ScanResult* a, const ScanResult* b) {
+            return result_order(*a, *b);
+        });
+
+        // Tabla de servicios: cada nombre distinto una sola vez
+        std::unordered_map<std::string, uint16_t> service_ids;
+        std::vector<const std::string*> services;
+        std::string banners;
+        std::vector<Record> records(ordered.size());
+        for (size_t i = 0; i < ordered.size(); ++i) {
+            const ScanResult& result = *ordered[i];
+            Record& record = records[i];
+            record = Record{};
+            record.ipv4 = ipv4;
+            record.port = static_cast<uint16_t>(result.port);
+            record.protocol = static_cast<uint8_t>(result.protocol);
+            record.status = static_cast<uint8_t>(result.status);
+            record.rtt_ns = result.rtt_ns;
+
+            auto [it, inserted] = service_ids.try_emplace(result.service, static_cast<uint16_t>(services.size()));
+            if (inserted) {
+                if (services.size() == UINT16_MAX) {
+                    std::cerr << "Demasiados servicios distintos para el reporte binario" << std::endl;
+                    return false;
+                }
+                services.push_back(&it->first);
+            }
+            record.service_id = it->second;
+
+            record.header_len = static_cast<uint8_t>(std::min(result.header_bytes.size(), HEADER_SNAPSHOT));
+            std::memcpy(record.header, result.header_bytes.data(), record.header_len);
+            if (!result.banner.empty()) {
+                record.banner_offset = static_cast<uint32_t>(banners.size());
+                record.banner_len = static_cast<uint32_t>(result.banner.size());
+                banners += result.banner;
+            }
+        }
+
+        std::vector<uint32_t> service_offsets;
+        std::string service_text;
+        for (const std::string* name : services) {
+            service_offsets.push_back(static_cast<uint32_t>(service_text.size()));
+            service_text += *name;
+        }
+        service_offsets.push_back(static_cast<uint32_t>(service_text.size()));
+
+        // Un archivo es un solo escaneo, así que hay un host y el índice por puerto sigue el orden de
+        // los registros. Se arma igual que con varios hosts para que el lector no dependa de eso
+        HostIndex host{ipv4, 0, 0, records.size()};
+        std::vector<uint32_t> port_ids(records.size());
+        for (size_t i = 0; i < port_ids.size(); ++i) port_ids[i] = static_cast<uint32_t>(i);
+        std::stable_sort(port_ids.begin(), port_ids.end(), [&](uint32_t a, uint32_t b) {
+            const Record& ra = records[a];
+            const Record& rb = records[b];
+            if (ra.port != rb.port) return ra.port < rb.port;
+            return ra.protocol < rb.protocol;
+        });
+
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.header_size = sizeof(FileHeader);
+        header.record_size = sizeof(Record);
+        timespec now{};
+        clock_gettime(CLOCK_REALTIME, &now);
+        header.created_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+        header.record_count = records.size();
+        header.records_offset = sizeof(FileHeader);
+        header.services_offset = align8(header.records_offset + records.size() * sizeof(Record));
+        header.services_size = sizeof(uint32_t) * (1 + service_offsets.size()) + service_text.size();
+        header.banners_offset = align8(header.services_offset + header.services_size);
+        header.banners_size = banners.size();
+        header.hosts_offset = align8(header.banners_offset + header.banners_size);
+        header.host_count = records.empty() ? 0 : 1;
+        header.ports_offset = align8(header.hosts_offset + header.host_count * sizeof(HostIndex));
+
+        // Se escribe en un temporal y se renombra, igual que el JSON
+        std::string tmp_file = config.binary_file + ".tmp";
+        {
+            std::ofstream o(tmp_file, std::ios::binary);
+            uint64_t offset = 0;
+            auto put = [&](const void* data, uint64_t size) {
+                o.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                offset += size;
+            };
+            uint32_t service_count = static_cast<uint32_t>(services.size());
+
+            put(&header, sizeof(header));
+            put(records.data(), records.size() * sizeof(Record));
+            pad_to(o, offset, header.services_offset);
+            put(&service_count, sizeof(service_count));
+            put(service_offsets.data(), service_offsets.size() * sizeof(uint32_t));
+            put(service_text.data(), service_text.size());
+            pad_to(o, offset, header.banners_offset);
+            put(banners.data(), banners.size());
+            pad_to(o, offset, header.hosts_offset);
+            if (header.host_count > 0) put(&host, sizeof(host));
+            pad_to(o, offset, header.ports_offset);
+            put(port_ids.data(), port_ids.size() * sizeof(uint32_t));
+
+            o.flush();
+            if (!o) {
+                std::cerr << "Error al escribir " << tmp_file << std::endl;
+                return false;
+            }
+        }
+        if (std::rename(tmp_file.c_str(), config.binary_file.c_str()) != 0) {
+            perror("Error al renombrar el reporte binario");
+            return false;
+        }
+        return true;
+    }
+
+    MappedFile::~MappedFile() {
+        if (base) munmap(const_cast<unsigned char*>(base), length);
+    }
+
+    // Que [offset, offset + size) quepa en el archivo sin desbordar la suma
+    static bool fits(uint64_t offset, uint64_t size, size_t length) {
+        return offset <= length && size <= length - offset;
+    }
+
+    bool MappedFile::open(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+            ::close(fd);
+            error = "archivo demasiado corto";
+            return false;
+        }
+        length = static_cast<size_t>(st.st_size);
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            error = std::strerror(errno);
+            return false;
+        }
+        base = static_cast<const unsigned char*>(mapped);
+
+        const FileHeader& h = header();
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            error = "no es un reporte binario";
+            return false;
+        }
+        if (h.version != VERSION) {
+            error = "versión " + std::to_string(h.version) + " no soportada";
+            return false;
+        }
+        if (h.header_size < sizeof(FileHeader) || h.record_size < sizeof(Record) || h.record_size % 8 != 0) {
+            error = "tamaños de cabecera o registro inválidos";
+            return false;
+        }
+        // Ninguna sección puede empezar dentro de la cabecera (header_size puede ser mayor en versiones nuevas)
+        uint64_t first_section = std::min({h.records_offset, h.services_offset, h.banners_offset, h.hosts_offset,
+                                           h.ports_offset});
+        if (!fits(0, h.header_size, length) || first_section < h.header_size) {
+            error = "cabecera fuera del archivo";
+            return false;
+        }
+        if (h.record_count > UINT32_MAX || h.records_offset % 8 != 0 ||
+            !fits(h.records_offset, h.record_count * h.record_size, length) ||
+            !fits(h.services_offset, h.services_size, length) || h.services_size < sizeof(uint32_t) ||
+            !fits(h.banners_offset, h.banners_size, length) ||
+            h.hosts_offset % 8 != 0 || h.host_count > h.record_count ||
+            !fits(h.hosts_offset, h.host_count * sizeof(HostIndex), length) ||
+            h.ports_offset % 4 != 0 || !fits(h.ports_offset, h.record_count * sizeof(uint32_t), length)) {
+            error = "secciones fuera del archivo";
+            return false;
+        }
+
+        std::memcpy(&service_count, base + h.services_offset, sizeof(uint32_t));
+        uint64_t table = sizeof(uint32_t) * (2 + uint64_t(service_count));
+        if (h.services_offset % 4 != 0 || table > h.services_size) {
+            error = "tabla de servicios inválida";
+            return false;
+        }
+        service_offsets = reinterpret_cast<const uint32_t*>(base + h.services_offset + sizeof(uint32_t));
+        service_text = reinterpret_cast<const char*>(base + h.services_offset + table);
+        uint64_t text_size = h.services_size - table;
+        for (uint32_t i = 0; i < service_count; ++i) {
+            if (service_offsets[i] > service_offsets[i + 1] || service_offsets[i + 1] > text_size) {
+                error = "tabla de servicios inválida";
+                return false;
+            }
+        }
+        hosts = reinterpret_cast<const HostIndex*>(base + h.hosts_offset);
+        port_ids = reinterpret_cast<const uint32_t*>(base + h.ports_offset);
+
+        // Los registros NO se recorren aquí (sería leer todo el archivo), cada consulta revisa con valid()
+        // los que toca
+        for (uint64_t i = 0; i < h.host_count; ++i) {
+            if (hosts[i].first > h.record_count || hosts[i].count > h.record_count - hosts[i].first) {
+                error = "índice por host inválido";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool MappedFile::valid(const Record& r) const {
+        return r.header_len <= HEADER_SNAPSHOT && r.service_id < service_count &&
+               fits(r.banner_offset, r.banner_len, header().banners_size);
+    }
+
+    std::string_view MappedFile::service(uint16_t id) const {
+        return std::string_view(service_text + service_offsets[id], service_offsets[id + 1] - service_offsets[id]);
+    }
+
+    std::string_view MappedFile::banner(const Record& r) const {
+        return std::string_view(reinterpret_cast<const char*>(base + header().banners_offset + r.banner_offset), r.banner_len);
+    }
+
+    bool MappedFile::host_range(uint32_t ipv4, uint64_t& first, uint64_t& count) const {
+        const HostIndex* end = hosts + header().host_count;
+        const HostIndex* it = std::lower_bound(hosts, end, ipv4, [](const HostIndex& h, uint32_t ip) { return h.ipv4 < ip; });
+        if (it == end || it->ipv4 != ipv4) {
+            first = count = 0;
+            return false;
+        }
+        first = it->first;
+        count = it->count;
+        return true;
+    }
+
+}
@@ -0,0 +1,69 @@
+#include "include/coro.h"
+#include <new>
+#include <vector>
+
+namespace Coro {
+
+    namespace {
+        constexpr size_t CLASS_SIZE = 64;
+        constexpr size_t NUM_CLASSES = 64;        // Frames de hasta 4 KB salen del pool
+        constexpr size_t CHUNK_SIZE = 64 * 1024;  // Se pide memoria al sistema de 64 KB en 64 KB
+
+        struct FreeNode { FreeNode* next; };
+
+        // Un pool por hilo, así no hace falta ningún lock (cada EventLoop vive en un solo hilo)
+        struct ThreadPool {
+            FreeNode* free_lists[NUM_CLASSES] = {};
+            std::vector<void*> chunks;
+            char* bump = nullptr;
+            size_t bump_left = 0;
+
+            ~ThreadPool() {
+                for (void* chunk : chunks) ::operator delete(chunk);
+            }
+
+            void* take(size_t cls) {
+                if (FreeNode* node = free_lists[cls]) {
+                    free_lists[cls] = node->next;
+                    return node;
+                }
+                size_t bytes = (cls + 1) * CLASS_SIZE;
+                if (bump_left < bytes) {
+                    bump = static_cast<char*>(::operator new(CHUNK_SIZE));
+                    chunks.push_back(bump);
+                    bump_left = CHUNK_SIZE;
+                }
+                void* ptr = bump;
+                bump += bytes;
+                bump_left -= bytes;
+                return ptr;
+            }
+
+            void give(void* ptr, size_t cls) {
+                auto* node = static_cast<FreeNode*>(ptr);
+                node->next = free_lists[cls];
+                free_lists[cls] = node;
+            }
+        };
+
+        thread_local ThreadPool t_pool;
+
+        size_t size_class(size_t size) { return (size + CLASS_SIZE - 1) / CLASS_SIZE - 1; }
+    }
+
+    void* FramePool::allocate(size_t size) {
+        size_t cls = size_class(size);
+        if (cls >= NUM_CLASSES) return ::operator new(size);
+        return t_pool.take(cls);
+    }
+
+    void FramePool::deallocate(void* ptr, size_t size) noexcept {
+        size_t cls = size_class(size);
+        if (cls >= NUM_CLASSES) {
+            ::operator delete(ptr);
+            return;
+        }
+        t_pool.give(ptr, cls);
+    }
+
+}
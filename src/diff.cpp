@@ -0,0 +1,697 @@
+#include "include/diff.h"
+#include "include/binary_report.h"
+#include "include/JSONGen.h"
+#include "include/json_writer.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <limits>
+#include <tuple>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Diff {
+
+    // Un resultado con los campos que se comparan, en texto como salen en el JSON (el binario se
+    // convierte igual) para poder comparar entre formatos
+    struct Entry {
+        uint32_t ipv4 = 0;
+        int port = 0;
+        Protocol protocol = Protocol::TCP;
+        std::string status;
+        bool exact_status = true;   // El JSON escribe open|filtered como "unknown", ahí no se distinguen
+        std::string service;
+        std::string header;
+        std::string banner;
+    };
+
+    static auto key(const Entry& entry) {
+        return std::make_tuple(entry.ipv4, entry.port, static_cast<int>(entry.protocol));
+    }
+
+    // Los reportes no guardan los cerrados: un puerto que falta de un lado cuenta como cerrado
+    static const std::string CLOSED = "closed";
+
+    // El binario y los resultados en memoria sí guardan el estado completo, con los nombres de query --status
+    static const char* status_text(PortStatus status) {
+        static constexpr const char* NAMES[] = {"open", "closed", "filtered", "open_filtered", "unknown"};
+        return NAMES[std::min<int>(static_cast<int>(status), 4)];
+    }
+
+    class Source {
+    public:
+        virtual ~Source() = default;
+        // false al terminar o con error (error no vacío)
+        virtual bool next(Entry& entry) = 0;
+        std::string error;
+    };
+
+    // ---------- JSON / NDJSON ----------
+
+    // Archivo de texto mapeado completo, de solo lectura
+    class Mapping {
+    public:
+        ~Mapping() {
+            if (data && size > 0) munmap(const_cast<char*>(data), size);
+        }
+        bool open(const std::string& path, std::string& error) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                error = std::strerror(errno);
+                return false;
+            }
+            struct stat st{};
+            if (fstat(fd, &st) < 0) {
+                error = std::strerror(errno);
+                ::close(fd);
+                return false;
+            }
+            size = static_cast<size_t>(st.st_size);
+            if (size > 0) {
+                void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    error = std::strerror(errno);
+                    ::close(fd);
+                    size = 0;
+                    return false;
+                }
+                madvise(mapped, size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapped);
+            }
+            ::close(fd);
+            return true;
+        }
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Lector JSON de tipo "pull" sobre el texto mapeado: se piden los tokens en el orden esperado y lo que
+    // no interesa se salta sin construir nada, así un reporte de varios GB se lee de corrido
+    class JsonCursor {
+    public:
+        JsonCursor(const char* begin, const char* end) : p(begin), end(end) {}
+
+        void ws() {
+            while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+        }
+        bool at_end() {
+            ws();
+            return p >= end;
+        }
+        bool consume(char c) {
+            ws();
+            if (p < end && *p == c) {
+                ++p;
+                return true;
+            }
+            return false;
+        }
+
+        bool string(std::string& out) {
+            out.clear();
+            if (!consume('"')) return false;
+            while (p < end) {
+                // Casi ningún texto trae escapes: se busca la comilla de cierre con memchr y se copia de una vez
+                const char* run = p;
+                const char* quote = static_cast<const char*>(std::memchr(p, '"', end - p));
+                if (!quote) return false;
+                const char* escape = static_cast<const char*>(std::memchr(p, '\\', quote - p));
+                p = escape ? escape : quote;
+                out.append(run, p);
+                if (p >= end) return false;
+                if (*p++ == '"') return true;
+                if (p >= end) return false;
+                switch (*p++) {
+                    case '"':  out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/':  out += '/'; break;
+                    case 'b':  out += '\b'; break;
+                    case 'f':  out += '\f'; break;
+                    case 'n':  out += '\n'; break;
+                    case 'r':  out += '\r'; break;
+                    case 't':  out += '\t'; break;
+                    case 'u': {
+                        uint32_t code = 0;
+                        if (!hex4(code)) return false;
+                        // Par sustituto de UTF-16
+                        if (code >= 0xd800 && code < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                            p += 2;
+                            uint32_t low = 0;
+                            if (!hex4(low) || low < 0xdc00 || low > 0xdfff) return false;
+                            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        }
+                        utf8(code, out);
+                        break;
+                    }
+                    default: return false;
+                }
+            }
+            return false;
+        }
+
+        bool integer(long long& value) {
+            ws();
+            bool negative = p < end && *p == '-';
+            if (negative) ++p;
+            if (p >= end || *p < '0' || *p > '9') return false;
+            value = 0;
+            while (p < end && *p >= '0' && *p <= '9') {
+                if (value > (1ll << 40)) return false; // Ningún campo que se lea es tan grande
+                value = value * 10 + (*p++ - '0');
+            }
+            if (negative) value = -value;
+            return true;
+        }
+
+        // Se salta un valor completo (anidado o no) sin decodificarlo
+        bool skip_value() {
+            ws();
+            if (p >= end) return false;
+            if (*p == '"') return skip_string();
+            if (*p == '{' || *p == '[') {
+                int depth = 0;
+                while (p < end) {
+                    char c = *p;
+                    if (c == '"') {
+                        if (!skip_string()) return false;
+                        continue;
+                    }
+                    ++p;
+                    if (c == '{' || c == '[') ++depth;
+                    else if ((c == '}' || c == ']') && --depth == 0) return true;
+                }
+                return false;
+            }
+            const char* start = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') ++p;
+            return p > start;
+        }
+
+    private:
+        bool skip_string() {
+            ++p;
+            while (p < end) {
+                if (*p == '\\') p += 2;
+                else if (*p++ == '"') return true;
+            }
+            return false;
+        }
+
+        bool hex4(uint32_t& code) {
+            if (end - p < 4) return false;
+            for (int i = 0; i < 4; ++i) {
+                char c = *p++;
+                code <<= 4;
+                if (c >= '0' && c <= '9') code |= c - '0';
+                else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+                else return false;
+            }
+            return true;
+        }
+
+        static void utf8(uint32_t code, std::string& out) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xc0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xe0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            } else {
+                out += static_cast<char>(0xf0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            }
+        }
+
+        const char* p;
+        const char* end;
+    };
+
+    // Un objeto resultado ({"ip":..., "port":..., ...}); las llaves pueden venir en cualquier orden
+    static bool read_entry(JsonCursor& cursor, Entry& entry, std::string& scratch, std::string& error) {
+        entry.header.clear();
+        entry.banner.clear();
+        entry.service.clear();
+        entry.status.clear();
+        entry.exact_status = false;
+        bool has_ip = false, has_port = false;
+        if (!cursor.consume('{')) {
+            error = "se esperaba un objeto";
+            return false;
+        }
+        if (cursor.consume('}')) {
+            error = "resultado vacío";
+            return false;
+        }
+        do {
+            if (!cursor.string(scratch) || !cursor.consume(':')) {
+                error = "JSON inválido";
+                return false;
+            }
+            bool ok = true;
+            if (scratch == "ip") {
+                ok = cursor.string(scratch) && BinaryReport::parse_ipv4(scratch, entry.ipv4);
+                has_ip = ok;
+            } else if (scratch == "port") {
+                long long port = 0;
+                ok = cursor.integer(port) && port >= 0 && port <= 65535;
+                entry.port = static_cast<int>(port);
+                has_port = ok;
+            } else if (scratch == "protocol") {
+                ok = cursor.string(scratch) && (scratch == "TCP" || scratch == "UDP");
+                entry.protocol = scratch == "UDP" ? Protocol::UDP : Protocol::TCP;
+            } else if (scratch == "status") {
+                ok = cursor.string(entry.status);
+            } else if (scratch == "service") {
+                ok = cursor.string(entry.service);
+            } else if (scratch == "header_bytes") {
+                ok = cursor.string(entry.header);
+            } else if (scratch == "banner") {
+                ok = cursor.string(entry.banner);
+            } else {
+                ok = cursor.skip_value();
+            }
+            if (!ok) {
+                error = "valor inválido en \"" + scratch + "\"";
+                return false;
+            }
+        } while (cursor.consume(','));
+        if (!cursor.consume('}')) {
+            error = "JSON inválido";
+            return false;
+        }
+        if (!has_ip || !has_port) {
+            error = "resultado sin ip o puerto";
+            return false;
+        }
+        return true;
+    }
+
+    // Reporte de -o: se saltan las llaves de nivel 0 hasta "results" y de ahí se lee un elemento a la vez.
+    // Viene ordenado por (puerto, protocolo) con un solo objetivo
+    class JsonReportSource : public Source {
+    public:
+        JsonReportSource(std::unique_ptr<Mapping> mapping)
+            : mapping(std::move(mapping)), cursor(this->mapping->data, this->mapping->data + this->mapping->size) {}
+
+        bool start() {
+            if (!cursor.consume('{')) {
+                error = "no es un reporte JSON";
+                return false;
+            }
+            do {
+                if (!cursor.string(scratch) || !cursor.consume(':')) break;
+                if (scratch == "results") {
+                    if (!cursor.consume('[')) break;
+                    done = cursor.consume(']');
+                    return true;
+                }
+                if (!cursor.skip_value()) break;
+            } while (cursor.consume(','));
+            error = "el reporte no tiene \"results\"";
+            return false;
+        }
+
+        bool next(Entry& entry) override {
+            if (done) return false;
+            if (!first && !cursor.consume(',')) {
+                if (!cursor.consume(']')) error = "JSON inválido en \"results\"";
+                done = true;
+                return false;
+            }
+            first = false;
+            if (!read_entry(cursor, entry, scratch, error)) {
+                done = true;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        std::unique_ptr<Mapping> mapping;
+        JsonCursor cursor;
+        std::string scratch;
+        bool first = true;
+        bool done = false;
+    };
+
+    // NDJSON: se escribe en el orden en que terminan los puertos, así que es la única entrada que no
+    // viene ordenada. Se carga y se ordena en memoria
+    class NdjsonSource : public Source {
+    public:
+        bool load(const Mapping& mapping) {
+            JsonCursor cursor(mapping.data, mapping.data + mapping.size);
+            std::string scratch;
+            while (!cursor.at_end()) {
+                Entry entry;
+                if (!read_entry(cursor, entry, scratch, error)) return false;
+                entries.push_back(std::move(entry));
+            }
+            std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return key(a) < key(b); });
+            return true;
+        }
+
+        bool next(Entry& entry) override {
+            if (position >= entries.size()) return false;
+            entry = std::move(entries[position++]);
+            return true;
+        }
+
+    private:
+        std::vector<Entry> entries;
+        size_t position = 0;
+    };
+
+    // ---------- Binario y resultados en memoria ----------
+
+    static void hex(const unsigned char* data, size_t size, std::string& out) {
+        out.assign(size > 0 ? size * 3 - 1 : 0, ' ');
+        JsonWriter::encode_hex(data, size, out.data());
+    }
+
+    // Los registros del binario ya van ordenados por (host, puerto, protocolo)
+    class BinarySource : public Source {
+    public:
+        bool open(const std::string& path) {
+            return file.open(path, error);
+        }
+
+        bool next(Entry& entry) override {
+            if (position >= file.size()) return false;
+            const BinaryReport::Record& record = file.record(position++);
+            if (!file.valid(record)) {
+                error = "registro " + std::to_string(position - 1) + " inválido";
+                return false;
+            }
+            entry.ipv4 = record.ipv4;
+            entry.port = record.port;
+            entry.protocol = record.protocol == 0 ? Protocol::TCP : Protocol::UDP;
+            entry.status = status_text(static_cast<PortStatus>(record.status));
+            entry.service = file.service(record.service_id);
+            hex(record.header, record.header_len, entry.header);
+            entry.banner = file.banner(record);
+            return true;
+        }
+
+    private:
+        BinaryReport::MappedFile file;
+        uint64_t position = 0;
+    };
+
+    // El escaneo que acaba de terminar (--diff): mismo filtro y orden que el reporte JSON
+    class ResultsSource : public Source {
+    public:
+        ResultsSource(const AppConfig& config, const std::vector<ScanResult>& results) {
+            BinaryReport::parse_ipv4(config.target_ip, ipv4);
+            for (const auto& result : results) {
+                if (result.status != PortStatus::CLOSED) ordered.push_back(&result);
+            }
+            std::sort(ordered.begin(), ordered.end(), [](const ScanResult* a, const ScanResult* b) {
+                return result_order(*a, *b);
+            });
+        }
+
+        bool next(Entry& entry) override {
+            if (position >= ordered.size()) return false;
+            const ScanResult& result = *ordered[position++];
+            entry.ipv4 = ipv4;
+            entry.port = result.port;
+            entry.protocol = result.protocol;
+            entry.status = status_text(result.status);
+            entry.service = result.service;
+            hex(result.header_bytes.data(), result.header_bytes.size(), entry.header);
+            entry.banner = result.banner;
+            return true;
+        }
+
+    private:
+        uint32_t ipv4 = 0;
+        std::vector<const ScanResult*> ordered;
+        size_t position = 0;
+    };
+
+    // El binario se reconoce por el magic; un JSON cuya primera llave es de las del reporte es el reporte
+    // de -o, cualquier otro objeto se toma como NDJSON
+    static std::unique_ptr<Source> open_source(const std::string& path, std::string& error) {
+        auto mapping = std::make_unique<Mapping>();
+        if (!mapping->open(path, error)) return nullptr;
+        if (mapping->size >= sizeof(BinaryReport::MAGIC) &&
+            std::memcmp(mapping->data, BinaryReport::MAGIC, sizeof(BinaryReport::MAGIC)) == 0) {
+            auto source = std::make_unique<BinarySource>();
+            if (!source->open(path)) {
+                error = source->error;
+                return nullptr;
+            }
+            return source;
+        }
+
+        JsonCursor probe(mapping->data, mapping->data + mapping->size);
+        std::string first_key;
+        if (!probe.consume('{')) {
+            error = "formato desconocido (ni JSON ni binario)";
+            return nullptr;
+        }
+        probe.string(first_key);
+        if (first_key == "capture" || first_key == "partial" || first_key == "results" || first_key == "resume") {
+            auto source = std::make_unique<JsonReportSource>(std::move(mapping));
+            if (!source->start()) {
+                error = source->error;
+                return nullptr;
+            }
+            return source;
+        }
+        auto source = std::make_unique<NdjsonSource>();
+        if (!source->load(*mapping)) {
+            error = source->error;
+            return nullptr;
+        }
+        return source;
+    }
+
+    // ---------- Merge y salida ----------
+
+    class Printer {
+    public:
+        explicit Printer(bool json) : json(json) {}
+
+        void emit(const char* change, const Entry& entry, const std::string& before, const std::string& after) {
+            ++changes;
+            const char* protocol = JSONGenerator::protocol_name(entry.protocol);
+            if (json) {
+                writer.begin_object();
+                writer.key("after");     writer.value(after);
+                writer.key("before");    writer.value(before);
+                writer.key("change");    writer.value(change);
+                writer.key("ip");        writer.value(BinaryReport::format_ipv4(entry.ipv4));
+                writer.key("port");      writer.value(entry.port);
+                writer.key("protocol");  writer.value(protocol);
+                writer.end_object();
+                writer.newline();
+                if (writer.size() >= (1 << 20)) flush();
+                return;
+            }
+            if (changes == 1) {
+                std::cout << "HOST\t\tPUERTO\t\tCAMBIO\t\tANTES -> DESPUÉS\n";
+                std::cout << "----\t\t------\t\t------\t\t----------------\n";
+            }
+            std::cout << BinaryReport::format_ipv4(entry.ipv4) << "\t" << entry.port << "/" << protocol << "\t\t"
+                      << change << "\t\t" << (before.empty() ? "-" : before) << " -> " << (after.empty() ? "-" : after) << "\n";
+        }
+
+        void flush() {
+            if (json) {
+                fwrite(writer.buffer().data(), 1, writer.size(), stdout);
+                fflush(stdout);
+                writer.clear();
+            } else {
+                std::cout << std::flush;
+            }
+        }
+
+        size_t changes = 0;
+
+    private:
+        bool json;
+        JsonWriter writer;
+    };
+
+    // La cabecera IPv4 cambia en cada respuesta en la identificación (bytes 4-5) y por lo tanto en el
+    // checksum (bytes 10-11); esos se ignoran para que el diff no marque todos los puertos UDP
+    static bool same_header(const std::string& a, const std::string& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            size_t byte = i / 3;
+            if (byte == 4 || byte == 5 || byte == 10 || byte == 11) continue;
+            if (a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    // Un "unknown" leído de JSON puede haber sido open_filtered; contra el estado completo del otro lado
+    // eso no cuenta como cambio
+    static bool same_status(const Entry* before, const Entry* after) {
+        const std::string& old_status = before ? before->status : CLOSED;
+        const std::string& new_status = after ? after->status : CLOSED;
+        if (old_status == new_status) return true;
+        auto ambiguous = [](const Entry* entry) { return entry && !entry->exact_status && entry->status == "unknown"; };
+        return (ambiguous(before) && new_status == "open_filtered") || (ambiguous(after) && old_status == "open_filtered");
+    }
+
+    // Un puerto que solo está de un lado se compara contra "closed"
+    static void compare(const Entry* before, const Entry* after, Printer& out) {
+        const Entry& entry = after ? *after : *before;
+        const std::string& old_status = before ? before->status : CLOSED;
+        const std::string& new_status = after ? after->status : CLOSED;
+        if (!same_status(before, after)) {
+            const char* change = new_status == "open" ? "opened" : old_status == "open" ? "closed" : "status";
+            out.emit(change, entry, old_status, new_status);
+        }
+        if (!before || !after) return;
+        if (before->service != after->service) out.emit("service", entry, before->service, after->service);
+        if (!same_header(before->header, after->header)) out.emit("header", entry, before->header, after->header);
+        if (before->banner != after->banner) out.emit("banner", entry, before->banner, after->banner);
+    }
+
+    // Avanza una entrada y revisa que el orden se mantenga; si no, el merge daría cambios falsos
+    static bool advance(Source& source, Entry& entry, bool& has, const char* side, std::string& error) {
+        auto previous = key(entry);
+        bool had = has;
+        has = source.next(entry);
+        if (!source.error.empty()) {
+            error = std::string(side) + ": " + source.error;
+            return false;
+        }
+        if (has && had && key(entry) < previous) {
+            error = std::string(side) + ": los resultados no vienen ordenados por (objetivo, puerto, protocolo)";
+            return false;
+        }
+        return true;
+    }
+
+    // scope (indexado con task_slot, solo con --diff) deja fuera lo que este escaneo no sondeó: un puerto
+    // del reporte anterior que no estaba en -p no se cerró, simplemente no se volvió a ver
+    static bool merge(Source& before, Source& after, Printer& out, std::string& error,
+                      const std::vector<bool>* scope = nullptr, uint32_t scope_ipv4 = 0) {
+        auto in_scope = [&](const Entry& entry) {
+            return !scope || (entry.ipv4 == scope_ipv4 && (*scope)[task_slot(entry.protocol, entry.port)]);
+        };
+        Entry a, b;
+        bool has_a = false, has_b = false;
+        if (!advance(before, a, has_a, "anterior", error) || !advance(after, b, has_b, "nuevo", error)) return false;
+        while (has_a || has_b) {
+            if (has_a && (!has_b || key(a) < key(b))) {
+                if (in_scope(a)) compare(&a, nullptr, out);
+                if (!advance(before, a, has_a, "anterior", error)) return false;
+            } else if (has_b && (!has_a || key(b) < key(a))) {
+                compare(nullptr, &b, out);
+                if (!advance(after, b, has_b, "nuevo", error)) return false;
+            } else {
+                compare(&a, &b, out);
+                if (!advance(before, a, has_a, "anterior", error) || !advance(after, b, has_b, "nuevo", error)) return false;
+            }
+        }
+        return true;
+    }
+
+    static void usage(const char* prog) {
+        std::cout << "Uso: " << prog << " diff ANTERIOR NUEVO [--json]\n\n";
+        std::cout << "Muestra solo lo que cambió entre dos escaneos (JSON de -o, binario de --binary o NDJSON)\n\n";
+        std::cout << "  --json                    Un cambio por línea en JSON (after, before, change, ip, port, protocol)\n\n";
+        std::cout << "Cambios: opened, closed, status, service, header, banner. Sale con 0 si no hubo cambios y 1 si hubo\n";
+    }
+
+    int run(int argc, char* argv[]) {
+        std::vector<std::string> files;
+        bool json = false;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help") {
+                usage(argv[0]);
+                return 0;
+            } else if (arg == "--json") {
+                json = true;
+            } else if (!arg.empty() && arg[0] == '-') {
+                std::cerr << "error, opción desconocida: " << arg << std::endl;
+                return 2;
+            } else {
+                files.push_back(arg);
+            }
+        }
+        if (files.size() != 2) {
+            usage(argv[0]);
+            return 2;
+        }
+
+        std::string error;
+        auto before = open_source(files[0], error);
+        if (!before) {
+            std::cerr << files[0] << ": " << error << std::endl;
+            return 2;
+        }
+        auto after = open_source(files[1], error);
+        if (!after) {
+            std::cerr << files[1] << ": " << error << std::endl;
+            return 2;
+        }
+
+        Printer out(json);
+        bool ok = merge(*before, *after, out, error);
+        out.flush();
+        if (!ok) {
+            std::cerr << error << std::endl;
+            return 2;
+        }
+        return out.changes > 0 ? 1 : 0;
+    }
+
+    bool against(const AppConfig& config, const std::vector<ScanResult>& results, const std::string& previous,
+                 const Shutdown::Progress& progress) {
+        std::string error;
+        auto before = open_source(previous, error);
+        if (!before) {
+            std::cerr << previous << ": " << error << std::endl;
+            return false;
+        }
+        ResultsSource after(config, results);
+        // Interrumpido, el generador no llegó al final y lo que quedó en vuelo no tiene resultado: un puerto
+        // abierto del anterior que cae ahí no se cerró, simplemente no se volvió a ver. Mismo orden
+        // puerto x protocolo que TaskGenerator, así position cuenta también lo retomado del journal
+        std::vector<bool> scope(TASK_SLOTS, false);
+        size_t reached = progress.interrupted ? progress.position : std::numeric_limits<size_t>::max();
+        size_t position = 0;
+        for (int port : config.ports) {
+            for (Protocol protocol : config.protocols_to_scan) {
+                if (position++ < reached) scope[task_slot(protocol, port)] = true;
+            }
+        }
+        for (const ScanTask& task : progress.incomplete) scope[task_slot(task.protocol, task.port)] = false;
+        uint32_t ipv4 = 0;
+        BinaryReport::parse_ipv4(config.target_ip, ipv4);
+
+        std::cout << "\nCambios respecto a " << previous << ":" << std::endl;
+        if (progress.interrupted) {
+            std::cout << "(Escaneo interrumpido: solo se compara lo que terminó, "
+                      << std::count(scope.begin(), scope.end(), true) << " de " << progress.total << " sondeos)" << std::endl;
+        }
+        Printer out(false);
+        bool ok = merge(*before, after, out, error, &scope, ipv4);
+        out.flush();
+        if (!ok) {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        if (out.changes == 0) std::cout << "Sin cambios." << std::endl;
+        return true;
+    }
+
+}
@@ -1,4 +1,8 @@
 #include "include/escaneo.h"
+#include "include/timing.h"
+#include "include/trace.h"
+#include "include/usdt.h"
+#include "include/perf_counters.h"
 #include <cstring>
 #include <unistd.h>
 #include <arpa/inet.h>
@@ -11,21 +15,30 @@ Scanner::Scanner(const std::string& ip, int timeout)
     : target_ip(ip), timeout_ms(timeout) {}
 
 PortStatus Scanner::scanTCP(int port) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) return PortStatus::UNKNOWN;
-
-    // aquí es donde se configura el socket creado en modo no bloquente para que cuando se
-    // use connect() no se quede esperando
-    fcntl(sock, F_SETFL, O_NONBLOCK);
-
     sockaddr_in server_addr;
     server_addr.sin_family = AF_INET;
     server_addr.sin_port = htons(port); // Usa el puerto del argumento
     inet_pton(AF_INET, target_ip.c_str(), &server_addr.sin_addr);
 
-    // esto es lo que hace el handshake TCP, como es no bloqueande retonra inmediatamente
-    // usualmente con error EINPROGRESS
-    connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr));
+    int sock;
+    {
+        // --perf-counters: el envío es hasta que connect() regresa, la espera del handshake ya no
+        PerfCounters::Scope send(PerfCounters::Phase::SEND);
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) return PortStatus::UNKNOWN;
+        Trace::event(Trace::Event::SOCKET, Protocol::TCP, port);
+
+        // aquí es donde se configura el socket creado en modo no bloquente para que cuando se
+        // use connect() no se quede esperando
+        fcntl(sock, F_SETFL, O_NONBLOCK);
+
+        // esto es lo que hace el handshake TCP, como es no bloqueande retonra inmediatamente
+        // usualmente con error EINPROGRESS
+        last_sent_ns = Timing::monotonic_ns();
+        connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr));
+        Trace::event(Trace::Event::SENT, Protocol::TCP, port);
+        Usdt::probe_sent(port, Protocol::TCP, last_sent_ns);
+    }
 
     fd_set fdset;
     FD_ZERO(&fdset);
@@ -56,12 +69,14 @@ PortStatus Scanner::scanTCP(int port) {
 }
 
 bool Scanner::sendUDPProbe(int port) {
+    PerfCounters::Scope send(PerfCounters::Phase::SEND);
     // con UDP se usa SOCK_DGRAM (datagramas sin conexión)
     int sock = socket(AF_INET, SOCK_DGRAM, 0);
     if (sock < 0) {
         perror("Error al crear socket UDP");
         return false;
     }
+    Trace::event(Trace::Event::SOCKET, Protocol::UDP, port);
 
     sockaddr_in server_addr;
     server_addr.sin_family = AF_INET;
@@ -77,12 +92,16 @@ bool Scanner::sendUDPProbe(int port) {
     
     // Esto valida que el SO acepta el paquete para transmitirlo pero no confirma si llegó
     // así que sirve para errores locales como permisos o así
+    last_sent_ns = Timing::monotonic_ns();
     if (sendto(sock, payload, 0, 0, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
         perror("Error en sendto() al enviar paquete UDP");
         close(sock);
         return false;
     }
     
+    Trace::event(Trace::Event::SENT, Protocol::UDP, port);
+    Usdt::probe_sent(port, Protocol::UDP, last_sent_ns);
+
     close(sock);
      // Retorna true si el paquete se puso en cola para que el SO lo mande
     return true;
@@ -0,0 +1,108 @@
+#include "include/event_loop.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+
+EventLoop::EventLoop() : epoll_fd(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll_fd < 0) perror("Error en epoll_create1");
+}
+
+EventLoop::~EventLoop() {
+    if (epoll_fd >= 0) close(epoll_fd);
+}
+
+bool EventLoop::watch(int fd, uint32_t events, FdCallback callback) {
+    if (fd < 0) return false;
+    if ((size_t)fd >= watchers.size()) watchers.resize(fd + 1);
+    Watcher& watcher = watchers[fd];
+
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u64 = ((uint64_t)(watcher.generation + 1) << 32) | (uint32_t)fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) return false;
+    watcher.generation++;
+    watcher.callback = std::move(callback);
+    ++watched_count;
+    return true;
+}
+
+void EventLoop::unwatch(int fd) {
+    if (fd < 0 || (size_t)fd >= watchers.size() || !watchers[fd].callback) return;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    watchers[fd].callback = nullptr;
+    --watched_count;
+}
+
+EventLoop::TimerId EventLoop::add_timer(Clock::time_point when, TimerCallback callback) {
+    TimerId id = next_timer_id++;
+    timer_heap.push({when, id});
+    timer_callbacks.emplace(id, std::move(callback));
+    return id;
+}
+
+void EventLoop::cancel_timer(TimerId id) {
+    timer_callbacks.erase(id);
+}
+
+void EventLoop::fire_expired_timers() {
+    auto now = Clock::now();
+    while (!timer_heap.empty() && timer_heap.top().when <= now) {
+        TimerId id = timer_heap.top().id;
+        timer_heap.pop();
+        auto it = timer_callbacks.find(id);
+        if (it == timer_callbacks.end()) continue; // Fue cancelado
+        // Se saca antes de llamarlo porque el callback puede agregar o cancelar timers
+        TimerCallback callback = std::move(it->second);
+        timer_callbacks.erase(it);
+        callback();
+    }
+}
+
+void EventLoop::run_posted() {
+    // Se cambia el vector antes de correrlos porque un callback puede hacer post() de más cosas
+    std::vector<TimerCallback> ready;
+    ready.swap(posted);
+    for (auto& callback : ready) callback();
+}
+
+void EventLoop::run() {
+    constexpr int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+    running = true;
+
+    while (running && (watched_count > 0 || !timer_callbacks.empty() || !posted.empty())) {
+        // Se duerme justo hasta el siguiente timer (redondeando hacia arriba para no despertar antes)
+        int timeout_ms = -1;
+        while (!timer_heap.empty() && !timer_callbacks.count(timer_heap.top().id)) timer_heap.pop();
+        if (!posted.empty()) {
+            timeout_ms = 0;
+        } else if (!timer_heap.empty()) {
+            // Un timer en time_point::max() (o muy lejos) no cabe en el int de epoll_wait
+            auto wait = timer_heap.top().when - Clock::now();
+            timeout_ms = wait.count() <= 0 ? 0
+                       : (int)std::min<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(wait).count(), INT_MAX);
+        }
+
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+        if (n < 0 && errno != EINTR) {
+            perror("Error en epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = (int)(uint32_t)events[i].data.u64;
+            uint32_t generation = (uint32_t)(events[i].data.u64 >> 32);
+            // Un callback anterior de esta misma vuelta pudo haber quitado (o reciclado) este fd
+            Watcher& watcher = watchers[fd];
+            if (!watcher.callback || watcher.generation != generation) continue;
+            // Copia porque el callback puede hacer unwatch de su propio fd
+            FdCallback callback = watcher.callback;
+            callback(events[i].events);
+        }
+        fire_expired_timers();
+        run_posted();
+    }
+    running = false;
+}
@@ -4,10 +4,26 @@
 #include <vector>
 #include "common.h"
 #include "args.h"
+#include "stats.h"
+#include "shutdown.h"
+#include "json_writer.h"
 
 namespace JSONGenerator {
 
-    void generate_report(const AppConfig& config, const std::vector<ScanResult>& results);
+    std::string bytes_to_hex_string(const std::vector<unsigned char>& bytes);
+
+    // Como salen en el JSON: "open"/"filtered"/"unknown" y "TCP"/"UDP"
+    const char* status_name(PortStatus status);
+    const char* protocol_name(Protocol protocol);
+
+    // Un resultado como objeto JSON en una sola línea (mismos campos que en el reporte), para NDJSON
+    std::string result_line(const AppConfig& config, const ScanResult& result);
+    // Lo mismo pero agregado al buffer del writer, sin allocs si el buffer ya tiene capacidad
+    void append_result_line(JsonWriter& writer, const AppConfig& config, const ScanResult& result);
+
+    // Si el escaneo se interrumpió el reporte lleva "partial": true y en "resume" hasta dónde llegó
+    void generate_report(const AppConfig& config, const std::vector<ScanResult>& results,
+                         const ScanStats::Summary& stats, const Shutdown::Progress& progress);
 
 }
 
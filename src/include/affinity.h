@@ -0,0 +1,60 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <sched.h>
+#include "args.h"
+
+namespace Affinity {
+
+    // Qué hace el hilo: mandar sondeos, leer la captura o el resto (workers, clasificador, sumidero)
+    enum class Role { TX, RX, WORKER };
+
+    // Lista de CPUs por rol, vacía = sin restricción para ese rol
+    struct Placement {
+        std::vector<int> tx;
+        std::vector<int> rx;
+        std::vector<int> workers;
+        int numa_node = -1; // Nodo NUMA de la NIC (solo en modo auto)
+    };
+
+    // Formato de sysfs/taskset: "0-3,8,10-11"
+    bool parse_cpu_list(const std::string& text, std::vector<int>& cpus);
+    std::string format_cpu_list(const std::vector<int>& cpus);
+
+    // Lectura de sysfs/procfs. -1 o vacío si la interfaz no tiene dispositivo (lo, veth, etc.)
+    int nic_numa_node(const std::string& interface);
+    std::vector<int> node_cpus(int node);
+    std::vector<int> nic_irq_cpus(const std::string& interface);
+
+    // Se llama una vez en main antes de lanzar hilos: combina --affinity auto con las listas explícitas
+    void configure(const AppConfig& config);
+    const Placement& placement();
+
+    // Fija el hilo actual (o uno ya creado) a las CPUs de su rol. Con index >= 0 y varias CPUs se
+    // reparte uno por CPU (worker i -> cpus[i % n]); si no, el hilo puede moverse dentro del set.
+    // Hay que llamarlo ANTES de reservar las estructuras grandes del hilo: Linux pone cada página en el
+    // nodo NUMA de la CPU que la toca primero, así las colas y tablas quedan junto a la NIC sin libnuma
+    bool pin_current_thread(Role role, int index = -1);
+    bool pin_thread(std::thread& thread, Role role, int index = -1);
+
+    // pin_current_thread mientras dure el objeto; al destruirse el hilo vuelve a la máscara que tenía.
+    // Para cuando el hilo de main hace parte del escaneo: el reporte, --diff y lo que siga después
+    // no se quedan encerrados en las CPUs del rol
+    class ScopedPin {
+    public:
+        explicit ScopedPin(Role role, int index = -1);
+        ~ScopedPin();
+        ScopedPin(const ScopedPin&) = delete;
+        ScopedPin& operator=(const ScopedPin&) = delete;
+
+    private:
+        cpu_set_t saved;
+        bool restore = false;
+    };
+
+}
+
+#endif
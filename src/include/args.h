@@ -5,14 +5,45 @@
 #include <vector>
 #include "common.h"
 
+// Cómo se ejecutan los sondeos: un par de hilos por sondeo (el original), un bucle epoll
+// o un pipeline de etapas unidas por colas SPSC
+enum class ScanEngine { THREADS, REACTOR, PIPELINE };
+
 struct AppConfig {
     std::string target_ip;
     std::vector<int> ports;
     std::vector<Protocol> protocols_to_scan;
     int timeout_ms = 2000;
+    int grace_ms = 2000; // Con SIGINT/SIGTERM, cuánto se espera a los sondeos en vuelo antes del reporte parcial
     std::string interface = "enp109s0";
     std::string output_file;
+    std::string ndjson_file; // Resultados en streaming, uno por línea ("-" = stdout)
+    std::string binary_file; // Reporte binario indexado, se consulta con el subcomando query
+    std::string diff_file;   // Reporte anterior (JSON, binario o NDJSON) contra el que se imprimen los cambios
+    bool phase_stats = false; // Histogramas de latencia por fase del sondeo (phases.h)
+    std::string phase_json;   // Y a dónde van en JSON
+    std::string metrics_listen; // [IP:]PUERTO del endpoint de Prometheus
+    std::string metrics_file;   // Métricas reescritas cada segundo (textfile collector)
+    std::string trace_file;     // Línea de tiempo Chrome trace (trace.h)
+    uint32_t trace_sample = 1;  // 1 de cada N sondeos en el trace
+    bool perf_counters = false; // Contadores de hardware por fase (perf_counters.h)
     size_t num_threads = 0;
+    size_t max_inflight = 0; // Sondeos en vuelo a la vez, 0 = auto (RLIMIT_NOFILE y memoria)
+    ScanEngine engine = ScanEngine::THREADS;
+    int retries = 0;     // Reintentos de sondeos sin respuesta (motor reactor)
+    bool banner = false; // Leer el banner de los puertos TCP abiertos (motor reactor)
+    // Afinidad de hilos: listas de CPUs por rol ("0-3,8") y/o modo auto por el nodo NUMA de la NIC
+    std::string cpu_tx;
+    std::string cpu_rx;
+    std::string cpu_workers;
+    bool affinity_auto = false;
+    // Checkpoints: journal donde se van anotando los resultados y, con --resume, lo que ya terminó
+    // (indexado con task_slot) para que el generador se lo salte
+    std::string journal_file;
+    bool resume = false;
+    std::vector<bool> resume_done;
+    std::string replay_file;
+    bool replay_timing = false;
     bool show_help = false;
     bool args_validos = true;
 };
@@ -20,6 +51,8 @@ struct AppConfig {
 namespace ArgsParser {
     AppConfig parse(int argc, char* argv[]);
     void imprimirUso(const char* prog);
+    // "1-100,443" -> puertos ordenados y sin repetir; lo inválido se ignora
+    std::vector<int> parsearPuertos(const std::string& input);
 }
 
 #endif
@@ -0,0 +1,115 @@
+#ifndef BINARY_REPORT_H
+#define BINARY_REPORT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "common.h"
+#include "args.h"
+
+// Reporte binario (.bin) pensado para juntar meses de escaneos y consultarlos con mmap sin parsear nada
+// Todo es little-endian y de ancho fijo:
+//   [FileHeader][Record x record_count][servicios][banners][índice por host][índice por puerto]
+// Los registros van ordenados por (host, puerto, protocolo) y el índice por host da el rango de cada
+// uno; el índice por puerto son los números de registro ordenados por (puerto, protocolo, host)
+// Versionado: record_size y header_size van en la cabecera, una versión nueva puede agregar campos al
+// final y un lector viejo los salta
+namespace BinaryReport {
+
+    constexpr char MAGIC[8] = {'E', 'S', 'C', 'A', 'N', 'B', 'I', 'N'};
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t HEADER_SNAPSHOT = 16; // El sniffer guarda a lo más 16 bytes de cabecera
+
+    struct FileHeader {
+        char magic[8];
+        uint16_t version;
+        uint16_t header_size;
+        uint16_t record_size;
+        uint16_t reserved;
+        uint64_t created_ns;        // CLOCK_REALTIME al escribir el archivo
+        uint64_t record_count;
+        uint64_t records_offset;
+        uint64_t services_offset;   // uint32 n, uint32 offsets[n + 1], texto (sin terminador)
+        uint64_t services_size;
+        uint64_t banners_offset;    // Bytes de los banners, los registros apuntan aquí
+        uint64_t banners_size;
+        uint64_t hosts_offset;      // HostIndex[host_count], ordenado por ipv4
+        uint64_t host_count;
+        uint64_t ports_offset;      // uint32[record_count]
+        uint64_t reserved2[4];
+    };
+    static_assert(sizeof(FileHeader) == 128);
+
+    struct Record {
+        uint32_t ipv4;              // En orden de host, así ordenar los números ordena las IPs
+        uint16_t port;
+        uint8_t protocol;           // Protocol
+        uint8_t status;             // PortStatus
+        uint16_t service_id;        // Índice en la tabla de servicios
+        uint8_t header_len;
+        uint8_t flags;
+        uint32_t banner_offset;
+        uint32_t banner_len;
+        uint32_t reserved;
+        uint64_t rtt_ns;            // 0 = sin medir
+        uint8_t header[HEADER_SNAPSHOT];
+    };
+    static_assert(sizeof(Record) == 48);
+
+    struct HostIndex {
+        uint32_t ipv4;
+        uint32_t reserved;
+        uint64_t first;
+        uint64_t count;
+    };
+    static_assert(sizeof(HostIndex) == 24);
+
+    // Escribe los resultados no cerrados de config.target_ip en config.binary_file (vía .tmp + rename)
+    bool write(const AppConfig& config, const std::vector<ScanResult>& results);
+
+    // Un archivo abierto con mmap de solo lectura. Todos los offsets se validan al abrir, después los
+    // accesos son directos sobre el mapeo
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Regresa false con el motivo en error si el archivo no es válido
+        bool open(const std::string& path, std::string& error);
+
+        const FileHeader& header() const { return *reinterpret_cast<const FileHeader*>(base); }
+        uint64_t size() const { return header().record_count; }
+        const Record& record(uint64_t i) const {
+            return *reinterpret_cast<const Record*>(base + header().records_offset + i * header().record_size);
+        }
+        // Que service_id, header_len y el banner apunten dentro del archivo; antes de usar service()/banner()
+        bool valid(const Record& record) const;
+        std::string_view service(uint16_t id) const;
+        std::string_view banner(const Record& record) const;
+
+        // Rango [first, first + count) de los registros de un host, count = 0 si no está
+        bool host_range(uint32_t ipv4, uint64_t& first, uint64_t& count) const;
+        // Número de registro en la posición i del índice por puerto (>= size() si el índice está roto)
+        uint64_t by_port(uint64_t i) const { return port_ids[i]; }
+
+    private:
+        const unsigned char* base = nullptr;
+        size_t length = 0;
+        uint32_t service_count = 0;
+        const uint32_t* service_offsets = nullptr;
+        const char* service_text = nullptr;
+        const HostIndex* hosts = nullptr;
+        const uint32_t* port_ids = nullptr;
+    };
+
+    // "10.0.0.1" -> ipv4 en orden de host; false si no es una IPv4
+    bool parse_ipv4(const std::string& text, uint32_t& ipv4);
+    std::string format_ipv4(uint32_t ipv4);
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 enum class Protocol { TCP, UDP };
 
@@ -14,12 +15,33 @@ enum class PortStatus {
     UNKNOWN 
 };
 
+// Esto es "una unidad de trabajo"
+struct ScanTask {
+    int port;
+    Protocol protocol;
+};
+
+// Índice plano de (protocolo, puerto) para tablas de 2 x 65536 entradas
+constexpr size_t TASK_SLOTS = 2 * 65536;
+inline size_t task_slot(Protocol protocol, int port) {
+    return static_cast<size_t>(protocol) * 65536 + static_cast<size_t>(port);
+}
+
 struct ScanResult {
     int port = 0;
     Protocol protocol = Protocol::TCP;
     PortStatus status = PortStatus::UNKNOWN;
     std::string service = "unknown";
     std::vector<unsigned char> header_bytes;
+    std::string banner; // Solo con --banner (motor reactor)
+    uint64_t rtt_ns = 0; // Envío -> captura de la respuesta, 0 = sin medir
 };
 
+// Orden canónico de los resultados: por puerto y luego por protocolo
+// Se usa tanto en consola como en el JSON para que la salida no dependa del orden en que terminen los hilos
+inline bool result_order(const ScanResult& a, const ScanResult& b) {
+    if (a.port != b.port) return a.port < b.port;
+    return static_cast<int>(a.protocol) < static_cast<int>(b.protocol);
+}
+
 #endif
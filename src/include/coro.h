@@ -0,0 +1,219 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <coroutine>
+#include <optional>
+#include <exception>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "event_loop.h"
+
+// Corrutinas de C++20 sobre el EventLoop
+// Un sondeo suspendido solo cuesta su frame (unos cientos de bytes) en lugar del stack de un hilo,
+// y un sondeo de varios pasos (connect, esperar respuesta, banner, reintento) se lee de arriba a abajo
+namespace Coro {
+
+    // Pool de frames por hilo con listas libres por tamaño (múltiplos de 64 bytes)
+    // Los frames de los sondeos son todos del mismo puñado de tamaños, así que después del
+    // arranque el camino caliente nunca toca el heap global
+    class FramePool {
+    public:
+        static void* allocate(size_t size);
+        static void deallocate(void* ptr, size_t size) noexcept;
+    };
+
+    // Base para los promise_type: hace que el frame salga del pool
+    struct PooledFrame {
+        static void* operator new(size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void* ptr, size_t size) noexcept { FramePool::deallocate(ptr, size); }
+    };
+
+    template <typename T>
+    class Task;
+
+    namespace detail {
+        // Al terminar, una Task le regresa el control a quien la estaba esperando (symmetric transfer)
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                auto continuation = h.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        struct PromiseBase : PooledFrame {
+            std::coroutine_handle<> continuation;
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    }
+
+    // Corrutina perezosa: no arranca hasta que alguien le hace co_await
+    template <typename T>
+    class [[nodiscard]] Task {
+    public:
+        struct promise_type : detail::PromiseBase {
+            std::optional<T> value;
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            void return_value(T v) { value = std::move(v); }
+        };
+
+        Task(Task&& other) noexcept : coro(std::exchange(other.coro, {})) {}
+        Task(const Task&) = delete;
+        ~Task() { if (coro) coro.destroy(); }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            coro.promise().continuation = awaiting;
+            return coro;
+        }
+        T await_resume() { return std::move(*coro.promise().value); }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> h) : coro(h) {}
+        std::coroutine_handle<promise_type> coro;
+    };
+
+    template <>
+    class [[nodiscard]] Task<void> {
+    public:
+        struct promise_type : detail::PromiseBase {
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            void return_void() const noexcept {}
+        };
+
+        Task(Task&& other) noexcept : coro(std::exchange(other.coro, {})) {}
+        Task(const Task&) = delete;
+        ~Task() { if (coro) coro.destroy(); }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            coro.promise().continuation = awaiting;
+            return coro;
+        }
+        void await_resume() const noexcept {}
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> h) : coro(h) {}
+        std::coroutine_handle<promise_type> coro;
+    };
+
+    // Corrutina "suelta": arranca de inmediato y se libera sola al terminar
+    struct Detached {
+        struct promise_type : PooledFrame {
+            Detached get_return_object() const noexcept { return {}; }
+            std::suspend_never initial_suspend() const noexcept { return {}; }
+            std::suspend_never final_suspend() const noexcept { return {}; }
+            void return_void() const noexcept {}
+            void unhandled_exception() const noexcept { std::terminate(); }
+        };
+    };
+
+    // Arranca una Task sin que nadie la espere (así se lanza cada sondeo)
+    inline Detached spawn(Task<void> task) {
+        co_await std::move(task);
+    }
+
+    // co_await sleep_for(loop, 1ms)
+    class SleepFor {
+    public:
+        SleepFor(EventLoop& l, EventLoop::Clock::duration d) : loop(l), delay(d) {}
+        bool await_ready() const noexcept { return delay.count() <= 0; }
+        void await_suspend(std::coroutine_handle<> h) {
+            loop.add_timer(EventLoop::Clock::now() + delay, [h] { h.resume(); });
+        }
+        void await_resume() const noexcept {}
+    private:
+        EventLoop& loop;
+        EventLoop::Clock::duration delay;
+    };
+
+    inline SleepFor sleep_for(EventLoop& loop, EventLoop::Clock::duration delay) {
+        return SleepFor(loop, delay);
+    }
+
+    // co_await wait_fd(loop, fd, EPOLLOUT, deadline) -> true si el fd quedó listo, false si venció el deadline
+    class FdWait {
+    public:
+        FdWait(EventLoop& l, int f, uint32_t ev, EventLoop::Clock::time_point d)
+            : loop(l), fd(f), events(ev), deadline(d) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) {
+            bool watched = loop.watch(fd, events, [this, h](uint32_t) {
+                loop.unwatch(fd);
+                loop.cancel_timer(timer);
+                ready = true;
+                h.resume();
+            });
+            if (!watched) return false; // No se pudo vigilar el fd, se sigue sin suspender (y sin ready)
+            timer = loop.add_timer(deadline, [this, h] {
+                loop.unwatch(fd);
+                h.resume();
+            });
+            return true;
+        }
+        bool await_resume() const noexcept { return ready; }
+    private:
+        EventLoop& loop;
+        int fd;
+        uint32_t events;
+        EventLoop::Clock::time_point deadline;
+        EventLoop::TimerId timer = 0;
+        bool ready = false;
+    };
+
+    inline FdWait wait_fd(EventLoop& loop, int fd, uint32_t events, EventLoop::Clock::time_point deadline) {
+        return FdWait(loop, fd, events, deadline);
+    }
+
+    // Evento de un solo disparo con una corrutina esperando (p. ej. "llegó la respuesta en la captura")
+    // set() se puede llamar desde un callback de pcap, la corrutina se reanuda después via post()
+    class OneShotEvent {
+    public:
+        bool is_set() const { return fired; }
+
+        void set(EventLoop& loop) {
+            if (fired) return;
+            fired = true;
+            if (waiter) {
+                loop.cancel_timer(timer);
+                auto h = std::exchange(waiter, {});
+                loop.post([h] { h.resume(); });
+            }
+        }
+
+        // co_await event.wait(loop, deadline) -> true si se disparó, false si venció el deadline
+        class Awaiter {
+        public:
+            Awaiter(OneShotEvent& e, EventLoop& l, EventLoop::Clock::time_point d) : event(e), loop(l), deadline(d) {}
+            bool await_ready() const noexcept { return event.fired; }
+            void await_suspend(std::coroutine_handle<> h) {
+                event.waiter = h;
+                OneShotEvent* ev = &event;
+                event.timer = loop.add_timer(deadline, [ev] {
+                    auto waiting = std::exchange(ev->waiter, {});
+                    if (waiting) waiting.resume();
+                });
+            }
+            bool await_resume() const noexcept { return event.fired; }
+        private:
+            OneShotEvent& event;
+            EventLoop& loop;
+            EventLoop::Clock::time_point deadline;
+        };
+
+        Awaiter wait(EventLoop& loop, EventLoop::Clock::time_point deadline) { return Awaiter(*this, loop, deadline); }
+
+    private:
+        bool fired = false;
+        std::coroutine_handle<> waiter;
+        EventLoop::TimerId timer = 0;
+    };
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef DIFF_H
+#define DIFF_H
+
+#include <string>
+#include <vector>
+#include "common.h"
+#include "args.h"
+#include "shutdown.h"
+
+// Comparación entre dos escaneos: solo lo que cambió (puertos que se abrieron o cerraron, cambios de
+// estado, servicio, cabecera o banner). Las dos entradas se leen en streaming ya ordenadas por
+// (objetivo, puerto, protocolo) y se mezclan como en un merge sort, así el costo es lineal y la memoria
+// no depende del tamaño de los reportes
+// Acepta el reporte JSON (-o), el binario (--binary) y NDJSON; el formato se detecta solo
+namespace Diff {
+
+    // Subcomando "diff": argv completo de main (argv[1] es "diff"). Como diff(1): 0 = sin cambios,
+    // 1 = hubo cambios, 2 = error
+    int run(int argc, char* argv[]);
+
+    // --diff ARCHIVO: compara los resultados del escaneo que acaba de terminar contra un reporte anterior
+    // e imprime los cambios. Si el escaneo se interrumpió solo se compara lo que alcanzó a terminar
+    // (progress). Regresa false si no se pudo leer el anterior
+    bool against(const AppConfig& config, const std::vector<ScanResult>& results, const std::string& previous,
+                 const Shutdown::Progress& progress);
+
+}
+
+#endif
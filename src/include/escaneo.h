@@ -2,6 +2,7 @@
 #define ESCANEO_H
 
 #include <string>
+#include <cstdint>
 #include "common.h"
 
 class Scanner {
@@ -12,7 +13,11 @@ public:
 
     bool sendUDPProbe(int port);
 
+    // Reloj monotónico justo antes del último connect()/sendto(), para el RTT
+    int64_t sent_at() const { return last_sent_ns; }
+
 private:
+    int64_t last_sent_ns = 0;
     std::string target_ip;
     int timeout_ms;
 };
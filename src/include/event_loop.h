@@ -0,0 +1,71 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// Bucle de eventos de un solo hilo sobre epoll
+// Un solo hilo vigila todos los fds (sockets, el fd de pcap) y un montón de timers, en lugar de
+// tener un hilo bloqueado por cada sondeo
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using FdCallback = std::function<void(uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+    using TimerId = uint64_t;
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // events son flags de epoll (EPOLLIN, EPOLLOUT...). El callback se llama en el hilo del loop
+    bool watch(int fd, uint32_t events, FdCallback callback);
+    void unwatch(int fd);
+
+    TimerId add_timer(Clock::time_point when, TimerCallback callback);
+    void cancel_timer(TimerId id);
+
+    // Corre el callback en la siguiente vuelta del loop, fuera de lo que se esté despachando ahora
+    void post(TimerCallback callback) { posted.push_back(std::move(callback)); }
+
+    // Corre hasta que alguien llame a stop() o ya no haya fds ni timers pendientes
+    void run();
+    void stop() { running = false; }
+
+    bool valid() const { return epoll_fd >= 0; }
+
+private:
+    void fire_expired_timers();
+    void run_posted();
+
+    int epoll_fd;
+    bool running = false;
+
+    // Indexado por fd, los fds son enteros chicos así que un vector es más barato que un map
+    // La generación evita que un evento viejo de un fd cerrado le llegue al siguiente socket con el mismo número
+    struct Watcher {
+        FdCallback callback;
+        uint32_t generation = 0;
+    };
+    std::vector<Watcher> watchers;
+    size_t watched_count = 0;
+
+    // Min-heap de (deadline, id). Cancelar solo borra el callback y la entrada del heap se ignora al salir
+    struct TimerEntry {
+        Clock::time_point when;
+        TimerId id;
+        bool operator>(const TimerEntry& other) const { return when > other.when; }
+    };
+    std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timer_heap;
+    std::unordered_map<TimerId, TimerCallback> timer_callbacks;
+    TimerId next_timer_id = 1;
+
+    std::vector<TimerCallback> posted;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include "common.h"
+#include "args.h"
+
+// Journal de checkpoints: archivo de texto solo-append con una línea por resultado terminado y una marca
+// de checkpoint (posición del generador) en cada flush. Los escaneos solo agregan a un buffer en memoria;
+// un hilo aparte lo escribe de corrido y hace fdatasync por lotes (cada segundo o cada 64 KB)
+//
+// Cada línea termina en " *<fnv1a>" así al leer se descarta una línea rota por un corte a medio escribir
+//   J 1 <objetivo> <T,U> <puertos>                     encabezado: qué escaneo es
+//   R <puerto> <T|U> <estado> <header hex|-> <banner hex|-> [rtt ns]
+//   C <posición> <resultados>
+namespace Journal {
+
+    // Empieza un journal nuevo para este escaneo (lo sobreescribe si ya existía)
+    bool open(const std::string& path, const AppConfig& config);
+
+    // --resume: lee el journal, toma de su encabezado los puertos y protocolos, marca en
+    // config.resume_done lo que ya terminó y devuelve esos resultados. Después se sigue escribiendo
+    // en el mismo archivo (se corta una posible última línea a medias)
+    bool resume(const std::string& path, AppConfig& config, std::vector<ScanResult>& results);
+
+    bool active();
+
+    void record(const ScanResult& result);
+    void set_position(size_t position);
+
+    // Último flush + fdatasync, y se detiene el hilo escritor
+    void close();
+
+}
+
+#endif
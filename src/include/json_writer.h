@@ -0,0 +1,62 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Escritor de JSON en streaming sobre un buffer propio, sin armar un DOM
+// Da exactamente el mismo texto que nlohmann::json::dump() con error_handler_t::replace (el UTF-8 mal
+// formado sale como U+FFFD): indent 0 = una línea, indent > 0 = igual
+// que dump(indent) (o std::setw(indent) << json). Las llaves NO se ordenan solas: quien escribe tiene
+// que emitirlas en orden alfabético como hace nlohmann
+// El buffer se reutiliza: después de que crece al tamaño de trabajo no hay más allocs por registro
+class JsonWriter {
+public:
+    explicit JsonWriter(int indent = 0) : indent(indent) {}
+
+    void begin_object() { open_container('{'); }
+    void end_object() { close_container('}'); }
+    void begin_array() { open_container('['); }
+    void end_array() { close_container(']'); }
+
+    void key(std::string_view name);
+
+    void value(std::string_view text);
+    void value(const char* text) { value(std::string_view(text)); }
+    void value(uint64_t number);
+    void value(int64_t number);
+    void value(int number) { value(static_cast<int64_t>(number)); }
+    void value(bool flag);
+
+    // Bytes como texto hex "45 00 00 3c" (lo mismo que bytes_to_hex_string) sin string intermedio
+    void hex_value(const unsigned char* data, size_t size);
+
+    // Fin de línea a nivel 0 (el std::endl del reporte o el separador de NDJSON)
+    void newline() { out.push_back('\n'); }
+
+    std::string& buffer() { return out; }
+    size_t size() const { return out.size(); }
+    void clear() { out.clear(); }
+
+    // Codifica size bytes en dest (3 * size - 1 caracteres); dest tiene que tener espacio
+    static void encode_hex(const unsigned char* data, size_t size, char* dest);
+
+private:
+    static constexpr int MAX_DEPTH = 32;
+
+    void open_container(char bracket);
+    void close_container(char bracket);
+    void before_value();
+    void write_indent(int depth);
+    void write_string(std::string_view text);
+
+    std::string out;
+    int indent;
+    int depth = 0;
+    bool after_key = false;
+    uint32_t counts[MAX_DEPTH] = {};
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef LIVE_OUTPUT_H
+#define LIVE_OUTPUT_H
+
+#include <chrono>
+#include <cstddef>
+#include "common.h"
+#include "args.h"
+
+// Tabla de resultados en consola EN VIVO y en orden (puerto, protocolo) aunque terminen desordenados
+// Cada resultado tiene su número de secuencia en el orden del generador; los que llegan antes de tiempo
+// esperan en una ventana deslizante hasta que se resuelven los anteriores. Para que la ventana no crezca
+// detrás de un sondeo lento (un filtrado, o uno con --retries) los motores no dejan que el generador
+// se adelante más de --max-inflight tareas a la última fila resuelta (room()); de los cerrados, que no
+// se imprimen, solo se guarda que ya terminaron
+namespace LiveOutput {
+
+    void start(const AppConfig& config);
+
+    // Thread-safe. Imprime el resultado y todos los que ya estaban esperando detrás de él
+    void submit(const ScanResult& result);
+
+    // La tarea no va a tener resultado (el envío falló o se abandonó), para que no tape la ventana
+    void skip(const ScanTask& task);
+
+    // Cuántas tareas más puede entregar un generador que va en la posición emitted (TaskGenerator::emitted)
+    // sin quedar más de limit tareas sin resolver en la tabla. Sin tabla (antes de start() o después de
+    // finish()) no hay límite. Sin lock, se puede llamar por sondeo
+    size_t room(size_t emitted, size_t limit);
+    // Lo mismo, pero si no hay lugar espera hasta wait a que salga la del frente (para que quien
+    // llama pueda revisar Shutdown entre esperas)
+    size_t wait_for_room(size_t emitted, size_t limit, std::chrono::milliseconds wait);
+
+    // Imprime lo que quede (saltando huecos de tareas sin resultado)
+    void finish();
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include "common.h"
+#include "args.h"
+
+// Métricas en vivo en formato de texto de Prometheus, por HTTP (--metrics-listen) y/o a un archivo que
+// se reescribe cada segundo (--metrics-file, para el textfile collector de node_exporter)
+// Lo que corre por sondeo son solo sumas atómicas relajadas; lo caro (pcap_stats, /proc/self/fd, armar
+// el texto) lo hace el hilo exportador cuando toca. Sin ninguna de las dos opciones no se arranca nada
+namespace Metrics {
+
+    // Arranca el hilo exportador si la configuración lo pide. false si no se pudo abrir el puerto
+    bool start(const AppConfig& config);
+    // Última escritura del archivo y se cierra el puerto
+    void stop();
+
+    // Sondeos en vuelo: cada motor avisa cuando toma una tarea y cuando la termina (con resultado,
+    // descartada o abandonada)
+    void inflight_add(int64_t n);
+
+    // Lo llama ResultSink::publish con cada resultado
+    void result(const ScanResult& result);
+
+    // Profundidad de las colas del motor, se consulta solo al exportar. El motor la quita (nullptr)
+    // antes de destruir sus colas
+    using QueueDepths = std::function<std::vector<std::pair<std::string, size_t>>()>;
+    void set_queue_depths(QueueDepths depths);
+
+}
+
+#endif
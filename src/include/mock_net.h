@@ -0,0 +1,80 @@
+#ifndef MOCK_NET_H
+#define MOCK_NET_H
+
+#include <array>
+#include <chrono>
+#include "net_io.h"
+#include "spsc_ring.h"
+
+// Red en memoria para el motor pipeline (PipelineNet): cada sondeo se contesta en el momento con la trama
+// que mandaría el objetivo según un modelo, sin sockets, sin root y sin captura. Sirve para medir el
+// generador, la tabla de flujos del clasificador y el camino de salida a millones de sondeos por segundo
+//
+// El modelo sale de un hash de (semilla, protocolo, puerto), así que el resultado es siempre el mismo, y
+// el RTT es fijo (captured_ns = envío + rtt_ns). Los filtrados no contestan, así que esos sí esperan
+// el --timeout de verdad
+class MockNet {
+public:
+    struct Model {
+        double open = 0.05;     // Fracción de puertos abiertos
+        double filtered = 0;    // Fracción sin respuesta (el resto, cerrados)
+        uint64_t seed = 1;
+        int64_t rtt_ns = 100000;
+    };
+
+    MockNet(const AppConfig& config, const Model& model);
+
+    // Lo que el modelo dice de ese puerto, como lo reportaría el escáner
+    PortStatus expected(Protocol protocol, int port) const;
+
+    bool open(size_t max_open);
+    uint32_t target_addr() const { return target; }
+    int link_layer_offset() const { return 0; } // Las tramas son IP pelón (DLT_RAW)
+    int udp_local_port() const { return UDP_LOCAL_PORT; }
+
+    bool tcp_connect(int port, int64_t& sent_ns, int& local_port, PortStatus& fallback);
+    bool udp_send(int port, int64_t& sent_ns);
+    bool tcp_connect_waits() const { return false; }
+    void expire() {}
+    void drain() {}
+
+    bool wait_readable(int timeout_ms);
+
+    template <typename OnPacket>
+    int dispatch(int max, OnPacket& on_packet) {
+        Frame frame;
+        int count = 0;
+        while (count < max && frames.try_pop(frame)) {
+            on_packet(frame.data.data(), frame.len, frame.len, frame.captured_ns);
+            ++count;
+        }
+        return count;
+    }
+
+    void sample(uint64_t) {}
+
+private:
+    // Fuera del rango de los efímeros, así una respuesta UDP nunca cae en un flujo TCP
+    static constexpr int UDP_LOCAL_PORT = 61000;
+
+    // IP + ICMP + IP/UDP originales es lo más grande que se manda
+    struct Frame {
+        uint32_t len = 0;
+        int64_t captured_ns = 0;
+        std::array<u_char, 64> data{};
+    };
+
+    enum class State { OPEN, CLOSED, FILTERED };
+    State state(Protocol protocol, int port) const;
+    void reply(Frame& frame);
+
+    Model model;
+    uint32_t target = 0;     // Orden de red
+    uint32_t local = 0;      // Orden de red, la dirección "nuestra"
+    int next_local_port = 0; // Puertos efímeros de los connect() simulados
+    SpscRing<Frame> frames;  // Transmisor -> receptor
+};
+
+static_assert(PipelineNet<MockNet>);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef NDJSON_H
+#define NDJSON_H
+
+#include <string>
+
+// Salida NDJSON en streaming: un objeto JSON por línea en cuanto el estado de un puerto es final
+// Quien produce resultados solo copia la línea a un buffer; un hilo escritor aparte lo vacía con
+// write() grandes (cada 100 ms o cada 1 MB), así el escaneo no espera al disco o al pipe. Si el que lee
+// va más lento que el escaneo, con 4 MB pendientes los productores esperan al escritor: la memoria no
+// crece con cada resultado
+namespace NDJSON {
+
+    // path "-" = stdout
+    bool open(const std::string& path);
+    bool active();
+    bool to_stdout();
+
+    void write_line(const std::string& line);
+
+    // Vacía lo pendiente y detiene el hilo escritor
+    void close();
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef NET_IO_H
+#define NET_IO_H
+
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <pcap.h>
+#include <netinet/in.h>
+#include "common.h"
+#include "args.h"
+#include "sniffer.h"
+#include "timing.h"
+#include "usdt.h"
+
+// Lo que el motor pipeline necesita de la red: mandar sondeos y recibir las respuestas. El motor es una
+// plantilla sobre esto (sin virtuales, todo se resuelve al compilar), así que con SocketNet queda igual
+// que llamar a los sockets y a pcap directo, y con MockNet (mock_net.h) corre entero en memoria
+//
+// dispatch llama on_packet(datos, caplen, len, captured_ns) con cada paquete, donde captured_ns es la
+// hora de captura en reloj monotónico (Timing::capture_ns)
+using NetPacketCallback = void (*)(const u_char* data, uint32_t caplen, uint32_t len, int64_t captured_ns);
+
+template <typename Net>
+concept PipelineNet = requires(Net& net, size_t max_open, int port, int64_t& sent_ns, int& local_port,
+                               PortStatus& fallback, NetPacketCallback& on_packet, uint64_t ignored) {
+    { net.open(max_open) } -> std::same_as<bool>;
+    { net.target_addr() } -> std::same_as<uint32_t>;          // En orden de red, para Sniffer::response_key
+    { net.link_layer_offset() } -> std::same_as<int>;
+    { net.udp_local_port() } -> std::same_as<int>;            // Todos los sondeos UDP salen de este puerto
+    // false = no hubo socket. fallback es lo que se reporta si no se captura nada
+    { net.tcp_connect(port, sent_ns, local_port, fallback) } -> std::same_as<bool>;
+    { net.udp_send(port, sent_ns) } -> std::same_as<bool>;    // false = error definitivo
+    { net.tcp_connect_waits() } -> std::same_as<bool>;        // El próximo tcp_connect va a dormir
+    net.expire();                                             // El transmisor está ocioso
+    net.drain();                                              // Ya no hay más envíos
+    { net.wait_readable(10) } -> std::same_as<bool>;
+    { net.dispatch(64, on_packet) } -> std::same_as<int>;
+    net.sample(ignored);                                      // Contadores de la captura a ScanStats
+};
+
+// La red de verdad: connect() no bloqueantes, un socket UDP y UNA captura pcap de todo lo del objetivo
+// Los sockets TCP se quedan abiertos hasta su timeout (el kernel termina el handshake) y se cierran en orden
+class SocketNet {
+public:
+    explicit SocketNet(const AppConfig& config) : config(config), sampler(config.interface) {}
+    ~SocketNet();
+
+    // max_open: tope de sockets TCP abiertos a la vez (la ventana de sondeos en vuelo)
+    bool open(size_t max_open);
+
+    uint32_t target_addr() const { return target.sin_addr.s_addr; }
+    int link_layer_offset() const { return link_offset; }
+    int udp_local_port() const { return udp_port; }
+
+    bool tcp_connect(int port, int64_t& sent_ns, int& local_port, PortStatus& fallback);
+    bool udp_send(int port, int64_t& sent_ns);
+    // Con el tope de sockets lleno tcp_connect espera a que venza el más viejo
+    bool tcp_connect_waits() const { return open_fds.size() >= max_open_sockets; }
+    void expire();
+    void drain();
+
+    bool wait_readable(int timeout_ms);
+
+    template <typename OnPacket>
+    int dispatch(int max, OnPacket& on_packet) {
+        struct Context {
+            OnPacket* callback;
+            bool nano;
+        } context{&on_packet, nano_timestamps};
+        return pcap_dispatch(handle, max, [](u_char* user, const pcap_pkthdr* pkthdr, const u_char* packet) {
+            auto* ctx = reinterpret_cast<Context*>(user);
+            Usdt::packet_received(-1, pkthdr->caplen, Timing::pcap_ns(pkthdr->ts, ctx->nano));
+            (*ctx->callback)(packet, pkthdr->caplen, pkthdr->len, Timing::capture_ns(pkthdr->ts, ctx->nano));
+        }, reinterpret_cast<u_char*>(&context));
+    }
+
+    void sample(uint64_t ignored) { sampler.sample(handle, ignored); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void close_expired(Clock::time_point now);
+
+    const AppConfig& config;
+    sockaddr_in target{};
+    int udp_fd = -1;
+    int udp_port = -1;
+    bool is_local_target = false;
+    pcap_t* handle = nullptr;
+    int link_offset = 14;
+    bool nano_timestamps = false;
+    CaptureSampler sampler;
+
+    size_t max_open_sockets = 0;
+    std::deque<std::pair<int, Clock::time_point>> open_fds; // En orden de cierre
+};
+
+static_assert(PipelineNet<SocketNet>);
+
+#endif
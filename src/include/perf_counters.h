@@ -0,0 +1,51 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+
+// Contadores de hardware por fase del motor (--perf-counters) con perf_event_open: ciclos,
+// instrucciones, fallos de caché, fallos de predicción de saltos y cambios de contexto. Sirven para
+// saber si una regresión viene de estructuras poco amigables con la caché o de syscalls y cambios de
+// contexto, sin un profiler aparte
+//
+// Cada hilo abre su propio grupo de contadores la primera vez que entra a una fase y lo lee al entrar
+// y al salir (un read() por lado). Las fases se pueden anidar (la clasificación dentro de la recepción
+// en el reactor) y cada una se queda solo con lo suyo. Al terminar el hilo el grupo se cierra y sus
+// totales pasan al global. No es gratis: son dos syscalls por tramo medido, solo para diagnóstico
+namespace PerfCounters {
+
+    enum class Phase {
+        SEND,     // socket() + connect()/sendto()
+        RECEIVE,  // Sacar paquetes de la captura y leer sus headers (reactor y pipeline)
+        CLASSIFY, // classify_packet y emparejar la respuesta con su sondeo
+        OUTPUT,   // ResultSink::publish
+        COUNT
+    };
+
+    // Prueba abrir los contadores en este hilo y avisa cuáles no hay (en una VM suele no haber de
+    // hardware). false si no se pudo abrir ninguno
+    bool enable();
+    bool enabled();
+
+    void enter(Phase phase);
+    void leave();
+
+    // Mide su propio alcance. No puede abarcar un co_await: el reactor corre otras corrutinas en el
+    // mismo hilo mientras esta está suspendida
+    class Scope {
+    public:
+        explicit Scope(Phase phase) : active(enabled()) { if (active) enter(phase); }
+        ~Scope() { if (active) leave(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool active;
+    };
+
+    // La tabla por sondeo (totales / sondeos enviados). Con los hilos del escaneo ya terminados
+    void print(uint64_t probes_sent);
+
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef PHASES_H
+#define PHASES_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "timing.h"
+
+// Histogramas de latencia por fase del sondeo (--phases). Cada hilo escribe en los suyos sin locks ni
+// atómicos y se juntan al final, cuando ya no hay hilos escaneando. Son tipo HDR: cubetas lineales
+// hasta 64 ns y de ahí 32 por cada potencia de 2, así el error de cualquier percentil es de ~3%
+// Sin --phases record() regresa de inmediato y now() da 0, ni siquiera se lee el reloj
+namespace Phases {
+
+    enum class Phase {
+        CAPTURE_OPEN,  // Sniffer::start hasta tener el filtro puesto (motor de hilos)
+        PRE_PROBE,     // La pausa de 50/100 ms antes de mandar, para que el sniffer alcance a arrancar
+        CONNECT,       // connect() hasta que el socket se vuelve writeable o vence el timeout
+        SEND,          // sendto() del sondeo UDP
+        WAIT_RESPONSE, // Esperando el resultado de la captura
+        CAPTURE_CLOSE, // Parar el sniffer y esperar a que su hilo termine
+        PROBE,         // El sondeo completo, de principio a resultado
+        RTT,           // Envío -> respuesta capturada (lo mismo que rtt_ns)
+        OUTPUT,        // ResultSink::publish: journal, NDJSON y tabla en vivo
+        REPORT,        // Escribir los reportes al final (JSON, binario, diff)
+        COUNT
+    };
+
+    struct Percentiles {
+        Phase phase = Phase::PROBE;
+        const char* name = ""; // El de JSON
+        uint64_t count = 0;
+        uint64_t min_ns = 0;
+        uint64_t mean_ns = 0;
+        uint64_t p50_ns = 0;
+        uint64_t p90_ns = 0;
+        uint64_t p99_ns = 0;
+        uint64_t p999_ns = 0;
+        uint64_t max_ns = 0;
+    };
+
+    void enable();
+    bool enabled();
+
+    void record(Phase phase, uint64_t ns);
+
+    // Marca de inicio para record_since (0 si está apagado)
+    inline int64_t now() { return enabled() ? Timing::monotonic_ns() : 0; }
+
+    inline void record_since(Phase phase, int64_t start_ns) {
+        if (start_ns > 0) record(phase, static_cast<uint64_t>(Timing::monotonic_ns() - start_ns));
+    }
+
+    // Mide su propio alcance
+    class Timer {
+    public:
+        explicit Timer(Phase phase) : phase(phase), start_ns(now()) {}
+        ~Timer() { record_since(phase, start_ns); }
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        Phase phase;
+        int64_t start_ns;
+    };
+
+    // Solo las fases con muestras, en el orden del enum
+    std::vector<Percentiles> summary();
+    void print(const std::vector<Percentiles>& phases);
+    bool write_json(const std::string& path, const std::vector<Percentiles>& phases);
+
+}
+
+#endif
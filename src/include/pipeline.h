@@ -0,0 +1,27 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <vector>
+#include "common.h"
+#include "args.h"
+
+#ifdef ESCANER_MOCK_NET
+class MockNet;
+#endif
+
+namespace Pipeline {
+
+    // Motor por etapas: generador -> transmisor -> receptor -> clasificador -> sumidero
+    // Cada etapa corre en su propio hilo y pasa lotes a la siguiente por colas SPSC acotadas, así cada
+    // núcleo hace un bucle apretado sobre un solo tipo de trabajo y cada etapa se puede medir por separado
+    std::vector<ScanResult> run(const AppConfig& config);
+
+#ifdef ESCANER_MOCK_NET
+    // Lo mismo contra la red en memoria de mock_net.h, para medir el motor sin kernel ni root. Solo en
+    // los binarios de bench (-DESCANER_MOCK_NET y src/mock_net.cpp), el escáner no lo lleva
+    std::vector<ScanResult> run(const AppConfig& config, MockNet& net);
+#endif
+
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+// Subcomando "query": filtra, convierte a JSON y resume reportes binarios (--binary) leyéndolos con
+// mmap, sin cargarlos a memoria. Con --host o -p usa los índices del archivo en lugar de recorrerlo
+namespace Query {
+
+    // argv completo de main (argv[1] es "query"); regresa el código de salida
+    int run(int argc, char* argv[]);
+
+}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <vector>
+#include "common.h"
+#include "args.h"
+
+namespace Reactor {
+
+    // Motor asíncrono: UN hilo con epoll lleva todos los sondeos en vuelo (connect no bloqueantes,
+    // sendto UDP, el fd de una sola captura pcap y los timeouts) en lugar de dos hilos por sondeo
+    std::vector<ScanResult> run(const AppConfig& config);
+
+}
+
+#endif
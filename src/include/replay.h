@@ -0,0 +1,16 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <vector>
+#include "common.h"
+#include "args.h"
+
+namespace Replay {
+
+    // Pasa una captura grabada (pcap/pcapng) por el mismo decode y clasificación que el sniffer
+    // en vivo, sin root ni interfaz. Regresa un resultado por cada puerto/protocolo configurado
+    std::vector<ScanResult> run(const AppConfig& config);
+
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef RESULT_SINK_H
+#define RESULT_SINK_H
+
+#include "common.h"
+#include "args.h"
+
+// Punto único por donde pasa cada resultado final de cualquier motor: journal de checkpoints,
+// NDJSON en streaming y la tabla en vivo de la consola. Se puede llamar desde varios hilos a la vez
+namespace ResultSink {
+
+    void configure(const AppConfig& config);
+
+    // Retorna true si además hay que guardar el resultado en memoria, solo hace falta para los reportes
+    // -o y --binary y para --diff. Sin ellos el escaneo no acumula resultados
+    // journal=false para resultados que ya vienen de un journal (--resume) o del replay
+    bool publish(const ScanResult& result, bool journal = true);
+
+    // La tarea no va a tener resultado (el envío falló o se abandonó)
+    void discard(const ScanTask& task);
+
+    bool retain();
+
+}
+
+#endif
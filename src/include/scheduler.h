@@ -0,0 +1,84 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include "common.h"
+#include "args.h"
+
+// Genera las tareas sobre la marcha, nunca arma la lista completa
+// El orden es puerto x protocolo (80/TCP, 80/UDP, 81/TCP...), el mismo de result_order, así la salida
+// en vivo puede ir en orden sin esperar a que termine todo un protocolo
+// No es thread-safe: lo usa un solo hilo o quien lo use lo protege con su propio lock
+class TaskGenerator {
+public:
+    TaskGenerator(const std::vector<int>& ports, const std::vector<Protocol>& protocols);
+    // Con --resume se salta lo que el journal ya tiene terminado (config.resume_done)
+    explicit TaskGenerator(const AppConfig& config);
+
+    bool next(ScanTask& task);
+    // Agrega hasta max tareas al final de out, retorna cuántas agregó
+    size_t next_batch(std::vector<ScanTask>& out, size_t max);
+
+    size_t total() const { return ports.size() * protocols.size(); }
+    // Posición en el orden puerto x protocolo (cuenta también las tareas saltadas)
+    size_t emitted() const { return emitted_count; }
+    bool exhausted() const { return emitted_count >= total(); }
+
+private:
+    const std::vector<int>& ports;
+    const std::vector<Protocol>& protocols;
+    const std::vector<bool>* done = nullptr;
+    size_t port_index = 0;
+    size_t protocol_index = 0;
+    size_t emitted_count = 0;
+};
+
+// Scheduler con un deque por worker y robo de trabajo (work stealing)
+// Cada hilo saca lotes de SU deque, así que su mutex casi nunca tiene competencia. Cuando se le
+// acaba el trabajo le roba la mitad del deque a otro worker en lugar de pelearse por una cola global
+class WorkStealingScheduler {
+public:
+    WorkStealingScheduler(size_t num_workers, size_t batch_size = 8);
+
+    // Los deques se rellenan de a poco desde el generador: el worker que se queda sin nada saca unos
+    // lotes a su deque (el generador es lo único que pasa por un lock común). En memoria solo hay unos
+    // lotes por worker sin importar el tamaño del escaneo. Con max_ahead > 0 el generador no se adelanta
+    // más que eso a la tabla en vivo (LiveOutput::room); sin lugar se roba o se espera
+    void attach(TaskGenerator& source, size_t max_ahead = 0);
+
+    // Llena "batch" con el siguiente lote para este worker: de su deque, si no del generador y si no robando
+    // Retorna false cuando ya no queda trabajo en ningún lado
+    bool claim(size_t worker_id, std::vector<ScanTask>& batch);
+
+    // Saca lo que haya quedado en los deques (escaneo interrumpido), sin tocar el generador
+    void drain(std::vector<ScanTask>& leftover);
+
+    size_t workers() const { return queues.size(); }
+
+private:
+    // alignas para que los mutex de workers vecinos no compartan línea de caché (false sharing)
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<ScanTask> tasks;
+    };
+
+    // Lotes que se sacan del generador por cada vez que se toma source_mutex
+    static constexpr size_t REFILL_BATCHES = 4;
+
+    bool steal(size_t thief_id, std::vector<ScanTask>& batch);
+    bool refill(size_t worker_id, std::vector<ScanTask>& batch);
+    bool wait_for_room();
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    size_t batch_size;
+
+    std::mutex source_mutex;
+    TaskGenerator* source = nullptr;
+    size_t max_ahead = 0;
+    std::vector<ScanTask> refill_buffer; // Protegido por source_mutex
+};
+
+#endif
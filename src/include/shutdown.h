@@ -0,0 +1,42 @@
+#ifndef SHUTDOWN_H
+#define SHUTDOWN_H
+
+#include <vector>
+#include <chrono>
+#include <cstddef>
+#include "common.h"
+
+// Interrupción ordenada con SIGINT/SIGTERM
+// La primera señal deja de lanzar sondeos y abre un periodo de gracia para que terminen los que
+// están en vuelo; lo que no termine a tiempo se anota como pendiente. Una segunda señal sale al instante
+namespace Shutdown {
+
+    using Clock = std::chrono::steady_clock;
+
+    void install(std::chrono::milliseconds grace);
+
+    // Ya llegó la señal: no se lanzan sondeos nuevos
+    bool requested();
+    // Fin del periodo de gracia (Clock::time_point::max() mientras no haya señal)
+    Clock::time_point deadline();
+    // Ya pasó la gracia: lo que siga en vuelo se abandona
+    bool expired();
+    // Lo que se puede esperar desde ahora sin pasarse de la gracia
+    std::chrono::milliseconds clamp_wait(std::chrono::milliseconds wait);
+
+    // Los motores reportan hasta dónde llegó el generador y qué tareas quedaron sin resultado
+    void set_position(size_t generated, size_t total);
+    void abandoned(const ScanTask& task);
+    void abandoned(const std::vector<ScanTask>& tasks);
+
+    struct Progress {
+        bool interrupted = false;
+        size_t position = 0;           // Tareas que entregó el generador (orden puerto x protocolo)
+        size_t total = 0;
+        std::vector<ScanTask> incomplete; // Entregadas pero sin resultado, hay que repetirlas
+    };
+    Progress progress();
+
+}
+
+#endif
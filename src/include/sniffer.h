@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <pcap.h>
 #include <future>
 #include "common.h"
@@ -11,6 +12,16 @@ struct SnifferResult {
     bool packet_found = false;
     PortStatus status = PortStatus::UNKNOWN;
     std::vector<unsigned char> header_bytes;
+    int64_t capture_ns = 0; // Hora de captura de la respuesta en reloj monotónico (Timing::capture_ns)
+};
+
+// A qué flujo (protocolo/puerto escaneado) puede pertenecer una respuesta del objetivo
+// -1 significa que no aplica para ese protocolo
+struct ResponseKey {
+    int tcp_port = -1;
+    int udp_port = -1;
+    // Puerto local nuestro al que iba dirigida la respuesta (en ICMP, el origen del sondeo original)
+    int local_port = -1;
 };
 
 class Sniffer {
@@ -20,10 +31,29 @@ public:
     
     void start(Protocol protocol, std::promise<SnifferResult> result_promise);
     void stop();
+
+    // Decodifica y clasifica un paquete sin depender de pcap (lo comparten el sniffer y el replay)
+    static bool classify_packet(const u_char* packet, uint32_t caplen, uint32_t len,
+                                int link_layer_offset, int target_port, SnifferResult& result);
+    static int link_layer_offset(int link_type);
+
+    // Hace a mano lo que hacen los filtros BPF por puerto, para los modos que usan UNA sola captura
+    // para todos los puertos (replay, reactor). target_addr va en orden de red
+    static bool response_key(const u_char* packet, uint32_t caplen, int link_layer_offset,
+                             uint32_t target_addr, ResponseKey& key);
+
+    // UNA captura no bloqueante, en modo inmediato, con todo lo que venga del objetivo (TCP, UDP e ICMP
+    // port unreachable). La usan los motores que reparten las respuestas en user space
+    static pcap_t* open_host_capture(const std::string& interface, const std::string& target_ip);
+
+    // Si el handle da los timestamps en nanosegundos (se pide al abrir, no todas las plataformas pueden)
+    static bool nano_timestamps(pcap_t* handle);
     
     std::string interface;
     std::string target_ip;
     int target_port;
+    // Lo que tardó start() en tener la captura lista (0 si no se pudo). Se lee después del join
+    uint64_t open_ns = 0;
 
 private:
     static void packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr, const u_char* packet);
@@ -31,4 +61,17 @@ private:
     pcap_t* handle;
 };
 
+// Para las capturas que duran todo el escaneo: manda a ScanStats solo lo nuevo desde la última
+// muestra de pcap_stats, así el freno por pérdida reacciona a media captura
+class CaptureSampler {
+public:
+    explicit CaptureSampler(const std::string& interface) : interface(interface) {}
+    void sample(pcap_t* handle, uint64_t ignored_total);
+
+private:
+    std::string interface;
+    pcap_stat last_stats{};
+    uint64_t last_ignored = 0;
+};
+
 #endif
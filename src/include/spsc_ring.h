@@ -0,0 +1,85 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+
+// Cola circular acotada de UN productor y UN consumidor, sin locks
+// Cada índice lo escribe un solo hilo, así que basta con acquire/release. Los índices van en líneas de
+// caché separadas y cada lado guarda una copia del índice del otro para no leer la línea compartida
+// en cada push/pop
+template <typename T>
+class SpscRing {
+public:
+    // capacity se redondea a potencia de 2 para usar máscara en lugar de módulo
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    bool try_push(T&& item) {
+        size_t tail = tail_index.load(std::memory_order_relaxed);
+        if (tail - cached_head > mask) {
+            cached_head = head_index.load(std::memory_order_acquire);
+            if (tail - cached_head > mask) return false; // Llena
+        }
+        slots[tail & mask] = std::move(item);
+        tail_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& item) {
+        size_t head = head_index.load(std::memory_order_relaxed);
+        if (head == cached_tail) {
+            cached_tail = tail_index.load(std::memory_order_acquire);
+            if (head == cached_tail) return false; // Vacía
+        }
+        item = std::move(slots[head & mask]);
+        head_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Bloquea (con backoff) hasta que haya lugar
+    void push(T&& item) {
+        unsigned spins = 0;
+        while (!try_push(std::move(item))) backoff(spins);
+    }
+
+    bool empty() const {
+        return head_index.load(std::memory_order_acquire) == tail_index.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return tail_index.load(std::memory_order_acquire) - head_index.load(std::memory_order_acquire);
+    }
+
+    // Espera escalonada para los hilos de las etapas: primero gira, luego cede el CPU y al final duerme
+    static void backoff(unsigned& spins) {
+        if (spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        } else if (spins < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        ++spins;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+
+    alignas(64) std::atomic<size_t> head_index{0}; // Lo avanza el consumidor
+    alignas(64) size_t cached_tail = 0;            // Copia del consumidor
+    alignas(64) std::atomic<size_t> tail_index{0}; // Lo avanza el productor
+    alignas(64) size_t cached_head = 0;            // Copia del productor
+};
+
+#endif
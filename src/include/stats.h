@@ -0,0 +1,56 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+namespace ScanStats {
+
+    // Contadores de una interfaz, sumados sobre todos los handles de pcap que se abrieron en ella
+    struct InterfaceCounters {
+        std::string interface;
+        uint64_t received = 0;          // ps_recv: paquetes que pasaron el filtro BPF
+        uint64_t kernel_dropped = 0;    // ps_drop: el buffer de captura se llenó
+        uint64_t interface_dropped = 0; // ps_ifdrop: los tiró la interfaz/driver
+        uint64_t ignored = 0;           // llegaron al handler pero no eran para el puerto (o ya había respuesta)
+    };
+
+    // RTT de los sondeos con respuesta contra el objetivo, en ns
+    struct RttSummary {
+        uint64_t samples = 0;
+        uint64_t min_ns = 0;
+        uint64_t median_ns = 0;
+        uint64_t p99_ns = 0;
+    };
+
+    struct Summary {
+        std::vector<InterfaceCounters> interfaces;
+        InterfaceCounters total;
+        uint64_t probes_sent = 0;
+        uint64_t probes_answered = 0;
+        RttSummary rtt;
+    };
+
+    // Lo llama el sniffer al cerrar cada captura con lo que reportó pcap_stats
+    void record_capture(const InterfaceCounters& counters);
+
+    void probe_sent();
+    void probe_answered();
+
+    // Un RTT medido (ScanResult::rtt_ns > 0). Se guardan todos para sacar mediana y p99 exactos
+    void record_rtt(uint64_t rtt_ns);
+
+    // Pausa que el scheduler mete antes de cada sondeo. Crece cuando hay pérdida en la captura
+    // y se va reduciendo sola cuando las capturas vuelven a estar limpias
+    std::chrono::microseconds pacing_delay();
+
+    Summary summary();
+    // Lo mismo sin el RTT (que copia todas las muestras), para consultarlo a media corrida
+    Summary counters();
+    void print_summary(const Summary& summary);
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <cstdint>
+#include <ctime>
+#include <sys/time.h>
+
+// Tiempos para el RTT de cada sondeo. El envío se marca con CLOCK_MONOTONIC; pcap en cambio da la hora
+// de captura en CLOCK_REALTIME (en µs, o en ns si el handle se abrió con precisión de nanosegundos),
+// así que se pasa al reloj monotónico con el desfase entre ambos medido en ese momento
+namespace Timing {
+
+    inline int64_t monotonic_ns() {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    }
+
+    // La marca de pcap tal cual (CLOCK_REALTIME) en ns. ts.tv_usec trae nanosegundos cuando
+    // nano = true (PCAP_TSTAMP_PRECISION_NANO)
+    inline int64_t pcap_ns(const timeval& ts, bool nano) {
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + static_cast<int64_t>(ts.tv_usec) * (nano ? 1 : 1000);
+    }
+
+    inline int64_t capture_ns(const timeval& ts, bool nano) {
+        timespec real{}, mono{};
+        clock_gettime(CLOCK_REALTIME, &real);
+        clock_gettime(CLOCK_MONOTONIC, &mono);
+        int64_t offset = (static_cast<int64_t>(real.tv_sec) - mono.tv_sec) * 1000000000 + (real.tv_nsec - mono.tv_nsec);
+        return pcap_ns(ts, nano) - offset;
+    }
+
+    // 0 = sin medir (no hubo respuesta, o un ajuste del reloj la dejó antes del envío)
+    inline uint64_t rtt_ns(int64_t sent_ns, int64_t captured_ns) {
+        if (sent_ns <= 0 || captured_ns <= sent_ns) return 0;
+        return static_cast<uint64_t>(captured_ns - sent_ns);
+    }
+
+}
+
+#endif
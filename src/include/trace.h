@@ -0,0 +1,47 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <cstdint>
+#include "common.h"
+
+// Línea de tiempo de los sondeos (--trace ARCHIVO) en formato Chrome trace-event, se abre en Perfetto
+// (ui.perfetto.dev) o en chrome://tracing. Cada sondeo muestreado es un tramo async de "tomado" a
+// "guardado" con eventos instantáneos en medio, cada uno en el hilo que lo vio
+//
+// Cada hilo escribe en su propio buffer sin locks; se juntan y se escriben al final. Con
+// --trace-sample N solo se siguen los sondeos cuyo hash de (protocolo, puerto) cae en 1 de cada N,
+// así que un sondeo muestreado tiene TODOS sus eventos y el resto no cuesta más que una comparación
+namespace Trace {
+
+    enum class Event : uint8_t {
+        DEQUEUED,      // El motor tomó la tarea (abre el tramo del sondeo)
+        SOCKET,        // socket() del sondeo
+        SENT,          // connect()/sendto()
+        CAPTURE_ARMED, // El sniffer ya tiene el filtro puesto (motor de hilos)
+        MATCHED,       // Llegó la respuesta y se emparejó con el sondeo
+        TIMEOUT,       // Venció el timeout sin respuesta
+        STORED,        // ResultSink publicó el resultado (cierra el tramo)
+        DISCARDED,     // Sin resultado: falló el envío o quedó pendiente (cierra el tramo)
+    };
+
+    // sample: 1 = todos los sondeos
+    void enable(uint32_t sample);
+    bool enabled();
+
+    // Nombre del hilo en la línea de tiempo ("worker 3", "pipeline: receptor"...)
+    void name_thread(const std::string& name);
+
+    // Si el sondeo entra en la muestra (y el trace está prendido)
+    bool traced(Protocol protocol, int port);
+
+    void event(Event event, Protocol protocol, int port);
+    // Con una marca que ya se tomó (Timing::monotonic_ns), así no se lee el reloj otra vez
+    void event_at(Event event, Protocol protocol, int port, int64_t ts_ns);
+
+    // Escribe todo lo juntado. false si no se pudo escribir
+    bool write(const std::string& path);
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef USDT_H
+#define USDT_H
+
+#include <cstdint>
+#include "common.h"
+
+// Tracepoints estáticos USDT (SystemTap SDT) del proveedor "escaner", para colgarse de un escaneo que
+// ya está corriendo con bpftrace o perf sin recompilar:
+//
+//   sudo bpftrace -e 'usdt:./escaner:escaner:probe_sent { @s[arg0, arg1] = arg2 }
+//                     usdt:./escaner:escaner:classified { @rtt = hist(arg3 - @s[arg0, arg1]) }'
+//   sudo perf probe -x ./escaner sdt_escaner:probe_sent && sudo perf record -e sdt_escaner:probe_sent ...
+//
+// Apagado, cada punto es un nop y una nota en .note.stapsdt: los argumentos son valores que el código
+// ya tenía a mano, no se lee ningún reloj para ellos. Si no hay <sys/sdt.h> (paquete systemtap-sdt-dev
+// o systemtap-sdt-devel) todo queda vacío y el binario es el de siempre
+//
+// Argumentos comunes: port, protocol (6 = TCP, 17 = UDP, los números del header IP) y status
+// (el valor de PortStatus: 0 abierto, 1 cerrado, 2 filtrado, 3 abierto|filtrado, 4 desconocido)
+// Los *_ns son de CLOCK_MONOTONIC (Timing::monotonic_ns, el mismo reloj que nsecs de bpftrace),
+// salvo el de packet_received que es la marca de pcap sin convertir (CLOCK_REALTIME)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ESCANER_USDT 1
+#else
+#define ESCANER_USDT 0
+#endif
+
+namespace Usdt {
+
+    inline int protocol_number(Protocol protocol) {
+        return protocol == Protocol::TCP ? 6 : 17;
+    }
+
+    // Tienen que quedar inline: la nota del probe apunta a la dirección del nop, y así cada llamada
+    // es su propio punto (bpftrace se cuelga de todos los que tengan el mismo nombre)
+
+    // connect()/sendto() del sondeo. sent_ns es la marca del envío que se usa para el RTT
+    [[gnu::always_inline]] inline void probe_sent(int port, Protocol protocol, int64_t sent_ns) {
+#if ESCANER_USDT
+        DTRACE_PROBE3(escaner, probe_sent, port, protocol_number(protocol), sent_ns);
+#else
+        (void)port; (void)protocol; (void)sent_ns;
+#endif
+    }
+
+    // Cada paquete que entrega pcap, antes de clasificarlo. port es el del sniffer del motor de hilos,
+    // -1 en el reactor y el pipeline (su captura es de todos los flujos)
+    [[gnu::always_inline]] inline void packet_received(int port, uint32_t caplen, int64_t pcap_ns) {
+#if ESCANER_USDT
+        DTRACE_PROBE3(escaner, packet_received, port, caplen, pcap_ns);
+#else
+        (void)port; (void)caplen; (void)pcap_ns;
+#endif
+    }
+
+    // Una respuesta se emparejó con su sondeo y se clasificó. captured_ns ya pasado al reloj monotónico
+    [[gnu::always_inline]] inline void classified(int port, Protocol protocol, PortStatus status, int64_t captured_ns) {
+#if ESCANER_USDT
+        DTRACE_PROBE4(escaner, classified, port, protocol_number(protocol), static_cast<int>(status), captured_ns);
+#else
+        (void)port; (void)protocol; (void)status; (void)captured_ns;
+#endif
+    }
+
+    // Venció el timeout sin respuesta. sent_ns es el envío (0 si el motor no lo tiene)
+    [[gnu::always_inline]] inline void timeout(int port, Protocol protocol, int64_t sent_ns) {
+#if ESCANER_USDT
+        DTRACE_PROBE3(escaner, timeout, port, protocol_number(protocol), sent_ns);
+#else
+        (void)port; (void)protocol; (void)sent_ns;
+#endif
+    }
+
+    // ResultSink::publish con el resultado final (también los que vienen de --resume o --replay)
+    [[gnu::always_inline]] inline void result_commit(int port, Protocol protocol, PortStatus status, uint64_t rtt_ns) {
+#if ESCANER_USDT
+        DTRACE_PROBE4(escaner, result_commit, port, protocol_number(protocol), static_cast<int>(status), rtt_ns);
+#else
+        (void)port; (void)protocol; (void)status; (void)rtt_ns;
+#endif
+    }
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
+#include "args.h"
+
+// Presupuesto de sondeos en vuelo (enviados y todavía sin resultado)
+// Quien genera/manda sondeos hace acquire() antes de cada uno y quien produce el resultado hace release(),
+// así un productor rápido se frena solo y los fds, las tablas y la captura no crecen con el escaneo
+class InflightWindow {
+public:
+    explicit InflightWindow(size_t limit);
+
+    void acquire(); // Bloquea hasta que haya lugar
+    bool try_acquire();
+    void release(size_t n = 1);
+
+    size_t limit() const { return max_inflight; }
+    size_t in_flight();
+
+    // --max-inflight si se pasó, si no se calcula con auto_limit() (siempre >= 1)
+    static size_t resolve(const AppConfig& config);
+
+    // Lo que aguantan RLIMIT_NOFILE (se sube el soft al hard si se puede) y la memoria disponible
+    // según lo que cuesta un sondeo en cada motor
+    static size_t auto_limit(ScanEngine engine);
+
+private:
+    size_t max_inflight;
+    size_t count = 0;
+    size_t waiters = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include "include/journal.h"
+#include "include/utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Journal {
+
+    static constexpr int VERSION = 1;
+    static constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+    static int g_fd = -1;
+    static std::mutex g_mutex;
+    static std::condition_variable g_cv;
+    static std::string g_buffer;
+    static bool g_stop = false;
+    static std::thread g_writer;
+    static std::atomic<size_t> g_position{0};
+    static size_t g_results = 0; // Resultados en el journal, incluidos los de una corrida anterior
+
+    static uint32_t fnv1a(const std::string& text) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    static void append_line(std::string& out, const std::string& body) {
+        char checksum[16];
+        snprintf(checksum, sizeof(checksum), " *%08x\n", fnv1a(body));
+        out += body;
+        out += checksum;
+    }
+
+    static std::string to_hex(const unsigned char* data, size_t size) {
+        static const char digits[] = "0123456789abcdef";
+        if (size == 0) return "-";
+        std::string out;
+        out.reserve(size * 2);
+        for (size_t i = 0; i < size; ++i) {
+            out += digits[data[i] >> 4];
+            out += digits[data[i] & 0x0f];
+        }
+        return out;
+    }
+
+    static bool from_hex(const std::string& text, std::string& out) {
+        out.clear();
+        if (text == "-") return true;
+        if (text.size() % 2 != 0) return false;
+        for (size_t i = 0; i < text.size(); i += 2) {
+            unsigned value;
+            if (sscanf(text.c_str() + i, "%2x", &value) != 1) return false;
+            out += (char)value;
+        }
+        return true;
+    }
+
+    // Lista de puertos en rangos ("1-1024,8080"), así el encabezado no crece con -p 1-65535
+    static std::string format_ports(const std::vector<int>& ports) {
+        std::string out;
+        for (size_t i = 0; i < ports.size();) {
+            size_t j = i;
+            while (j + 1 < ports.size() && ports[j + 1] == ports[j] + 1) ++j;
+            if (!out.empty()) out += ",";
+            out += std::to_string(ports[i]);
+            if (j > i) out += "-" + std::to_string(ports[j]);
+            i = j + 1;
+        }
+        return out;
+    }
+
+    static std::vector<int> parse_ports(const std::string& text) {
+        std::vector<int> ports;
+        std::stringstream ss(text);
+        std::string token;
+        while (std::getline(ss, token, ',')) {
+            size_t guion = token.find('-');
+            try {
+                int inicio = std::stoi(token.substr(0, guion));
+                int fin = (guion == std::string::npos) ? inicio : std::stoi(token.substr(guion + 1));
+                for (int p = inicio; p <= fin && p <= 65535; ++p) ports.push_back(p);
+            } catch (...) {}
+        }
+        return ports;
+    }
+
+    static std::string header_line(const AppConfig& config) {
+        std::string protocols;
+        for (Protocol protocol : config.protocols_to_scan) {
+            if (!protocols.empty()) protocols += ",";
+            protocols += (protocol == Protocol::TCP) ? "T" : "U";
+        }
+        std::string body = "J " + std::to_string(VERSION) + " " + config.target_ip + " " + protocols + " " +
+                           format_ports(config.ports);
+        std::string line;
+        append_line(line, body);
+        return line;
+    }
+
+    // Escribe todo lo pendiente de corrido y lo baja a disco con un solo fdatasync
+    static void flush_locked(std::unique_lock<std::mutex>& lock) {
+        if (g_fd < 0) return;
+        append_line(g_buffer, "C " + std::to_string(g_position.load()) + " " + std::to_string(g_results));
+        std::string pending;
+        pending.swap(g_buffer);
+
+        // El write y el fsync van sin el lock para no frenar a los hilos que siguen anotando resultados
+        lock.unlock();
+        const char* data = pending.data();
+        size_t left = pending.size();
+        while (left > 0) {
+            ssize_t n = write(g_fd, data, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("Error al escribir el journal");
+                break;
+            }
+            data += n;
+            left -= (size_t)n;
+        }
+        fdatasync(g_fd);
+        lock.lock();
+    }
+
+    static void writer_loop() {
+        std::unique_lock<std::mutex> lock(g_mutex);
+        // El último flush va siempre, aunque close() llegue antes de que el hilo entre al ciclo
+        for (;;) {
+            g_cv.wait_for(lock, FLUSH_INTERVAL, [] { return g_stop || g_buffer.size() >= FLUSH_BYTES; });
+            bool stop = g_stop;
+            flush_locked(lock);
+            if (stop) break;
+        }
+    }
+
+    static bool start(const std::string& path, int flags, const std::string& initial) {
+        g_fd = ::open(path.c_str(), flags, 0644);
+        if (g_fd < 0) {
+            perror(("Error al abrir el journal " + path).c_str());
+            return false;
+        }
+        g_buffer = initial;
+        g_stop = false;
+        g_writer = std::thread(writer_loop);
+        return true;
+    }
+
+    bool open(const std::string& path, const AppConfig& config) {
+        g_results = 0;
+        return start(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, header_line(config));
+    }
+
+    // Parte "cuerpo *checksum" y valida el checksum
+    static bool split_line(const std::string& line, std::string& body) {
+        size_t star = line.rfind(" *");
+        if (star == std::string::npos) return false;
+        body = line.substr(0, star);
+        char expected[9];
+        snprintf(expected, sizeof(expected), "%08x", fnv1a(body));
+        return line.compare(star + 2, std::string::npos, expected) == 0;
+    }
+
+    bool resume(const std::string& path, AppConfig& config, std::vector<ScanResult>& results) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "No se pudo abrir el journal " << path << std::endl;
+            return false;
+        }
+
+        std::string line;
+        std::string body;
+        size_t valid_bytes = 0; // Hasta dónde el archivo está sano, lo que sigue se corta antes de seguir
+        bool have_header = false;
+        size_t position = 0;
+        config.resume_done.assign(TASK_SLOTS, false);
+
+        while (std::getline(in, line)) {
+            if (in.eof()) break; // Última línea sin '\n': quedó a medias
+            if (!split_line(line, body)) break;
+            std::istringstream fields(body);
+            std::string kind;
+            fields >> kind;
+
+            if (kind == "J") {
+                int version;
+                std::string target, protocols, ports;
+                fields >> version >> target >> protocols >> ports;
+                if (version != VERSION) {
+                    std::cerr << "Versión de journal no soportada: " << version << std::endl;
+                    return false;
+                }
+                if (target != config.target_ip) {
+                    std::cerr << "El journal es de " << target << ", no de " << config.target_ip << std::endl;
+                    return false;
+                }
+                // El escaneo retomado es el mismo que el original, -p/-u de esta corrida se ignoran
+                config.protocols_to_scan.clear();
+                if (protocols.find('T') != std::string::npos) config.protocols_to_scan.push_back(Protocol::TCP);
+                if (protocols.find('U') != std::string::npos) config.protocols_to_scan.push_back(Protocol::UDP);
+                config.ports = parse_ports(ports);
+                have_header = true;
+            } else if (kind == "R" && have_header) {
+                ScanResult result{};
+                std::string protocol, header_hex, banner_hex, header, banner;
+                int status;
+                fields >> result.port >> protocol >> status >> header_hex >> banner_hex;
+                if (!fields || result.port < 1 || result.port > 65535 ||
+                    !from_hex(header_hex, header) || !from_hex(banner_hex, banner)) break;
+                result.protocol = (protocol == "U") ? Protocol::UDP : Protocol::TCP;
+                result.status = static_cast<PortStatus>(status);
+                result.service = get_service_name(result.port, result.protocol);
+                result.header_bytes.assign(header.begin(), header.end());
+                result.banner = banner;
+                // El RTT se agregó después, los journals viejos no lo traen
+                uint64_t rtt_ns = 0;
+                if (fields >> rtt_ns) result.rtt_ns = rtt_ns;
+
+                size_t slot = task_slot(result.protocol, result.port);
+                if (!config.resume_done[slot]) {
+                    config.resume_done[slot] = true;
+                    results.push_back(std::move(result));
+                }
+            } else if (kind == "C" && have_header) {
+                fields >> position;
+            } else {
+                break;
+            }
+            valid_bytes = (size_t)in.tellg();
+        }
+        in.close();
+
+        if (!have_header) {
+            std::cerr << "El journal " << path << " no tiene encabezado válido" << std::endl;
+            return false;
+        }
+
+        // Se corta lo que haya quedado roto al final y se sigue agregando en el mismo archivo
+        if (truncate(path.c_str(), (off_t)valid_bytes) != 0) {
+            perror("Error al recortar el journal");
+            return false;
+        }
+        std::cout << "Retomando desde " << path << ": " << results.size() << " resultados ya terminados (posición "
+                  << position << ")" << std::endl;
+
+        g_results = results.size();
+        g_position = position;
+        return start(path, O_WRONLY | O_APPEND | O_CLOEXEC, "");
+    }
+
+    bool active() {
+        return g_fd >= 0;
+    }
+
+    void record(const ScanResult& result) {
+        if (g_fd < 0) return;
+        std::string body = "R " + std::to_string(result.port) + (result.protocol == Protocol::TCP ? " T " : " U ") +
+                           std::to_string(static_cast<int>(result.status)) + " " +
+                           to_hex(result.header_bytes.data(), result.header_bytes.size()) + " " +
+                           to_hex((const unsigned char*)result.banner.data(), result.banner.size()) + " " +
+                           std::to_string(result.rtt_ns);
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            append_line(g_buffer, body);
+            ++g_results;
+            wake = g_buffer.size() >= FLUSH_BYTES;
+        }
+        if (wake) g_cv.notify_one();
+    }
+
+    void set_position(size_t position) {
+        g_position.store(position, std::memory_order_relaxed);
+    }
+
+    void close() {
+        if (g_fd < 0) return;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_stop = true;
+        }
+        g_cv.notify_one();
+        g_writer.join();
+        ::close(g_fd);
+        g_fd = -1;
+    }
+
+}
@@ -0,0 +1,193 @@
+#include "include/json_writer.h"
+#include <array>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+    // "000102...ff": cada byte se convierte con una sola lectura de 2 caracteres
+    constexpr std::array<char, 512> make_hex_table() {
+        constexpr char digits[] = "0123456789abcdef";
+        std::array<char, 512> table{};
+        for (int i = 0; i < 256; ++i) {
+            table[i * 2] = digits[i >> 4];
+            table[i * 2 + 1] = digits[i & 0x0f];
+        }
+        return table;
+    }
+
+    constexpr std::array<char, 512> HEX_TABLE = make_hex_table();
+
+    // Caracteres que nlohmann no deja pasar tal cual: comillas, backslash y controles < 0x20. Los
+    // >= 0x80 también se revisan, para validar la secuencia UTF-8
+    constexpr std::array<bool, 256> make_escape_table() {
+        std::array<bool, 256> table{};
+        for (int i = 0; i < 0x20; ++i) table[i] = true;
+        for (int i = 0x80; i < 0x100; ++i) table[i] = true;
+        table['"'] = true;
+        table['\\'] = true;
+        return table;
+    }
+
+    constexpr std::array<bool, 256> NEEDS_ESCAPE = make_escape_table();
+
+    // Bytes que ocupa la secuencia UTF-8 que empieza en text[i]. Mal formada (byte inicial inválido,
+    // sobrelarga, surrogate, más allá de U+10FFFF o cortada) valid queda en false y se cuenta solo el
+    // prefijo que todavía podía ser válido: ese tramo se cambia por un U+FFFD y se sigue en el byte que
+    // lo rompió, igual que nlohmann con error_handler_t::replace
+    size_t utf8_sequence(std::string_view text, size_t i, bool& valid) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        unsigned char low = 0x80, high = 0xbf;
+        size_t length;
+        if (lead >= 0xc2 && lead <= 0xdf) {
+            length = 2;
+        } else if (lead >= 0xe0 && lead <= 0xef) {
+            length = 3;
+            if (lead == 0xe0) low = 0xa0;  // Sobrelarga
+            if (lead == 0xed) high = 0x9f; // Surrogates
+        } else if (lead >= 0xf0 && lead <= 0xf4) {
+            length = 4;
+            if (lead == 0xf0) low = 0x90;  // Sobrelarga
+            if (lead == 0xf4) high = 0x8f; // > U+10FFFF
+        } else {
+            valid = false;
+            return 1;
+        }
+        for (size_t k = 1; k < length; ++k) {
+            unsigned char c = i + k < text.size() ? static_cast<unsigned char>(text[i + k]) : 0;
+            if (c < low || c > high) {
+                valid = false;
+                return k;
+            }
+            low = 0x80;
+            high = 0xbf;
+        }
+        valid = true;
+        return length;
+    }
+
+}
+
+void JsonWriter::encode_hex(const unsigned char* data, size_t size, char* dest) {
+    if (size == 0) return;
+    for (size_t i = 0; i + 1 < size; ++i) {
+        std::memcpy(dest, &HEX_TABLE[data[i] * 2], 2);
+        dest[2] = ' ';
+        dest += 3;
+    }
+    std::memcpy(dest, &HEX_TABLE[data[size - 1] * 2], 2);
+}
+
+void JsonWriter::write_indent(int level) {
+    out.push_back('\n');
+    out.append(static_cast<size_t>(level * indent), ' ');
+}
+
+// Coma y salto de línea antes de cada elemento; después de una llave el valor va pegado
+void JsonWriter::before_value() {
+    if (after_key) {
+        after_key = false;
+        return;
+    }
+    if (depth == 0) return;
+    if (counts[depth - 1]++ > 0) out.push_back(',');
+    if (indent > 0) write_indent(depth);
+}
+
+void JsonWriter::open_container(char bracket) {
+    before_value();
+    out.push_back(bracket);
+    counts[depth++] = 0;
+}
+
+// Un contenedor vacío queda como "{}" o "[]", igual que en nlohmann
+void JsonWriter::close_container(char bracket) {
+    --depth;
+    if (indent > 0 && counts[depth] > 0) write_indent(depth);
+    out.push_back(bracket);
+}
+
+void JsonWriter::key(std::string_view name) {
+    before_value();
+    write_string(name);
+    out.push_back(':');
+    if (indent > 0) out.push_back(' ');
+    after_key = true;
+}
+
+void JsonWriter::value(std::string_view text) {
+    before_value();
+    write_string(text);
+}
+
+void JsonWriter::value(uint64_t number) {
+    before_value();
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+    out.append(digits, end);
+}
+
+void JsonWriter::value(int64_t number) {
+    before_value();
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+    out.append(digits, end);
+}
+
+void JsonWriter::value(bool flag) {
+    before_value();
+    out.append(flag ? "true" : "false");
+}
+
+void JsonWriter::hex_value(const unsigned char* data, size_t size) {
+    before_value();
+    out.push_back('"');
+    if (size > 0) {
+        size_t start = out.size();
+        out.resize(start + size * 3 - 1);
+        encode_hex(data, size, out.data() + start);
+    }
+    out.push_back('"');
+}
+
+// Los tramos sin nada que escapar se copian de un jalón. El UTF-8 bien formado pasa tal cual (como
+// nlohmann con ensure_ascii = false); lo que no lo es (un banner en Latin-1 o binario) sale como U+FFFD,
+// si no el NDJSON y el reporte dejarían de ser JSON válido
+void JsonWriter::write_string(std::string_view text) {
+    static constexpr char digits[] = "0123456789abcdef";
+    out.push_back('"');
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (!NEEDS_ESCAPE[c]) continue;
+        if (c >= 0x80) {
+            bool valid;
+            size_t length = utf8_sequence(text, i, valid);
+            if (!valid) {
+                out.append(text.data() + run, i - run);
+                out.append("\xef\xbf\xbd");
+                run = i + length;
+            }
+            i += length - 1;
+            continue;
+        }
+        out.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\b': out.append("\\b"); break;
+            case '\f': out.append("\\f"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', digits[c >> 4], digits[c & 0x0f]};
+                out.append(escaped, sizeof(escaped));
+                break;
+            }
+        }
+    }
+    out.append(text.data() + run, text.size() - run);
+    out.push_back('"');
+}
@@ -0,0 +1,155 @@
+#include "include/live_output.h"
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <limits>
+#include <map>
+
+namespace LiveOutput {
+
+    static std::mutex g_mutex;
+    static bool g_active = false;
+    static bool g_header_printed = false;
+
+    // Secuencia = índice del puerto en -p * protocolos + índice del protocolo (mismo orden que TaskGenerator)
+    static std::vector<int> g_port_index;
+    static int g_protocol_index[2] = {-1, -1};
+    static size_t g_protocols = 1;
+
+    // g_window[i] es la secuencia g_next + i. Los cerrados y las tareas sin resultado no se imprimen, de
+    // esos solo queda la marca de que ya se resolvieron
+    struct Slot {
+        bool resolved = false;
+        std::unique_ptr<ScanResult> row;
+    };
+    static size_t g_next = 0;
+    static std::deque<Slot> g_window;
+
+    // Copia de g_next para que los motores la consulten sin el lock, y el aviso para los que esperan lugar
+    static std::atomic<size_t> g_printed{0};
+    static std::atomic<bool> g_limited{false};
+    static std::condition_variable g_room;
+    static size_t g_waiters = 0;
+
+    static const std::map<PortStatus, std::string> status_map = {
+        {PortStatus::OPEN, "Abierto"},
+        {PortStatus::CLOSED, "Cerrado"},
+        {PortStatus::FILTERED, "Filtrado"},
+        {PortStatus::OPEN_FILTERED, "Abierto|Filtrado"},
+        {PortStatus::UNKNOWN, "Desconocido"}
+    };
+
+    static void print_header() {
+        if (g_header_printed) return;
+        std::cout << "\nPUERTO\t\tESTADO\t\tSERVICIO" << std::endl;
+        std::cout << "------\t\t------\t\t--------" << std::endl;
+        g_header_printed = true;
+    }
+
+    static void print_row(const ScanResult& result) {
+        // IMPORTANTE: Esto hace que no se muestren los puertos cerrados
+        if (result.port == 0 || result.status == PortStatus::CLOSED) return;
+        print_header();
+        const char* protocol_str = (result.protocol == Protocol::TCP) ? "TCP" : "UDP";
+        std::cout << result.port << "/" << protocol_str
+                  << "\t\t" << status_map.at(result.status)
+                  << "\t\t" << result.service;
+        if (!result.banner.empty()) std::cout << "\t" << result.banner;
+        std::cout << std::endl;
+    }
+
+    void start(const AppConfig& config) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_port_index.assign(65536, -1);
+        for (size_t i = 0; i < config.ports.size(); ++i) g_port_index[config.ports[i]] = (int)i;
+        g_protocols = std::max<size_t>(1, config.protocols_to_scan.size());
+        for (size_t i = 0; i < config.protocols_to_scan.size(); ++i) {
+            g_protocol_index[static_cast<int>(config.protocols_to_scan[i])] = (int)i;
+        }
+        g_next = 0;
+        g_window.clear();
+        g_printed.store(0, std::memory_order_release);
+        g_limited.store(true, std::memory_order_release);
+        g_active = true;
+    }
+
+    // result == nullptr: la tarea no va a tener resultado
+    static void place(int port, Protocol protocol, const ScanResult* result) {
+        bool printable = result && result->status != PortStatus::CLOSED;
+        int port_index = (port >= 0 && port < 65536) ? g_port_index[port] : -1;
+        int protocol_index = g_protocol_index[static_cast<int>(protocol)];
+        if (port_index < 0 || protocol_index < 0) {
+            if (printable) print_row(*result); // No es del escaneo (no debería pasar), se imprime tal cual
+            return;
+        }
+        size_t seq = (size_t)port_index * g_protocols + (size_t)protocol_index;
+        if (seq < g_next) return; // Repetido
+
+        size_t offset = seq - g_next;
+        if (offset >= g_window.size()) g_window.resize(offset + 1);
+        Slot& slot = g_window[offset];
+        if (slot.resolved) return; // Repetido
+        slot.resolved = true;
+        if (printable) {
+            if (offset == 0) print_row(*result); // El frente sale directo, sin copia
+            else slot.row = std::make_unique<ScanResult>(*result);
+        }
+
+        // Avanza la ventana mientras el frente ya esté resuelto
+        size_t before = g_next;
+        while (!g_window.empty() && g_window.front().resolved) {
+            if (g_window.front().row) print_row(*g_window.front().row);
+            g_window.pop_front();
+            ++g_next;
+        }
+        if (g_next != before) {
+            g_printed.store(g_next, std::memory_order_release);
+            if (g_waiters > 0) g_room.notify_all();
+        }
+    }
+
+    void submit(const ScanResult& result) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_active) return;
+        place(result.port, result.protocol, &result);
+    }
+
+    void skip(const ScanTask& task) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_active) return;
+        place(task.port, task.protocol, nullptr);
+    }
+
+    size_t room(size_t emitted, size_t limit) {
+        if (!g_limited.load(std::memory_order_acquire)) return std::numeric_limits<size_t>::max();
+        size_t ahead = emitted - std::min(emitted, g_printed.load(std::memory_order_acquire));
+        return ahead < limit ? limit - ahead : 0;
+    }
+
+    size_t wait_for_room(size_t emitted, size_t limit, std::chrono::milliseconds wait) {
+        size_t available = room(emitted, limit);
+        if (available > 0) return available;
+        std::unique_lock<std::mutex> lock(g_mutex);
+        ++g_waiters;
+        g_room.wait_for(lock, wait, [&] { return (available = room(emitted, limit)) > 0; });
+        --g_waiters;
+        return available;
+    }
+
+    void finish() {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_active) return;
+        for (auto& slot : g_window) {
+            if (slot.row) print_row(*slot.row);
+        }
+        g_window.clear();
+        print_header(); // Aunque no haya salido ninguna fila
+        g_active = false;
+        g_limited.store(false, std::memory_order_release);
+        if (g_waiters > 0) g_room.notify_all();
+    }
+
+}
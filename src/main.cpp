@@ -3,205 +3,367 @@
 #include "./include/sniffer.h"
 #include "./include/utils.h"
 #include "./include/JSONGen.h"
+#include "./include/replay.h"
+#include "./include/stats.h"
+#include "./include/scheduler.h"
+#include "./include/reactor.h"
+#include "./include/pipeline.h"
+#include "./include/affinity.h"
+#include "./include/window.h"
+#include "./include/shutdown.h"
+#include "./include/journal.h"
+#include "./include/result_sink.h"
+#include "./include/ndjson.h"
+#include "./include/live_output.h"
+#include "./include/binary_report.h"
+#include "./include/query.h"
+#include "./include/diff.h"
+#include "./include/timing.h"
+#include "./include/phases.h"
+#include "./include/metrics.h"
+#include "./include/trace.h"
+#include "./include/usdt.h"
+#include "./include/perf_counters.h"
 #include <iostream>
 #include <thread>
 #include <vector>
-#include <queue>
-#include <mutex>
 #include <future>
 #include <algorithm>
-#include <map>
 
-// Esto es "una unidad de trabajo"
-struct ScanTask {
-    int port;
-    Protocol protocol;
-};
-
-// Esto no sé si va a estar 100% bien con un patrón de producción y bla bla pero
-// esto es para evitar las famosas "race conditions", es decir, que los hilos hagan cosas
-// extrañas por no saber el estado de los demás hilos
-
-//  Esto funciona como una queue global que todos los hilos comparten, (productor - consumidor)
-std::queue<ScanTask> g_task_queue;
-
-// Esto garantiza el acceso atómico a g_task_queue, esto es lo que previene las race conditions
-std::mutex g_queue_mutex;
-
-// Aquí es donde se almacenan los resultados de cada tarea de escaneo
+// Aquí es donde se juntan los resultados de todos los workers al final del escaneo
 std::vector<ScanResult> g_results;
 
-// Esto protege el acceso a g_results durante las inserciones
-std::mutex g_results_mutex;
+// Espera el resultado del sniffer hasta el timeout, en tramos cortos para notar si se acabó la gracia
+// de una interrupción. Retorna true si el resultado llegó
+static bool wait_sniffer(std::future<SnifferResult>& future, int timeout_ms) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        auto slice = std::min(until, std::chrono::steady_clock::now() + std::chrono::milliseconds(50));
+        if (future.wait_until(slice) == std::future_status::ready) return true;
+        if (std::chrono::steady_clock::now() >= until || Shutdown::expired()) return false;
+    }
+}
 
-// Esta es la función que se ejecuta por cada "worker" (cada hilo)
-void scan_worker(const AppConfig& config) {
+// Esto hace UN sondeo completo (sniffer + connect/sendto) y llena el resultado
+// Retorna false si el sondeo ni siquiera se pudo enviar y no hay nada que reportar, o si una interrupción
+// lo cortó antes de tiempo (en ese caso queda anotado como pendiente)
+bool scan_task(const AppConfig& config, const ScanTask& task, ScanResult& final_result) {
+    Phases::Timer probe_timer(Phases::Phase::PROBE);
+    Scanner scanner(config.target_ip, config.timeout_ms);
+    final_result.port = task.port;
+    final_result.protocol = task.protocol;
+    final_result.service = get_service_name(task.port, task.protocol);
 
-    // Esto es el bucle principal, se ejecuta hasta que la cola de tareas termine
-    while (true) {
-        ScanTask task;
-        {
-            // lock_guard se asegura de que el mutex se libere automáticamente
-            std::lock_guard<std::mutex> lock(g_queue_mutex);
+    if (task.protocol == Protocol::TCP) {
+        // Esta es la lógica del escaneo TCP, conexión activa y captura pasiva
+        Sniffer sniffer(config.interface, config.target_ip, task.port);
 
-            // Esta es la salida del hilo, si ya no hay nada que hacer el trabajo terminó
-            if (g_task_queue.empty()) return;
-            task = g_task_queue.front();
-            g_task_queue.pop();
+        // Se usa un patrón "promise/future" para la comunicación asíncrona entre
+        // este hilo y el hilo del sniffer que se crea después
+        std::promise<SnifferResult> sniffer_promise;
+        std::future<SnifferResult> sniffer_future = sniffer_promise.get_future();
+        
+        // Se crea un hilo específico para el sniffer para capturar los paquetes
+        std::thread sniffer_thread(&Sniffer::start, &sniffer, task.protocol, std::move(sniffer_promise));
+        Affinity::pin_thread(sniffer_thread, Affinity::Role::RX);
+        // Se le da una pausita para darle tiempo al sniffer a iniciar la captura antes de enviar paquetes
+        // la idea es mitigar una race condition, una condition variable sería mejor pero esto me sirve
+        {
+            Phases::Timer pause(Phases::Phase::PRE_PROBE);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        
+        // Se inicia el escaneo
+        int64_t connect_start = Phases::now();
+        PortStatus connect_status = scanner.scanTCP(task.port);
+        Phases::record_since(Phases::Phase::CONNECT, connect_start);
+        ScanStats::probe_sent();
+        
+        SnifferResult sniffer_result;
+        // Se espera el resultado del sniffer pero con timeout para no estar esperando infinitamente
+        int64_t wait_start = Phases::now();
+        bool answered = wait_sniffer(sniffer_future, config.timeout_ms);
+        Phases::record_since(Phases::Phase::WAIT_RESPONSE, wait_start);
+        if (answered) sniffer_result = sniffer_future.get(); // Si estuvo listo a tiempo se toma el resultado
+        else {
+            Trace::event(Trace::Event::TIMEOUT, task.protocol, task.port);
+            Usdt::timeout(task.port, task.protocol, scanner.sent_at());
         }
 
-        Scanner scanner(config.target_ip, config.timeout_ms);
-        ScanResult final_result{};
-        final_result.port = task.port;
-        final_result.protocol = task.protocol;
-        final_result.service = get_service_name(task.port, task.protocol);
-
-        if (task.protocol == Protocol::TCP) {
-            // Esta es la lógica del escaneo TCP, conexión activa y captura pasiva
-            Sniffer sniffer(config.interface, config.target_ip, task.port);
-
-            // Se usa un patrón "promise/future" para la comunicación asíncrona entre
-            // este hilo y el hilo del sniffer que se crea después
-            std::promise<SnifferResult> sniffer_promise;
-            std::future<SnifferResult> sniffer_future = sniffer_promise.get_future();
-            
-            // Se crea un hilo específico para el sniffer para capturar los paquetes
-            std::thread sniffer_thread(&Sniffer::start, &sniffer, task.protocol, std::move(sniffer_promise));
-            // Se le da una pausita para darle tiempo al sniffer a iniciar la captura antes de enviar paquetes
-            // la idea es mitigar una race condition, una condition variable sería mejor pero esto me sirve
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            
-            // Se inicia el escaneo
-            PortStatus connect_status = scanner.scanTCP(task.port);
-            
-            SnifferResult sniffer_result;
-            // Se espera el resultado del sniffer pero con timeout para no estar esperando infinitamente
-            if (sniffer_future.wait_for(std::chrono::milliseconds(config.timeout_ms)) == std::future_status::ready) {
-                sniffer_result = sniffer_future.get(); // Si estuvo listo a tiempo se toma el resultado
-            } else {
-                sniffer.stop(); // IMPORTANTE: si el "futuro" expiró se detiene la captura
-            }
+        {
+            Phases::Timer close(Phases::Phase::CAPTURE_CLOSE);
+            if (!answered) sniffer.stop(); // IMPORTANTE: si el "futuro" expiró se detiene la captura
             sniffer_thread.join(); // Esto sincroniza y espera a que el hilo del sniffer termine
-            
-            final_result.header_bytes = sniffer_result.header_bytes;
-            // Esto prioriza el resultado del sniffer basado en una respuesta real sobre el escaneo que se hace con connect()
-            final_result.status = (sniffer_result.packet_found && sniffer_result.status != PortStatus::UNKNOWN)
-                                   ? sniffer_result.status
-                                   : connect_status;
-                                   
-        } else {
-            
-            Sniffer sniffer(config.interface, config.target_ip, task.port);
-            std::promise<SnifferResult> sniffer_promise;
-            std::future<SnifferResult> sniffer_future = sniffer_promise.get_future();
-            
-            std::thread sniffer_thread(&Sniffer::start, &sniffer, task.protocol, std::move(sniffer_promise));
+        }
+        if (sniffer.open_ns > 0) Phases::record(Phases::Phase::CAPTURE_OPEN, sniffer.open_ns);
+
+        // Cortado por el fin de la gracia: sin respuesta no se sabe si de verdad estaba filtrado
+        if (!sniffer_result.packet_found && Shutdown::expired()) {
+            Shutdown::abandoned(task);
+            return false;
+        }
+        
+        if (sniffer_result.packet_found) ScanStats::probe_answered();
+        final_result.header_bytes = sniffer_result.header_bytes;
+        final_result.rtt_ns = Timing::rtt_ns(scanner.sent_at(), sniffer_result.capture_ns);
+        // Esto prioriza el resultado del sniffer basado en una respuesta real sobre el escaneo que se hace con connect()
+        final_result.status = (sniffer_result.packet_found && sniffer_result.status != PortStatus::UNKNOWN)
+                               ? sniffer_result.status
+                               : connect_status;
+                               
+    } else {
+        
+        Sniffer sniffer(config.interface, config.target_ip, task.port);
+        std::promise<SnifferResult> sniffer_promise;
+        std::future<SnifferResult> sniffer_future = sniffer_promise.get_future();
+        
+        std::thread sniffer_thread(&Sniffer::start, &sniffer, task.protocol, std::move(sniffer_promise));
+        Affinity::pin_thread(sniffer_thread, Affinity::Role::RX);
+        {
+            Phases::Timer pause(Phases::Phase::PRE_PROBE);
             std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Más tiempo para UDP
-            
-            // se envia el paquete de sondeo UDP DESPUÉS de asegurarse que el sniffer está escuchando
-            if (!scanner.sendUDPProbe(task.port)) {
-                sniffer.stop();
-                sniffer_thread.join();
-                continue;  // Si el envío falla solo se continúa
-            }
-            
-            SnifferResult sniffer_result;
-            if (sniffer_future.wait_for(std::chrono::milliseconds(config.timeout_ms)) == std::future_status::ready) {
-                // Si el sniffer capturó un paquete ICMP es que está cerrado
-                // si capturó algo en UDP está abierto, esta lógica se maneja en sniffer.cpp
-                sniffer_result = sniffer_future.get();
-                final_result.header_bytes = sniffer_result.header_bytes;
-                final_result.status = sniffer_result.status;
-            } else {
-                sniffer.stop();
-                sniffer_thread.join();
-                // Como estamos mandando un payload vacío puede ser que el puerto SÍ
-                // esté abierto pero no sepa que responder así que se maneja ese caso
-                final_result.status = PortStatus::OPEN_FILTERED;
-            }
-            
-            // Esto se asegura que el hilo del sniffer siempre esté unido anque el futuro expire
-            if (sniffer_thread.joinable()) {
-                sniffer_thread.join();
-            }
+        }
+        
+        // se envia el paquete de sondeo UDP DESPUÉS de asegurarse que el sniffer está escuchando
+        int64_t send_start = Phases::now();
+        bool sent = scanner.sendUDPProbe(task.port);
+        Phases::record_since(Phases::Phase::SEND, send_start);
+        if (!sent) {
+            sniffer.stop();
+            sniffer_thread.join();
+            return false;  // Si el envío falla solo se continúa
+        }
+        ScanStats::probe_sent();
+        
+        int64_t wait_start = Phases::now();
+        bool answered = wait_sniffer(sniffer_future, config.timeout_ms);
+        Phases::record_since(Phases::Phase::WAIT_RESPONSE, wait_start);
+        if (!answered) {
+            Trace::event(Trace::Event::TIMEOUT, task.protocol, task.port);
+            Usdt::timeout(task.port, task.protocol, scanner.sent_at());
+        }
+        if (answered) {
+            // Si el sniffer capturó un paquete ICMP es que está cerrado
+            // si capturó algo en UDP está abierto, esta lógica se maneja en sniffer.cpp
+            SnifferResult sniffer_result = sniffer_future.get();
+            if (sniffer_result.packet_found) ScanStats::probe_answered();
+            final_result.header_bytes = sniffer_result.header_bytes;
+            final_result.rtt_ns = Timing::rtt_ns(scanner.sent_at(), sniffer_result.capture_ns);
+            final_result.status = sniffer_result.status;
         }
 
+        // Esto se asegura que el hilo del sniffer siempre esté unido anque el futuro expire
         {
-            // Aquí almacenas los resultados
-            std::lock_guard<std::mutex> lock(g_results_mutex);
-            g_results.push_back(final_result);
+            Phases::Timer close(Phases::Phase::CAPTURE_CLOSE);
+            if (!answered) sniffer.stop();
+            sniffer_thread.join();
+        }
+        if (sniffer.open_ns > 0) Phases::record(Phases::Phase::CAPTURE_OPEN, sniffer.open_ns);
+
+        if (!answered) {
+            if (Shutdown::expired()) {
+                Shutdown::abandoned(task);
+                return false;
+            }
+            // Como estamos mandando un payload vacío puede ser que el puerto SÍ
+            // esté abierto pero no sepa que responder así que se maneja ese caso
+            final_result.status = PortStatus::OPEN_FILTERED;
         }
     }
+    return true;
 }
 
+// Esta es la función que se ejecuta por cada "worker" (cada hilo)
+// Ya no hay queue ni mutex globales: cada worker saca lotes de su propio deque (y roba si se queda sin nada)
+// y guarda sus resultados en su propio vector, así los hilos no se estorban entre sí
+void scan_worker(const AppConfig& config, WorkStealingScheduler& scheduler, size_t worker_id,
+                 std::vector<ScanResult>& results) {
+    // Un worker por CPU de --cpu-workers (o del nodo de la NIC en modo auto)
+    Affinity::pin_current_thread(Affinity::Role::WORKER, (int)worker_id);
+    Trace::name_thread("worker " + std::to_string(worker_id));
 
-// Imprime los resultados de forma ordenada, no supe hacer que lo haga en orden a pesar de que sea por hilos,
-// demasiada complejidad comparada con el proyecto anterior
-void print_results(const std::vector<ScanResult>& results) {
-    std::map<PortStatus, std::string> status_map = {
-        {PortStatus::OPEN, "Abierto"},
-        {PortStatus::CLOSED, "Cerrado"},
-        {PortStatus::FILTERED, "Filtrado"},
-        {PortStatus::OPEN_FILTERED, "Abierto|Filtrado"},
-        {PortStatus::UNKNOWN, "Desconocido"}
-    };
-    
-    std::vector<ScanResult> sorted_results = results;
-
-    // Ordena los resultados por puerto y luego por protocolo
-    std::sort(sorted_results.begin(), sorted_results.end(), [](const ScanResult& a, const ScanResult& b) {
-        if (a.port != b.port) return a.port < b.port;
-        return static_cast<int>(a.protocol) < static_cast<int>(b.protocol);
-    });
-
-    std::cout << "\nPUERTO\t\tESTADO\t\tSERVICIO" << std::endl;
-    std::cout << "------\t\t------\t\t--------" << std::endl;
-
-    for (const auto& result : sorted_results) {
-        // IMPORTANTE: Esto hace que no se muestren los puertos cerrados
-        if (result.status == PortStatus::CLOSED) continue;
-        
-        const char* protocol_str = (result.protocol == Protocol::TCP) ? "TCP" : "UDP";
-        std::cout << result.port << "/" << protocol_str
-                  << "\t\t" << status_map[result.status]
-                  << "\t\t" << result.service
-                  << std::endl;
+    std::vector<ScanTask> batch;
+    // Esto es el bucle principal, se ejecuta hasta que el scheduler ya no tenga tareas en ningún deque
+    // Con una interrupción se deja de pedir lotes y lo que queda del lote actual se anota como pendiente
+    while (!Shutdown::requested() && scheduler.claim(worker_id, batch)) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const ScanTask& task = batch[i];
+            if (Shutdown::requested()) {
+                Shutdown::abandoned(std::vector<ScanTask>(batch.begin() + i, batch.end()));
+                break;
+            }
+            // Si la captura está perdiendo paquetes se baja el ritmo antes del siguiente sondeo
+            auto pacing = ScanStats::pacing_delay();
+            if (pacing.count() > 0) std::this_thread::sleep_for(pacing);
+
+            ScanResult final_result{};
+            Trace::event(Trace::Event::DEQUEUED, task.protocol, task.port);
+            Metrics::inflight_add(1);
+            bool done = scan_task(config, task, final_result);
+            Metrics::inflight_add(-1);
+            if (!done) {
+                ResultSink::discard(task);
+                continue;
+            }
+
+            // Aquí almacenas los resultados, sin lock porque el vector es solo de este worker
+            if (ResultSink::publish(final_result)) results.push_back(std::move(final_result));
+        }
     }
 }
 
-int main(int argc, char* argv[]) {
-    AppConfig config = ArgsParser::parse(argc, argv);
-    if (config.show_help || !config.args_validos) return config.args_validos ? 0 : 1;
 
-    // Se determina el número de hilos
+// Escaneo en vivo: se lanza la pool de hilos (o el motor elegido) sobre el generador de tareas
+void run_live_scan(const AppConfig& config) {
+    // El reactor no usa pool, un solo hilo con epoll lleva todos los sondeos
+    if (config.engine == ScanEngine::REACTOR) {
+        std::cout << "Iniciando escaneo en " << config.target_ip << " con el motor reactor (hasta "
+                  << config.max_inflight << " sondeos en vuelo)..." << std::endl;
+        g_results = Reactor::run(config);
+        return;
+    }
+    if (config.engine == ScanEngine::PIPELINE) {
+        std::cout << "Iniciando escaneo en " << config.target_ip << " con el motor pipeline (hasta "
+                  << config.max_inflight << " sondeos en vuelo)..." << std::endl;
+        g_results = Pipeline::run(config);
+        return;
+    }
+
+    // Se determina el número de hilos. En este motor cada hilo tiene un solo sondeo en vuelo,
+    // así que la ventana de sondeos es también el tope de hilos
     size_t num_threads = config.num_threads > 0 ? config.num_threads : std::thread::hardware_concurrency();
     if (num_threads == 0) num_threads = 4;
+    if (num_threads > config.max_inflight) {
+        std::cout << "Se limitan los hilos a " << config.max_inflight << " (máximo de sondeos en vuelo)" << std::endl;
+        num_threads = config.max_inflight;
+    }
 
     std::cout << "Iniciando escaneo en " << config.target_ip << " con " << num_threads << " hilos..." << std::endl;
 
-    // Se llena la queue de tareas con los puertos y protocolos a escanear
-    for (Protocol protocol : config.protocols_to_scan) {
-        for (int port : config.ports) {
-            g_task_queue.push({port, protocol});
-        }
-    }
+    // Las tareas (puertos x protocolos) se generan a medida que los workers piden lotes
+    TaskGenerator generator(config);
+    WorkStealingScheduler scheduler(num_threads);
+    scheduler.attach(generator, config.max_inflight);
 
-    // Se crea y lanza la pool de hilos
+    // Se crea y lanza la pool de hilos, cada uno con su propio buffer de resultados
+    std::vector<std::vector<ScanResult>> worker_results(num_threads);
     std::vector<std::thread> workers;
     for (size_t i = 0; i < num_threads; ++i) {
-        workers.emplace_back(scan_worker, std::cref(config));
+        workers.emplace_back(scan_worker, std::cref(config), std::ref(scheduler), i, std::ref(worker_results[i]));
     }
 
     // El hilo main espera a que todos los trabajadores completen su ejecución
     for (auto& worker : workers) {
         worker.join();
     }
-    
-    print_results(g_results);
 
+    // Si se interrumpió, lo que alcanzó a repartirse y nadie tomó también queda pendiente
+    std::vector<ScanTask> leftover;
+    scheduler.drain(leftover);
+    Shutdown::abandoned(leftover);
+    Shutdown::set_position(generator.emitted(), generator.total());
+
+    // Se juntan los buffers de cada worker, ya sin ningún hilo escribiendo
+    for (auto& partial : worker_results) {
+        g_results.insert(g_results.end(), std::make_move_iterator(partial.begin()), std::make_move_iterator(partial.end()));
+    }
+}
+
+// Los escritores de NDJSON, del journal y de métricas viven en hilos guardados en statics: salir de main
+// sin cerrarlos es un std::thread sin join y termina en std::terminate. Con esto cualquier return los
+// cierra; en el camino normal ya se cerraron antes y close()/stop() no hacen nada la segunda vez
+struct WritersGuard {
+    ~WritersGuard() {
+        Metrics::stop();
+        Journal::close();
+        NDJSON::close();
+    }
+};
+
+int main(int argc, char* argv[]) {
+    // "escaner query/diff ..." no escanean, solo leen reportes
+    if (argc > 1 && std::string(argv[1]) == "query") return Query::run(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "diff") return Diff::run(argc, argv);
+
+    AppConfig config = ArgsParser::parse(argc, argv);
+    if (config.show_help || !config.args_validos) return config.args_validos ? 0 : 1;
+    if (config.phase_stats) Phases::enable();
+    if (!config.trace_file.empty()) Trace::enable(config.trace_sample);
+    if (config.perf_counters && !PerfCounters::enable()) return 1;
+
+    WritersGuard writers;
+    // Con NDJSON por stdout todo lo demás (progreso, tabla, resumen) se va a stderr para no mezclarse
+    if (!config.ndjson_file.empty()) {
+        if (!NDJSON::open(config.ndjson_file)) return 1;
+        if (NDJSON::to_stdout()) std::cout.rdbuf(std::cerr.rdbuf());
+    }
+    ResultSink::configure(config);
+    LiveOutput::start(config);
+
+    // El modo replay no abre sockets ni interfaces, solo lee la captura y clasifica
+    if (!config.replay_file.empty()) {
+        std::cout << "Reproduciendo " << config.replay_file << " contra " << config.target_ip << "..." << std::endl;
+        g_results = Replay::run(config);
+        if (g_results.empty()) return 1;
+        for (const auto& result : g_results) ResultSink::publish(result, false);
+    } else {
+        // Con --resume los puertos y protocolos salen del journal y lo ya terminado no se vuelve a sondear
+        std::vector<ScanResult> resumed;
+        if (config.resume) {
+            if (!Journal::resume(config.journal_file, config, resumed)) return 1;
+        } else if (!config.journal_file.empty() && !Journal::open(config.journal_file, config)) {
+            return 1;
+        }
+
+        // Lo retomado también sale por NDJSON y en la tabla, así ambos tienen el escaneo completo
+        LiveOutput::start(config); // Los puertos y protocolos pudieron cambiar con el journal
+        for (const auto& result : resumed) ResultSink::publish(result, false);
+        if (!ResultSink::retain()) resumed.clear();
+
+        Affinity::configure(config);
+        config.max_inflight = InflightWindow::resolve(config);
+        Shutdown::install(std::chrono::milliseconds(config.grace_ms));
+        if (!Metrics::start(config)) return 1;
+        run_live_scan(config);
+        Metrics::stop();
+        Journal::close();
+
+        g_results.insert(g_results.end(), std::make_move_iterator(resumed.begin()), std::make_move_iterator(resumed.end()));
+    }
+    NDJSON::close();
+    Shutdown::Progress progress = Shutdown::progress();
+
+    LiveOutput::finish();
+
+    ScanStats::Summary stats = ScanStats::summary();
+    ScanStats::print_summary(stats);
+
+    int64_t report_start = Phases::now();
     if (!config.output_file.empty()) {
         std::cout << "\nGenerando reporte en: " << config.output_file << "..." << std::endl;
-        JSONGenerator::generate_report(config, g_results);
+        JSONGenerator::generate_report(config, g_results, stats, progress);
+    }
+    if (!config.binary_file.empty()) {
+        std::cout << "Generando reporte binario en: " << config.binary_file << "..." << std::endl;
+        BinaryReport::write(config, g_results);
+    }
+    if (!config.diff_file.empty()) Diff::against(config, g_results, config.diff_file, progress);
+    if (!config.output_file.empty() || !config.binary_file.empty() || !config.diff_file.empty()) {
+        Phases::record_since(Phases::Phase::REPORT, report_start);
+    }
+
+    if (config.phase_stats) {
+        std::vector<Phases::Percentiles> phases = Phases::summary();
+        Phases::print(phases);
+        if (!config.phase_json.empty()) Phases::write_json(config.phase_json, phases);
+    }
+    PerfCounters::print(stats.probes_sent);
+    if (Trace::enabled()) Trace::write(config.trace_file);
+
+    if (progress.interrupted) {
+        std::cout << "\nEscaneo interrumpido: " << progress.position << " de " << progress.total
+                  << " tareas repartidas, " << progress.incomplete.size() << " quedaron sin resultado." << std::endl;
+        return 130;
     }
 
     std::cout << "\nEscaneo completo." << std::endl;
@@ -0,0 +1,307 @@
+#include "include/metrics.h"
+#include "include/stats.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <dirent.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+
+namespace Metrics {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Cada cuánto se reescribe el archivo y se recalculan los sondeos por segundo
+    static constexpr auto INTERVAL = std::chrono::seconds(1);
+    // Lo más que el hilo exportador duerme sin revisar si ya hay que parar
+    static constexpr int POLL_MS = 200;
+    static constexpr size_t MAX_REQUEST = 4096;
+
+    enum Response { TCP_SYNACK, TCP_RST, UDP_REPLY, ICMP_UNREACHABLE, OTHER, RESPONSE_TYPES };
+    static constexpr const char* RESPONSE_NAMES[] = {"tcp_synack", "tcp_rst", "udp", "icmp_unreachable", "other"};
+    static constexpr const char* STATUS_NAMES[] = {"open", "closed", "filtered", "open_filtered", "unknown"};
+    static constexpr size_t STATUSES = std::size(STATUS_NAMES);
+
+    // Lo que escriben los motores (relaxed: nadie sincroniza nada a través de estos contadores)
+    static std::atomic<int64_t> g_inflight{0};
+    static std::atomic<uint64_t> g_results[2][STATUSES];
+    static std::atomic<uint64_t> g_responses[RESPONSE_TYPES];
+
+    static std::mutex g_queues_mutex;
+    static QueueDepths g_queues;
+
+    // Del hilo exportador
+    static const AppConfig* g_config = nullptr;
+    static std::thread g_thread;
+    static std::atomic<bool> g_stop{false};
+    static int g_listen_fd = -1;
+    static uint64_t g_last_sent = 0;
+    static Clock::time_point g_last_tick;
+    static double g_pps = 0;
+
+    void inflight_add(int64_t n) {
+        g_inflight.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void result(const ScanResult& result) {
+        size_t protocol = result.protocol == Protocol::TCP ? 0 : 1;
+        g_results[protocol][static_cast<size_t>(result.status)].fetch_add(1, std::memory_order_relaxed);
+        // Sin bytes de header no hubo paquete de respuesta (timeout o solo connect())
+        if (result.header_bytes.empty()) return;
+        Response type = OTHER;
+        if (result.protocol == Protocol::TCP) {
+            if (result.status == PortStatus::OPEN) type = TCP_SYNACK;
+            else if (result.status == PortStatus::CLOSED) type = TCP_RST;
+        } else {
+            if (result.status == PortStatus::OPEN) type = UDP_REPLY;
+            else if (result.status == PortStatus::CLOSED) type = ICMP_UNREACHABLE;
+        }
+        g_responses[type].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void set_queue_depths(QueueDepths depths) {
+        std::lock_guard<std::mutex> lock(g_queues_mutex);
+        g_queues = std::move(depths);
+    }
+
+    static size_t open_fds() {
+        size_t count = 0;
+        if (DIR* dir = opendir("/proc/self/fd")) {
+            while (dirent* entry = readdir(dir)) {
+                if (entry->d_name[0] != '.') ++count;
+            }
+            closedir(dir);
+            if (count > 0) --count; // El del propio opendir
+        }
+        return count;
+    }
+
+    static std::string label(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '\\' || c == '"') escaped += '\\';
+            if (c == '\n') { escaped += "\\n"; continue; }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    static void header(std::ostringstream& out, const char* name, const char* type, const char* help) {
+        out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+    }
+
+    static std::string render() {
+        std::ostringstream out;
+        ScanStats::Summary stats = ScanStats::counters();
+
+        const char* engine = g_config->engine == ScanEngine::REACTOR ? "reactor"
+                           : g_config->engine == ScanEngine::PIPELINE ? "pipeline" : "threads";
+        header(out, "escaner_scan_info", "gauge", "Objetivo y motor del escaneo");
+        out << "escaner_scan_info{target=\"" << label(g_config->target_ip) << "\",engine=\"" << engine << "\"} 1\n";
+        header(out, "escaner_scan_tasks", "gauge", "Tareas del escaneo completo (puertos x protocolos)");
+        out << "escaner_scan_tasks " << g_config->ports.size() * g_config->protocols_to_scan.size() << '\n';
+
+        header(out, "escaner_probes_sent_total", "counter", "Sondeos enviados");
+        out << "escaner_probes_sent_total " << stats.probes_sent << '\n';
+        header(out, "escaner_probes_answered_total", "counter", "Sondeos con respuesta en la captura");
+        out << "escaner_probes_answered_total " << stats.probes_answered << '\n';
+        header(out, "escaner_probes_per_second", "gauge", "Sondeos enviados por segundo en el último intervalo");
+        out << "escaner_probes_per_second " << g_pps << '\n';
+
+        header(out, "escaner_responses_total", "counter", "Respuestas capturadas por tipo");
+        for (size_t t = 0; t < RESPONSE_TYPES; ++t) {
+            out << "escaner_responses_total{type=\"" << RESPONSE_NAMES[t] << "\"} "
+                << g_responses[t].load(std::memory_order_relaxed) << '\n';
+        }
+        header(out, "escaner_results_total", "counter", "Puertos con resultado por protocolo y estado");
+        for (size_t p = 0; p < 2; ++p) {
+            for (size_t s = 0; s < STATUSES; ++s) {
+                out << "escaner_results_total{protocol=\"" << (p == 0 ? "tcp" : "udp") << "\",status=\""
+                    << STATUS_NAMES[s] << "\"} " << g_results[p][s].load(std::memory_order_relaxed) << '\n';
+            }
+        }
+
+        header(out, "escaner_inflight_probes", "gauge", "Sondeos en vuelo");
+        out << "escaner_inflight_probes " << std::max<int64_t>(0, g_inflight.load(std::memory_order_relaxed)) << '\n';
+        header(out, "escaner_inflight_limit", "gauge", "Tope de sondeos en vuelo (--max-inflight)");
+        out << "escaner_inflight_limit " << g_config->max_inflight << '\n';
+        header(out, "escaner_pacing_delay_seconds", "gauge", "Pausa antes de cada sondeo por pérdida en la captura");
+        out << "escaner_pacing_delay_seconds " << ScanStats::pacing_delay().count() / 1e6 << '\n';
+
+        header(out, "escaner_capture_received_total", "counter", "Paquetes que pasaron el filtro BPF");
+        for (const auto& c : stats.interfaces) {
+            out << "escaner_capture_received_total{interface=\"" << label(c.interface) << "\"} " << c.received << '\n';
+        }
+        header(out, "escaner_capture_dropped_total", "counter", "Paquetes perdidos por la captura");
+        for (const auto& c : stats.interfaces) {
+            out << "escaner_capture_dropped_total{interface=\"" << label(c.interface) << "\",where=\"kernel\"} "
+                << c.kernel_dropped << '\n';
+            out << "escaner_capture_dropped_total{interface=\"" << label(c.interface) << "\",where=\"interface\"} "
+                << c.interface_dropped << '\n';
+        }
+        header(out, "escaner_capture_ignored_total", "counter", "Paquetes capturados que no eran respuesta de ningún sondeo");
+        for (const auto& c : stats.interfaces) {
+            out << "escaner_capture_ignored_total{interface=\"" << label(c.interface) << "\"} " << c.ignored << '\n';
+        }
+
+        header(out, "escaner_open_fds", "gauge", "Descriptores abiertos por el proceso");
+        out << "escaner_open_fds " << open_fds() << '\n';
+        rlimit nofile{};
+        if (getrlimit(RLIMIT_NOFILE, &nofile) == 0) {
+            header(out, "escaner_max_fds", "gauge", "RLIMIT_NOFILE (soft)");
+            out << "escaner_max_fds " << nofile.rlim_cur << '\n';
+        }
+
+        std::lock_guard<std::mutex> lock(g_queues_mutex);
+        if (g_queues) {
+            header(out, "escaner_queue_depth", "gauge", "Lotes esperando en cada cola del motor");
+            for (const auto& [name, depth] : g_queues()) {
+                out << "escaner_queue_depth{queue=\"" << label(name) << "\"} " << depth << '\n';
+            }
+        }
+        return out.str();
+    }
+
+    static void tick() {
+        auto now = Clock::now();
+        uint64_t sent = ScanStats::counters().probes_sent;
+        double seconds = std::chrono::duration<double>(now - g_last_tick).count();
+        if (seconds > 0) g_pps = (sent - g_last_sent) / seconds;
+        g_last_sent = sent;
+        g_last_tick = now;
+
+        if (g_config->metrics_file.empty()) return;
+        // Se escribe aparte y se renombra, así quien lo lea nunca ve un archivo a medias
+        std::string tmp_file = g_config->metrics_file + ".tmp";
+        {
+            std::ofstream o(tmp_file, std::ios::binary);
+            o << render();
+            if (!o) return;
+        }
+        std::rename(tmp_file.c_str(), g_config->metrics_file.c_str());
+    }
+
+    // Un cliente a la vez y HTTP/1.0 (se cierra al terminar), alcanza para un scraper
+    static void serve(int client) {
+        timeval timeout{1, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST) {
+            ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            request.append(buffer, n);
+        }
+
+        std::string path;
+        std::istringstream line(request.substr(0, request.find("\r\n")));
+        std::string method;
+        line >> method >> path;
+        std::string status = "200 OK";
+        std::string body;
+        if (method != "GET") {
+            status = "405 Method Not Allowed";
+        } else if (path != "/metrics" && path != "/") {
+            status = "404 Not Found";
+        } else {
+            body = render();
+        }
+        std::string response = "HTTP/1.0 " + status + "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t written = 0;
+        while (written < response.size()) {
+            ssize_t n = send(client, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            written += n;
+        }
+        close(client);
+    }
+
+    static void exporter() {
+        auto next_tick = Clock::now() + INTERVAL;
+        while (!g_stop.load(std::memory_order_acquire)) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_tick - Clock::now()).count();
+            int timeout = static_cast<int>(std::clamp<int64_t>(wait, 0, POLL_MS));
+            if (g_listen_fd >= 0) {
+                pollfd pfd{g_listen_fd, POLLIN, 0};
+                if (poll(&pfd, 1, timeout) > 0) {
+                    int client = accept4(g_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (client >= 0) serve(client);
+                }
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            }
+            if (Clock::now() >= next_tick) {
+                tick();
+                next_tick += INTERVAL;
+            }
+        }
+    }
+
+    // "9100" o "0.0.0.0:9100"; sin dirección solo escucha en loopback
+    static int open_listener(const std::string& spec) {
+        std::string address = "127.0.0.1";
+        std::string port = spec;
+        size_t colon = spec.rfind(':');
+        if (colon != std::string::npos) {
+            address = spec.substr(0, colon);
+            port = spec.substr(colon + 1);
+        }
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        int number = 0;
+        try { number = std::stoi(port); } catch (...) {}
+        if (number < 1 || number > 65535 || inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+            std::cerr << "Métricas: dirección inválida para --metrics-listen: " << spec << std::endl;
+            return -1;
+        }
+        addr.sin_port = htons(number);
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+            std::cerr << "Métricas: no se pudo escuchar en " << spec << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        std::cout << "Métricas en http://" << address << ':' << number << "/metrics" << std::endl;
+        return fd;
+    }
+
+    bool start(const AppConfig& config) {
+        if (config.metrics_listen.empty() && config.metrics_file.empty()) return true;
+        g_config = &config;
+        if (!config.metrics_listen.empty()) {
+            g_listen_fd = open_listener(config.metrics_listen);
+            if (g_listen_fd < 0) return false;
+        }
+        g_last_tick = Clock::now();
+        g_stop.store(false);
+        g_thread = std::thread(exporter);
+        return true;
+    }
+
+    void stop() {
+        if (!g_thread.joinable()) return;
+        g_stop.store(true, std::memory_order_release);
+        g_thread.join();
+        tick(); // El archivo queda con los números finales
+        if (g_listen_fd >= 0) close(g_listen_fd);
+        g_listen_fd = -1;
+    }
+
+}
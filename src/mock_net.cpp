@@ -0,0 +1,125 @@
+#include "include/mock_net.h"
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <netinet/tcp.h>
+#include <netinet/udp.h>
+
+// Si el objetivo de la configuración no es una IPv4 se usa esta, al mock le da igual
+static constexpr const char* DEFAULT_TARGET = "10.0.0.2";
+static constexpr const char* LOCAL_ADDRESS = "10.0.0.1";
+
+// Caben varias ventanas de sondeos en vuelo antes de que el transmisor tenga que esperar al receptor
+static constexpr size_t FRAME_RING = 16384;
+
+static uint64_t splitmix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static void write_ip(u_char* data, uint32_t src, uint32_t dst, uint8_t protocol, uint16_t total) {
+    auto* ip_header = (struct ip*)data;
+    ip_header->ip_v = 4;
+    ip_header->ip_hl = 5;
+    ip_header->ip_ttl = 64;
+    ip_header->ip_p = protocol;
+    ip_header->ip_len = htons(total);
+    ip_header->ip_src.s_addr = src;
+    ip_header->ip_dst.s_addr = dst;
+}
+
+MockNet::MockNet(const AppConfig& config, const Model& model)
+    : model(model), frames(FRAME_RING) {
+    if (inet_pton(AF_INET, config.target_ip.c_str(), &target) != 1) inet_pton(AF_INET, DEFAULT_TARGET, &target);
+    inet_pton(AF_INET, LOCAL_ADDRESS, &local);
+}
+
+bool MockNet::open(size_t) {
+    return true;
+}
+
+MockNet::State MockNet::state(Protocol protocol, int port) const {
+    uint64_t h = splitmix(model.seed ^ ((uint64_t)protocol << 32) ^ (uint64_t)port);
+    double u = (double)(h >> 11) / (double)(1ULL << 53);
+    if (u < model.open) return State::OPEN;
+    if (u < model.open + model.filtered) return State::FILTERED;
+    return State::CLOSED;
+}
+
+PortStatus MockNet::expected(Protocol protocol, int port) const {
+    switch (state(protocol, port)) {
+        case State::OPEN: return PortStatus::OPEN;
+        case State::CLOSED: return PortStatus::CLOSED;
+        default: return protocol == Protocol::TCP ? PortStatus::FILTERED : PortStatus::OPEN_FILTERED;
+    }
+}
+
+void MockNet::reply(Frame& frame) {
+    // El transmisor no puede tirar respuestas: si el receptor va atrasado, espera
+    frames.push(std::move(frame));
+}
+
+bool MockNet::tcp_connect(int port, int64_t& sent_ns, int& local_port, PortStatus&) {
+    sent_ns = Timing::monotonic_ns();
+    local_port = 32768 + next_local_port++ % 28000; // Como ip_local_port_range
+    State s = state(Protocol::TCP, port);
+    if (s == State::FILTERED) return true;
+
+    Frame frame;
+    frame.len = sizeof(struct ip) + sizeof(struct tcphdr);
+    frame.captured_ns = sent_ns + model.rtt_ns;
+    write_ip(frame.data.data(), target, local, IPPROTO_TCP, frame.len);
+    auto* tcp_header = (struct tcphdr*)(frame.data.data() + sizeof(struct ip));
+    tcp_header->th_sport = htons(port);
+    tcp_header->th_dport = htons(local_port);
+    tcp_header->th_off = 5;
+    tcp_header->th_flags = s == State::OPEN ? (TH_SYN | TH_ACK) : (TH_RST | TH_ACK);
+    reply(frame);
+    return true;
+}
+
+bool MockNet::udp_send(int port, int64_t& sent_ns) {
+    sent_ns = Timing::monotonic_ns();
+    State s = state(Protocol::UDP, port);
+    if (s == State::FILTERED) return true;
+
+    Frame frame;
+    frame.captured_ns = sent_ns + model.rtt_ns;
+    u_char* data = frame.data.data();
+    if (s == State::OPEN) {
+        frame.len = sizeof(struct ip) + sizeof(struct udphdr);
+        write_ip(data, target, local, IPPROTO_UDP, frame.len);
+        auto* udp_header = (struct udphdr*)(data + sizeof(struct ip));
+        udp_header->uh_sport = htons(port);
+        udp_header->uh_dport = htons(UDP_LOCAL_PORT);
+        udp_header->uh_ulen = htons(sizeof(struct udphdr));
+    } else {
+        // ICMP port unreachable citando el datagrama original
+        frame.len = sizeof(struct ip) + 8 + sizeof(struct ip) + sizeof(struct udphdr);
+        write_ip(data, target, local, IPPROTO_ICMP, frame.len);
+        auto* icmp_header = (struct icmp*)(data + sizeof(struct ip));
+        icmp_header->icmp_type = ICMP_UNREACH;
+        icmp_header->icmp_code = ICMP_UNREACH_PORT;
+        u_char* quoted = data + sizeof(struct ip) + 8;
+        write_ip(quoted, local, target, IPPROTO_UDP, sizeof(struct ip) + sizeof(struct udphdr));
+        auto* udp_header = (struct udphdr*)(quoted + sizeof(struct ip));
+        udp_header->uh_sport = htons(UDP_LOCAL_PORT);
+        udp_header->uh_dport = htons(port);
+        udp_header->uh_ulen = htons(sizeof(struct udphdr));
+    }
+    reply(frame);
+    return true;
+}
+
+bool MockNet::wait_readable(int timeout_ms) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    unsigned spins = 0;
+    while (frames.empty()) {
+        if (std::chrono::steady_clock::now() >= until) return false;
+        SpscRing<Frame>::backoff(spins);
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#include "include/ndjson.h"
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace NDJSON {
+
+    static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(100);
+    static constexpr size_t FLUSH_BYTES = 1 << 20;
+    // Con el disco o el pipe más lentos que el escaneo, arriba de esto quien escribe espera al escritor
+    // en lugar de que el buffer crezca con cada resultado
+    static constexpr size_t MAX_BUFFER_BYTES = 4 * FLUSH_BYTES;
+
+    static int g_fd = -1;
+    static bool g_stdout = false;
+    static std::mutex g_mutex;
+    static std::condition_variable g_cv;
+    static std::condition_variable g_room;
+    static size_t g_waiters = 0;
+    static std::string g_buffer;
+    static bool g_stop = false;
+    static std::thread g_writer;
+
+    static void write_all(const std::string& data) {
+        const char* ptr = data.data();
+        size_t left = data.size();
+        while (left > 0) {
+            ssize_t n = ::write(g_fd, ptr, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                perror("Error al escribir NDJSON");
+                return;
+            }
+            ptr += n;
+            left -= (size_t)n;
+        }
+    }
+
+    // Doble buffer: se intercambia con el lock tomado y se escribe sin él
+    static void writer_loop() {
+        std::string pending;
+        pending.reserve(FLUSH_BYTES);
+        std::unique_lock<std::mutex> lock(g_mutex);
+        while (true) {
+            g_cv.wait_for(lock, FLUSH_INTERVAL, [] { return g_stop || g_buffer.size() >= FLUSH_BYTES; });
+            bool stopping = g_stop;
+            pending.swap(g_buffer);
+            if (g_waiters > 0) g_room.notify_all();
+            lock.unlock();
+            if (!pending.empty()) write_all(pending);
+            pending.clear();
+            lock.lock();
+            if (stopping && g_buffer.empty()) break;
+        }
+    }
+
+    bool open(const std::string& path) {
+        g_stdout = (path == "-");
+        g_fd = g_stdout ? STDOUT_FILENO : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (g_fd < 0) {
+            perror(("Error al abrir " + path).c_str());
+            return false;
+        }
+        g_buffer.reserve(FLUSH_BYTES);
+        g_stop = false;
+        g_writer = std::thread(writer_loop);
+        return true;
+    }
+
+    bool active() {
+        return g_fd >= 0;
+    }
+
+    bool to_stdout() {
+        return g_stdout;
+    }
+
+    void write_line(const std::string& line) {
+        bool wake;
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            if (g_buffer.size() >= MAX_BUFFER_BYTES) {
+                ++g_waiters;
+                g_cv.notify_one(); // Por si el escritor todavía no se enteró
+                g_room.wait(lock, [] { return g_buffer.size() < MAX_BUFFER_BYTES; });
+                --g_waiters;
+            }
+            g_buffer += line;
+            g_buffer += '\n';
+            wake = g_buffer.size() >= FLUSH_BYTES;
+        }
+        if (wake) g_cv.notify_one();
+    }
+
+    void close() {
+        if (g_fd < 0) return;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_stop = true;
+        }
+        g_cv.notify_one();
+        g_writer.join();
+        if (!g_stdout) ::close(g_fd);
+        g_fd = -1;
+    }
+
+}
@@ -0,0 +1,133 @@
+#include "include/net_io.h"
+#include "include/shutdown.h"
+#include "include/trace.h"
+#include <iostream>
+#include <thread>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+static int local_port_of(int fd) {
+    sockaddr_in local{};
+    socklen_t len = sizeof(local);
+    if (getsockname(fd, (struct sockaddr*)&local, &len) < 0) return -1;
+    return ntohs(local.sin_port);
+}
+
+SocketNet::~SocketNet() {
+    for (auto& [fd, close_at] : open_fds) close(fd);
+    if (udp_fd >= 0) close(udp_fd);
+    if (handle) pcap_close(handle);
+}
+
+bool SocketNet::open(size_t max_open) {
+    max_open_sockets = max_open;
+    target.sin_family = AF_INET;
+    if (inet_pton(AF_INET, config.target_ip.c_str(), &target.sin_addr) != 1) {
+        std::cerr << "Pipeline: el objetivo debe ser una IPv4 (" << config.target_ip << ")" << std::endl;
+        return false;
+    }
+
+    udp_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in any{};
+    any.sin_family = AF_INET;
+    if (udp_fd < 0 || bind(udp_fd, (struct sockaddr*)&any, sizeof(any)) < 0) {
+        perror("Error al crear socket UDP");
+        return false;
+    }
+    udp_port = local_port_of(udp_fd);
+
+    // Igual que en el reactor: si el objetivo es esta máquina puede haber auto-conexiones TCP
+    int probe_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sockaddr_in self = target;
+    self.sin_port = 0;
+    is_local_target = probe_fd >= 0 && bind(probe_fd, (struct sockaddr*)&self, sizeof(self)) == 0;
+    if (probe_fd >= 0) close(probe_fd);
+
+    // Aquí no hay connect() que esperar, TODO el resultado sale de la captura
+    handle = Sniffer::open_host_capture(config.interface, config.target_ip);
+    if (!handle) {
+        std::cerr << "Pipeline: no se pudo abrir la captura en " << config.interface
+                  << " (este motor la necesita)" << std::endl;
+        return false;
+    }
+    link_offset = Sniffer::link_layer_offset(pcap_datalink(handle));
+    nano_timestamps = Sniffer::nano_timestamps(handle);
+    return true;
+}
+
+void SocketNet::close_expired(Clock::time_point now) {
+    while (!open_fds.empty() && open_fds.front().second <= now) {
+        close(open_fds.front().first);
+        open_fds.pop_front();
+    }
+}
+
+bool SocketNet::tcp_connect(int port, int64_t& sent_ns, int& local_port, PortStatus& fallback) {
+    // Los sockets viven hasta su timeout aunque el sondeo ya tenga respuesta, así que también se
+    // limitan aparte con el mismo tope que la ventana
+    if (open_fds.size() >= max_open_sockets) std::this_thread::sleep_until(open_fds.front().second);
+    close_expired(Clock::now());
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    Trace::event(Trace::Event::SOCKET, Protocol::TCP, port);
+
+    sockaddr_in addr = target;
+    addr.sin_port = htons(port);
+    sent_ns = Timing::monotonic_ns();
+    int rc = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+    int connect_errno = rc < 0 ? errno : 0;
+    local_port = local_port_of(fd);
+    // Si connect() ya sabe la respuesta (típico en loopback) esa es la de respaldo. Solo ECONNREFUSED
+    // viene del objetivo; cualquier otro error es local (sin puertos efímeros, sin ruta...) y no dice
+    // nada del puerto, igual que sin socket
+    if (rc == 0) fallback = PortStatus::OPEN;
+    else if (connect_errno == ECONNREFUSED) fallback = PortStatus::CLOSED;
+    else if (connect_errno != EINPROGRESS) fallback = PortStatus::UNKNOWN;
+    // Auto-conexión (el puerto efímero salió igual al destino): el puerto en realidad está cerrado y lo
+    // que se capture es nuestro propio handshake, así que no se empareja nada
+    if (is_local_target && local_port == port) {
+        fallback = PortStatus::CLOSED;
+        local_port = -1;
+    }
+    open_fds.emplace_back(fd, Clock::now() + std::chrono::milliseconds(config.timeout_ms));
+    return true;
+}
+
+bool SocketNet::udp_send(int port, int64_t& sent_ns) {
+    sockaddr_in addr = target;
+    addr.sin_port = htons(port);
+    // Payload vacío, igual que Scanner::sendUDPProbe
+    sent_ns = Timing::monotonic_ns();
+    while (sendto(udp_fd, "", 0, 0, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (errno != EAGAIN && errno != ENOBUFS) {
+            perror("Error en sendto() al enviar paquete UDP");
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        sent_ns = Timing::monotonic_ns();
+    }
+    return true;
+}
+
+void SocketNet::expire() {
+    close_expired(Clock::now());
+}
+
+// Los sockets restantes se cierran hasta que venzan, si no el kernel cortaría handshakes en curso
+// (con una interrupción se espera como mucho hasta el fin de la gracia)
+void SocketNet::drain() {
+    for (auto& [fd, close_at] : open_fds) {
+        std::this_thread::sleep_until(std::min(close_at, Shutdown::deadline()));
+        close(fd);
+    }
+    open_fds.clear();
+}
+
+bool SocketNet::wait_readable(int timeout_ms) {
+    pollfd pfd{pcap_get_selectable_fd(handle), POLLIN, 0};
+    return poll(&pfd, 1, timeout_ms) > 0;
+}
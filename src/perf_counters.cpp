@@ -0,0 +1,267 @@
+#include "include/perf_counters.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <array>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace PerfCounters {
+
+    enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, CONTEXT_SWITCHES, COUNTERS };
+
+    struct CounterSpec {
+        uint32_t type;
+        uint64_t config;
+        const char* label;
+    };
+    static constexpr CounterSpec SPECS[] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "ciclos"},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instrucciones"},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "fallos de caché"},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "fallos de salto"},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "cambios de contexto"},
+    };
+    static_assert(std::size(SPECS) == COUNTERS);
+
+    static constexpr size_t PHASES = static_cast<size_t>(Phase::COUNT);
+    static constexpr const char* LABELS[] = {"envío", "recepción", "clasificación", "salida"};
+    static_assert(std::size(LABELS) == PHASES);
+
+    // Más anidado que esto no hay en ningún motor (recepción > clasificación es lo más hondo)
+    static constexpr int MAX_DEPTH = 4;
+
+    using Values = std::array<uint64_t, COUNTERS>;
+
+    struct Totals {
+        std::array<Values, PHASES> values{};
+        std::array<uint64_t, PHASES> calls{};
+        bool multiplexed = false;
+
+        void add(const Totals& other) {
+            for (size_t p = 0; p < PHASES; ++p) {
+                for (size_t c = 0; c < COUNTERS; ++c) values[p][c] += other.values[p][c];
+                calls[p] += other.calls[p];
+            }
+            multiplexed |= other.multiplexed;
+        }
+    };
+
+    static bool g_enabled = false;
+    static std::array<bool, COUNTERS> g_available{};
+
+    // Lo de los hilos que ya terminaron se suma aquí; los vivos se leen al imprimir
+    static std::mutex g_mutex;
+    static Totals g_retired;
+    static std::vector<const Totals*> g_live;
+
+    static int open_counter(const CounterSpec& spec, int group_fd) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = spec.type;
+        attr.config = spec.config;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+        // Sin privilegios (perf_event_paranoid >= 2) solo se deja medir user space
+        if (fd < 0 && errno == EACCES) {
+            attr.exclude_kernel = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+        }
+        return fd;
+    }
+
+    // Un grupo por hilo: todos los contadores se programan juntos y salen en un solo read()
+    class ThreadGroup {
+    public:
+        ThreadGroup() {
+            position.fill(-1);
+            for (size_t c = 0; c < COUNTERS; ++c) {
+                int fd = open_counter(SPECS[c], leader);
+                if (fd < 0) continue;
+                if (leader < 0) leader = fd;
+                position[c] = static_cast<int>(fds.size());
+                fds.push_back(fd);
+            }
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_live.push_back(&totals);
+        }
+
+        ~ThreadGroup() {
+            for (int fd : fds) close(fd);
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_retired.add(totals);
+            g_live.erase(std::find(g_live.begin(), g_live.end(), &totals));
+        }
+
+        ThreadGroup(const ThreadGroup&) = delete;
+        ThreadGroup& operator=(const ThreadGroup&) = delete;
+
+        bool available(size_t counter) const { return position[counter] >= 0; }
+
+        // Lo que corrió desde la última lectura es de la fase de hasta arriba de la pila, así la de
+        // afuera no se queda con lo de la anidada
+        void enter(Phase phase) {
+            if (leader < 0) return;
+            if (depth == MAX_DEPTH) {
+                ++skipped;
+                return;
+            }
+            Values now = read_values();
+            if (depth > 0) charge(stack[depth - 1], now);
+            stack[depth++] = phase;
+            ++totals.calls[static_cast<size_t>(phase)];
+            last = now;
+        }
+
+        void leave() {
+            if (leader < 0) return;
+            if (skipped > 0) {
+                --skipped;
+                return;
+            }
+            if (depth == 0) return;
+            Values now = read_values();
+            charge(stack[--depth], now);
+            last = now;
+        }
+
+    private:
+        // Si falla la lectura se repite la anterior, el tramo queda en 0. No toca errno: el tramo suele
+        // cerrar justo después de un connect()/sendto() cuyo error todavía se va a consultar
+        Values read_values() {
+            int saved_errno = errno;
+            struct {
+                uint64_t nr;
+                uint64_t time_enabled;
+                uint64_t time_running;
+                uint64_t values[COUNTERS];
+            } buffer{};
+            ssize_t n = read(leader, &buffer, sizeof(buffer));
+            errno = saved_errno;
+            if (n < 0) return last;
+            // Menos tiempo corriendo que habilitado: el kernel los compartió con otros eventos
+            if (buffer.time_running < buffer.time_enabled) totals.multiplexed = true;
+            Values values{};
+            for (size_t c = 0; c < COUNTERS; ++c) {
+                if (position[c] >= 0 && static_cast<uint64_t>(position[c]) < buffer.nr) values[c] = buffer.values[position[c]];
+            }
+            return values;
+        }
+
+        void charge(Phase phase, const Values& now) {
+            Values& into = totals.values[static_cast<size_t>(phase)];
+            for (size_t c = 0; c < COUNTERS; ++c) {
+                if (now[c] > last[c]) into[c] += now[c] - last[c];
+            }
+        }
+
+        int leader = -1;
+        std::vector<int> fds;
+        std::array<int, COUNTERS> position{};
+        Values last{};
+        std::array<Phase, MAX_DEPTH> stack{};
+        int depth = 0;
+        int skipped = 0;
+        Totals totals;
+    };
+
+    // Se construye con la primera fase del hilo y se destruye cuando el hilo termina
+    static ThreadGroup& local_group() {
+        thread_local ThreadGroup group;
+        return group;
+    }
+
+    bool enable() {
+        ThreadGroup& group = local_group();
+        std::string missing;
+        bool any = false;
+        for (size_t c = 0; c < COUNTERS; ++c) {
+            g_available[c] = group.available(c);
+            any |= g_available[c];
+            if (!g_available[c]) missing += std::string(missing.empty() ? "" : ", ") + SPECS[c].label;
+        }
+        if (!any) {
+            std::cerr << "No se pudo abrir ningún contador con perf_event_open (revisa /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+            return false;
+        }
+        if (!missing.empty()) std::cout << "Contadores no disponibles en este equipo: " << missing << std::endl;
+        g_enabled = true;
+        return true;
+    }
+
+    bool enabled() {
+        return g_enabled;
+    }
+
+    void enter(Phase phase) {
+        local_group().enter(phase);
+    }
+
+    void leave() {
+        local_group().leave();
+    }
+
+    // El ancho se cuenta en caracteres, no en bytes (las etiquetas llevan acentos)
+    static std::string pad(const std::string& text, size_t width) {
+        size_t chars = 0;
+        for (unsigned char c : text) chars += (c & 0xC0) != 0x80;
+        return text + std::string(chars < width ? width - chars : 1, ' ');
+    }
+
+    static std::string per_probe(uint64_t total, uint64_t probes, bool available) {
+        if (!available) return "n/d";
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) << static_cast<double>(total) / static_cast<double>(probes);
+        return text.str();
+    }
+
+    void print(uint64_t probes_sent) {
+        if (!g_enabled || probes_sent == 0) return;
+        Totals totals;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            totals = g_retired;
+            for (const Totals* live : g_live) totals.add(*live);
+        }
+
+        std::cout << "\nContadores por sondeo (" << probes_sent << " sondeos enviados)" << std::endl;
+        std::cout << "FASE            llamadas      ciclos    instrucc.   IPC   f. caché   f. salto  cambios ctx" << std::endl;
+        auto row = [&](const std::string& label, uint64_t calls, const Values& values) {
+            std::string ipc = "n/d";
+            if (g_available[CYCLES] && g_available[INSTRUCTIONS] && values[CYCLES] > 0) {
+                std::ostringstream text;
+                text << std::fixed << std::setprecision(2) << static_cast<double>(values[INSTRUCTIONS]) / static_cast<double>(values[CYCLES]);
+                ipc = text.str();
+            }
+            std::cout << pad(label, 14) << std::right << std::setw(10) << calls
+                      << std::setw(12) << per_probe(values[CYCLES], probes_sent, g_available[CYCLES])
+                      << std::setw(13) << per_probe(values[INSTRUCTIONS], probes_sent, g_available[INSTRUCTIONS])
+                      << std::setw(6) << ipc
+                      << std::setw(11) << per_probe(values[CACHE_MISSES], probes_sent, g_available[CACHE_MISSES])
+                      << std::setw(11) << per_probe(values[BRANCH_MISSES], probes_sent, g_available[BRANCH_MISSES])
+                      << std::setw(13) << per_probe(values[CONTEXT_SWITCHES], probes_sent, g_available[CONTEXT_SWITCHES])
+                      << std::endl;
+        };
+
+        Values sum{};
+        uint64_t calls = 0;
+        for (size_t p = 0; p < PHASES; ++p) {
+            if (totals.calls[p] == 0) continue;
+            row(LABELS[p], totals.calls[p], totals.values[p]);
+            for (size_t c = 0; c < COUNTERS; ++c) sum[c] += totals.values[p][c];
+            calls += totals.calls[p];
+        }
+        row("total", calls, sum);
+        if (totals.multiplexed) {
+            std::cout << "(Los contadores se compartieron con otros eventos de perf, los valores son aproximados)" << std::endl;
+        }
+    }
+
+}
@@ -0,0 +1,205 @@
+#include "include/phases.h"
+#include "include/json_writer.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+
+namespace Phases {
+
+    // Cubetas: 0..63 exactas y de ahí 32 por potencia de 2 hasta 2^38 ns (~4.5 min), lo de más arriba
+    // cae en la última
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr uint64_t LINEAR = 2 * SUB_BUCKETS;
+    static constexpr int MAX_EXPONENT = 38;
+    static constexpr size_t BUCKETS = LINEAR + (MAX_EXPONENT - SUB_BITS) * SUB_BUCKETS;
+
+    static constexpr const char* NAMES[] = {
+        "capture_open", "pre_probe", "connect", "send", "wait_response",
+        "capture_close", "probe", "rtt", "output", "report",
+    };
+    static constexpr const char* LABELS[] = {
+        "abrir captura", "pausa previa", "connect", "sendto", "esperar respuesta",
+        "cerrar captura", "sondeo completo", "RTT", "salida", "reporte",
+    };
+    static_assert(std::size(NAMES) == static_cast<size_t>(Phase::COUNT));
+    static_assert(std::size(LABELS) == static_cast<size_t>(Phase::COUNT));
+
+    struct Histogram {
+        std::array<uint32_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t min = UINT64_MAX;
+        uint64_t max = 0;
+    };
+
+    // Lo de un hilo. Se reserva cada fase la primera vez que se usa: un worker del motor de hilos
+    // toca siete, el transmisor del pipeline dos
+    struct ThreadHistograms {
+        std::array<std::unique_ptr<Histogram>, static_cast<size_t>(Phase::COUNT)> phases;
+    };
+
+    static bool g_enabled = false;
+
+    // Los histogramas son del registro, no del hilo, así sobreviven a que el hilo termine
+    static std::mutex g_registry_mutex;
+    static std::vector<std::unique_ptr<ThreadHistograms>> g_registry;
+    static thread_local ThreadHistograms* t_histograms = nullptr;
+
+    static size_t bucket_of(uint64_t ns) {
+        if (ns < LINEAR) return ns;
+        int exponent = std::min(63 - __builtin_clzll(ns), MAX_EXPONENT);
+        if (exponent == MAX_EXPONENT && (ns >> MAX_EXPONENT) > 1) return BUCKETS - 1;
+        int shift = exponent - SUB_BITS;
+        uint64_t sub = (ns >> shift) - SUB_BUCKETS;
+        return LINEAR + (exponent - SUB_BITS - 1) * SUB_BUCKETS + sub;
+    }
+
+    // El punto medio de la cubeta
+    static uint64_t value_of(size_t bucket) {
+        if (bucket < LINEAR) return bucket;
+        size_t k = bucket - LINEAR;
+        int shift = static_cast<int>(k / SUB_BUCKETS) + 1;
+        uint64_t lower = (SUB_BUCKETS + k % SUB_BUCKETS) << shift;
+        return lower + (uint64_t{1} << shift) / 2;
+    }
+
+    void enable() {
+        g_enabled = true;
+    }
+
+    bool enabled() {
+        return g_enabled;
+    }
+
+    void record(Phase phase, uint64_t ns) {
+        if (!g_enabled) return;
+        if (!t_histograms) {
+            auto owned = std::make_unique<ThreadHistograms>();
+            t_histograms = owned.get();
+            std::lock_guard<std::mutex> lock(g_registry_mutex);
+            g_registry.push_back(std::move(owned));
+        }
+        auto& histogram = t_histograms->phases[static_cast<size_t>(phase)];
+        if (!histogram) histogram = std::make_unique<Histogram>();
+        ++histogram->counts[bucket_of(ns)];
+        ++histogram->count;
+        histogram->sum += ns;
+        histogram->min = std::min(histogram->min, ns);
+        histogram->max = std::max(histogram->max, ns);
+    }
+
+    std::vector<Percentiles> summary() {
+        std::vector<Percentiles> result;
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        for (size_t p = 0; p < static_cast<size_t>(Phase::COUNT); ++p) {
+            std::vector<uint64_t> merged(BUCKETS);
+            Percentiles phase;
+            phase.phase = static_cast<Phase>(p);
+            phase.name = NAMES[p];
+            phase.min_ns = UINT64_MAX;
+            uint64_t sum = 0;
+            for (const auto& thread : g_registry) {
+                const Histogram* histogram = thread->phases[p].get();
+                if (!histogram) continue;
+                for (size_t b = 0; b < BUCKETS; ++b) merged[b] += histogram->counts[b];
+                phase.count += histogram->count;
+                sum += histogram->sum;
+                phase.min_ns = std::min(phase.min_ns, histogram->min);
+                phase.max_ns = std::max(phase.max_ns, histogram->max);
+            }
+            if (phase.count == 0) continue;
+            phase.mean_ns = sum / phase.count;
+
+            // Rango más cercano, igual que el RTT de ScanStats, y sin salirse de los extremos exactos
+            auto rank = [&](double q) {
+                uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * phase.count)));
+                uint64_t seen = 0;
+                for (size_t b = 0; b < BUCKETS; ++b) {
+                    seen += merged[b];
+                    if (seen >= target) return std::clamp(value_of(b), phase.min_ns, phase.max_ns);
+                }
+                return phase.max_ns;
+            };
+            phase.p50_ns = rank(0.5);
+            phase.p90_ns = rank(0.9);
+            phase.p99_ns = rank(0.99);
+            phase.p999_ns = rank(0.999);
+            result.push_back(phase);
+        }
+        return result;
+    }
+
+    static std::string format_ns(uint64_t ns) {
+        std::ostringstream out;
+        out << std::fixed;
+        if (ns < 1000) out << ns << " ns";
+        else if (ns < 1000000) out << std::setprecision(1) << ns / 1e3 << " µs";
+        else if (ns < 1000000000) out << std::setprecision(2) << ns / 1e6 << " ms";
+        else out << std::setprecision(2) << ns / 1e9 << " s";
+        return out.str();
+    }
+
+    void print(const std::vector<Percentiles>& phases) {
+        if (phases.empty()) return;
+        std::cout << "\nFASE                     N       mín       p50       p90       p99     p99.9       máx" << std::endl;
+        for (const Percentiles& phase : phases) {
+            // El ancho se cuenta en bytes y "µs" tiene uno de más
+            auto column = [](uint64_t ns) {
+                std::string text = format_ns(ns);
+                size_t width = text.find("µ") != std::string::npos ? 11 : 10;
+                return std::string(text.size() < width ? width - text.size() : 1, ' ') + text;
+            };
+            std::cout << std::left << std::setw(18) << LABELS[static_cast<size_t>(phase.phase)] << std::right << std::setw(8) << phase.count
+                      << column(phase.min_ns) << column(phase.p50_ns) << column(phase.p90_ns)
+                      << column(phase.p99_ns) << column(phase.p999_ns) << column(phase.max_ns) << std::endl;
+        }
+    }
+
+    bool write_json(const std::string& path, const std::vector<Percentiles>& phases) {
+        JsonWriter writer(4);
+        writer.begin_object();
+        writer.key("phases");
+        writer.begin_array();
+        for (const Percentiles& phase : phases) {
+            writer.begin_object();
+            writer.key("count");
+            writer.value(phase.count);
+            writer.key("max_ns");
+            writer.value(phase.max_ns);
+            writer.key("mean_ns");
+            writer.value(phase.mean_ns);
+            writer.key("min_ns");
+            writer.value(phase.min_ns);
+            writer.key("p50_ns");
+            writer.value(phase.p50_ns);
+            writer.key("p90_ns");
+            writer.value(phase.p90_ns);
+            writer.key("p999_ns");
+            writer.value(phase.p999_ns);
+            writer.key("p99_ns");
+            writer.value(phase.p99_ns);
+            writer.key("phase");
+            writer.value(phase.name);
+            writer.end_object();
+        }
+        writer.end_array();
+        writer.end_object();
+        writer.newline();
+
+        std::ofstream o(path, std::ios::binary);
+        o.write(writer.buffer().data(), static_cast<std::streamsize>(writer.size()));
+        if (!o) {
+            std::cerr << "Error al escribir " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+}
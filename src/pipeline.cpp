@@ -0,0 +1,574 @@
+#include "include/pipeline.h"
+#include "include/net_io.h"
+#include "include/spsc_ring.h"
+#include "include/sniffer.h"
+#include "include/stats.h"
+#include "include/affinity.h"
+#include "include/scheduler.h"
+#include "include/window.h"
+#include "include/shutdown.h"
+#include "include/result_sink.h"
+#include "include/live_output.h"
+#include "include/utils.h"
+#include "include/timing.h"
+#include "include/phases.h"
+#include "include/metrics.h"
+#include "include/trace.h"
+#include "include/usdt.h"
+#include "include/perf_counters.h"
+#ifdef ESCANER_MOCK_NET
+#include "include/mock_net.h"
+#endif
+#include <iostream>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+namespace Pipeline {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Tamaño de los lotes que viajan entre etapas y cuántos lotes caben en cada cola
+    static constexpr size_t BATCH_SIZE = 64;
+    static constexpr size_t RING_BATCHES = 256;
+
+    // Cada cuánto se revisa Shutdown mientras el generador espera lugar en la tabla en vivo
+    static constexpr auto ROOM_WAIT = std::chrono::milliseconds(50);
+
+    // Bytes que se copian de cada paquete capturado, alcanza para IP + ICMP + IP/UDP originales con opciones
+    static constexpr size_t PACKET_BYTES = 192;
+
+    // Una respuesta puede llegar al clasificador antes que el registro de su sondeo (van por colas distintas)
+    // Se guarda un rato por si el registro viene en camino
+    static constexpr auto ORPHAN_TTL = std::chrono::milliseconds(200);
+    static constexpr size_t MAX_ORPHANS = 4096;
+
+    // El transmisor no se queda con registros de sondeos ya enviados más que esto (muy por debajo de
+    // ORPHAN_TTL): si la respuesta llega antes que el registro, el huérfano todavía lo alcanza
+    static constexpr auto SENT_FLUSH_AGE = std::chrono::milliseconds(5);
+
+    static constexpr auto STATS_INTERVAL = std::chrono::seconds(1);
+
+    // Transmisor -> clasificador: qué se mandó, desde qué puerto local y cuándo
+    struct SentProbe {
+        ScanTask task{};
+        int local_port = -1;
+        Clock::time_point sent;
+        int64_t sent_ns = 0; // Justo antes de connect()/sendto(), para el RTT
+        // Lo que se reporta si no llega nada en la captura antes del timeout
+        PortStatus fallback = PortStatus::FILTERED;
+    };
+
+    // Receptor -> clasificador: copia de los primeros bytes del paquete (el buffer de pcap no sobrevive al callback)
+    struct CapturedPacket {
+        uint32_t caplen = 0;
+        uint32_t len = 0;
+        Clock::time_point arrival;
+        int64_t captured_ns = 0; // Timestamp de pcap en reloj monotónico
+        std::array<u_char, PACKET_BYTES> data;
+    };
+
+    template <typename T>
+    using Batch = std::vector<T>;
+
+    static inline uint32_t flow_key(Protocol protocol, int port) {
+        return ((uint32_t)protocol << 16) | (uint32_t)port;
+    }
+
+    // La red (sockets + pcap, o el mock) es un parámetro de la plantilla, ver net_io.h
+    template <PipelineNet Net>
+    class PipelineScan {
+    public:
+        PipelineScan(const AppConfig& cfg, Net& net)
+            : config(cfg), net(net),
+              task_ring(RING_BATCHES), sent_ring(RING_BATCHES), packet_ring(RING_BATCHES), result_ring(RING_BATCHES),
+              window(cfg.max_inflight) {}
+
+        bool setup();
+        std::vector<ScanResult> run();
+
+    private:
+        void generator_stage();
+        void transmitter_stage();
+        void receiver_stage();
+        void matcher_stage();
+        void sink_stage();
+
+        const AppConfig& config;
+        Net& net;
+        uint32_t target_addr = 0;
+        int udp_local_port = -1;
+        int link_layer_offset = 14;
+        std::atomic<uint64_t> ignored{0};
+
+        SpscRing<Batch<ScanTask>> task_ring;         // generador -> transmisor
+        SpscRing<Batch<SentProbe>> sent_ring;        // transmisor -> clasificador
+        SpscRing<Batch<CapturedPacket>> packet_ring; // receptor -> clasificador
+        SpscRing<Batch<ScanResult>> result_ring;     // clasificador -> sumidero
+
+        // Sondeos enviados y sin resultado: el transmisor toma un lugar por sondeo y el clasificador
+        // lo devuelve al resolverlo. Con la ventana llena el transmisor se frena, las colas de tareas
+        // se llenan y el generador se frena también
+        InflightWindow window;
+
+        std::atomic<bool> generator_done{false};
+        std::atomic<bool> transmitter_done{false};
+        std::atomic<bool> matcher_done{false};
+
+        std::vector<ScanResult> results;
+    };
+
+    template <PipelineNet Net>
+    bool PipelineScan<Net>::setup() {
+        if (!net.open(window.limit())) return false;
+        target_addr = net.target_addr();
+        udp_local_port = net.udp_local_port();
+        link_layer_offset = net.link_layer_offset();
+        return true;
+    }
+
+    // Etapa 1: genera lotes de tareas (puerto x protocolo) a medida que hay lugar en la cola
+    template <PipelineNet Net>
+    void PipelineScan<Net>::generator_stage() {
+        Affinity::pin_current_thread(Affinity::Role::TX);
+        Trace::name_thread("pipeline: generador");
+        TaskGenerator generator(config);
+        while (!Shutdown::requested()) {
+            // No más de la ventana por delante de la tabla en vivo, si no lo que termina detrás de un sondeo
+            // lento se acumula ahí
+            size_t room = LiveOutput::wait_for_room(generator.emitted(), window.limit(), ROOM_WAIT);
+            if (room == 0) continue;
+            Batch<ScanTask> batch;
+            batch.reserve(BATCH_SIZE);
+            if (generator.next_batch(batch, std::min(BATCH_SIZE, room)) == 0) break;
+            task_ring.push(std::move(batch)); // Bloquea si el transmisor va atrasado
+        }
+        Shutdown::set_position(generator.emitted(), generator.total());
+        generator_done.store(true, std::memory_order_release);
+    }
+
+    // Etapa 2: solo manda sondeos. Los connect() se quedan en vuelo (el kernel hace el handshake) y se
+    // cierran cuando vence su timeout; quien decide el resultado es el clasificador con la captura
+    template <PipelineNet Net>
+    void PipelineScan<Net>::transmitter_stage() {
+        Affinity::pin_current_thread(Affinity::Role::TX);
+        Trace::name_thread("pipeline: transmisor");
+        Batch<ScanTask> tasks;
+        unsigned spins = 0;
+        while (true) {
+            if (!task_ring.try_pop(tasks)) {
+                if (generator_done.load(std::memory_order_acquire) && task_ring.empty()) break;
+                net.expire();
+                SpscRing<Batch<ScanTask>>::backoff(spins);
+                continue;
+            }
+            spins = 0;
+
+            Batch<SentProbe> sent;
+            sent.reserve(tasks.size());
+            // Lo ya enviado pasa al clasificador antes de cualquier espera, si no sus respuestas se
+            // quedarían huérfanas hasta vencer y el puerto saldría filtrado
+            auto flush_sent = [&] {
+                if (sent.empty()) return;
+                sent_ring.push(std::move(sent));
+                sent = Batch<SentProbe>();
+                sent.reserve(tasks.size());
+            };
+            for (size_t i = 0; i < tasks.size(); ++i) {
+                const ScanTask& task = tasks[i];
+                // Interrumpido: lo que queda en el lote (y en la cola) ya no sale
+                if (Shutdown::requested()) {
+                    Shutdown::abandoned(std::vector<ScanTask>(tasks.begin() + i, tasks.end()));
+                    break;
+                }
+                auto pacing = ScanStats::pacing_delay();
+                if (pacing.count() > 0) {
+                    flush_sent();
+                    std::this_thread::sleep_for(pacing);
+                }
+
+                SentProbe probe;
+                probe.task = task;
+
+                // Con la ventana llena primero se manda lo que ya salió, si no el clasificador nunca
+                // vería esos sondeos y nunca devolvería lugares
+                if (!window.try_acquire()) {
+                    flush_sent();
+                    window.acquire();
+                    // Mientras se esperaba pudo llegar la señal
+                    if (Shutdown::requested()) {
+                        window.release();
+                        Shutdown::abandoned(std::vector<ScanTask>(tasks.begin() + i, tasks.end()));
+                        break;
+                    }
+                }
+                Trace::event(Trace::Event::DEQUEUED, task.protocol, task.port);
+                if (task.protocol == Protocol::TCP) {
+                    if (net.tcp_connect_waits()) flush_sent();
+                    int64_t connect_start = Phases::now();
+                    bool connected;
+                    {
+                        PerfCounters::Scope send(PerfCounters::Phase::SEND);
+                        connected = net.tcp_connect(task.port, probe.sent_ns, probe.local_port, probe.fallback);
+                    }
+                    Phases::record_since(Phases::Phase::CONNECT, connect_start);
+                    if (connected) {
+                        Trace::event_at(Trace::Event::SENT, task.protocol, task.port, probe.sent_ns);
+                        Usdt::probe_sent(task.port, task.protocol, probe.sent_ns);
+                        ScanStats::probe_sent();
+                    } else {
+                        probe.fallback = PortStatus::UNKNOWN; // Igual que Scanner::scanTCP sin socket
+                    }
+                } else {
+                    int64_t send_start = Phases::now();
+                    bool sent_ok;
+                    {
+                        PerfCounters::Scope send(PerfCounters::Phase::SEND);
+                        sent_ok = net.udp_send(task.port, probe.sent_ns);
+                    }
+                    Phases::record_since(Phases::Phase::SEND, send_start);
+                    if (!sent_ok) {
+                        // Igual que el motor de hilos, si el envío falla no se reporta nada
+                        ResultSink::discard(task);
+                        window.release();
+                        continue;
+                    }
+                    Trace::event_at(Trace::Event::SENT, task.protocol, task.port, probe.sent_ns);
+                    Usdt::probe_sent(task.port, task.protocol, probe.sent_ns);
+                    probe.local_port = udp_local_port;
+                    probe.fallback = PortStatus::OPEN_FILTERED;
+                    ScanStats::probe_sent();
+                }
+                probe.sent = Clock::now();
+                sent.push_back(probe);
+                // Un envío que tardó (sendto con el buffer lleno, un lote lento) tampoco retiene a los demás
+                if (probe.sent - sent.front().sent >= SENT_FLUSH_AGE) flush_sent();
+            }
+            if (!sent.empty()) sent_ring.push(std::move(sent));
+        }
+
+        transmitter_done.store(true, std::memory_order_release);
+        net.drain();
+    }
+
+    // Etapa 3: vacía la captura lo más rápido posible y pasa copias en lotes
+    template <PipelineNet Net>
+    void PipelineScan<Net>::receiver_stage() {
+        Affinity::pin_current_thread(Affinity::Role::RX);
+        Trace::name_thread("pipeline: receptor");
+        auto next_sample = Clock::now() + STATS_INTERVAL;
+
+        Batch<CapturedPacket> capture_batch;
+        auto on_packet = [&](const u_char* data, uint32_t caplen, uint32_t len, int64_t captured_ns) {
+            CapturedPacket& copy = capture_batch.emplace_back();
+            copy.caplen = std::min<uint32_t>(caplen, PACKET_BYTES);
+            copy.len = len;
+            copy.arrival = Clock::now();
+            copy.captured_ns = captured_ns;
+            std::memcpy(copy.data.data(), data, copy.caplen);
+        };
+
+        while (!matcher_done.load(std::memory_order_acquire)) {
+            if (net.wait_readable(10)) {
+                capture_batch.reserve(BATCH_SIZE);
+                {
+                    PerfCounters::Scope receive(PerfCounters::Phase::RECEIVE);
+                    net.dispatch(BATCH_SIZE, on_packet);
+                }
+                if (!capture_batch.empty()) {
+                    // Si el clasificador ya terminó nadie va a vaciar la cola, así que no se bloquea
+                    unsigned spins = 0;
+                    while (!packet_ring.try_push(std::move(capture_batch))) {
+                        if (matcher_done.load(std::memory_order_acquire)) break;
+                        SpscRing<Batch<CapturedPacket>>::backoff(spins);
+                    }
+                    capture_batch = Batch<CapturedPacket>();
+                }
+            }
+            if (Clock::now() >= next_sample) {
+                net.sample(ignored.load(std::memory_order_relaxed));
+                next_sample = Clock::now() + STATS_INTERVAL;
+            }
+        }
+        net.sample(ignored.load(std::memory_order_relaxed));
+    }
+
+    // Etapa 4: junta sondeos enviados con respuestas capturadas, clasifica y vence timeouts
+    template <PipelineNet Net>
+    void PipelineScan<Net>::matcher_stage() {
+        // Las tablas de flujos se reservan aquí abajo, después de fijar el hilo, así quedan en su nodo
+        Affinity::pin_current_thread(Affinity::Role::WORKER, 0);
+        Trace::name_thread("pipeline: clasificador");
+        struct Flow {
+            bool active = false;
+            int local_port = -1;
+            int64_t sent_ns = 0;
+            PortStatus fallback = PortStatus::FILTERED;
+        };
+        std::vector<Flow> tcp_flows(65536), udp_flows(65536);
+        auto flows_for = [&](Protocol protocol) -> std::vector<Flow>& {
+            return protocol == Protocol::TCP ? tcp_flows : udp_flows;
+        };
+
+        // Todos los sondeos tienen el mismo timeout y llegan en orden de envío, así que los
+        // vencimientos salen en orden FIFO y no hace falta un heap
+        struct Deadline {
+            Clock::time_point when;
+            ScanTask task;
+        };
+        std::deque<Deadline> deadlines;
+        size_t pending = 0;
+        auto timeout = std::chrono::milliseconds(config.timeout_ms);
+
+        std::unordered_map<uint32_t, std::vector<CapturedPacket>> orphans;
+        std::deque<std::pair<Clock::time_point, uint32_t>> orphan_order;
+        size_t orphan_count = 0;
+
+        Batch<ScanResult> out;
+        out.reserve(BATCH_SIZE);
+        // sent_ns: cuándo salió el sondeo, para la fase "sondeo completo"
+        auto emit = [&](const ScanTask& task, PortStatus status, std::vector<unsigned char> header_bytes, uint64_t rtt_ns,
+                        int64_t sent_ns) {
+            if (Phases::enabled()) Phases::record_since(Phases::Phase::PROBE, sent_ns);
+            ScanResult result{};
+            result.port = task.port;
+            result.protocol = task.protocol;
+            result.service = get_service_name(task.port, task.protocol);
+            result.status = status;
+            result.header_bytes = std::move(header_bytes);
+            result.rtt_ns = rtt_ns;
+            out.push_back(std::move(result));
+            window.release();
+            if (out.size() == BATCH_SIZE) {
+                result_ring.push(std::move(out));
+                out = Batch<ScanResult>();
+                out.reserve(BATCH_SIZE);
+            }
+        };
+
+        // Primer paquete de un flujo activo dirigido a su puerto local -> resultado
+        auto try_deliver = [&](Protocol protocol, int port, int local_port, const CapturedPacket& packet) {
+            Flow& flow = flows_for(protocol)[port];
+            if (!flow.active || flow.local_port != local_port) return false;
+            SnifferResult sniffer;
+            if (!Sniffer::classify_packet(packet.data.data(), packet.caplen, packet.len, link_layer_offset, port, sniffer)) {
+                return false;
+            }
+            flow.active = false;
+            --pending;
+            Trace::event(Trace::Event::MATCHED, protocol, port);
+            ScanStats::probe_answered();
+            // Misma prioridad que scan_task(): en TCP una respuesta desconocida cae al respaldo
+            PortStatus status = (protocol == Protocol::TCP && sniffer.status == PortStatus::UNKNOWN)
+                                ? flow.fallback : sniffer.status;
+            Usdt::classified(port, protocol, status, packet.captured_ns);
+            emit({port, protocol}, status, std::move(sniffer.header_bytes), Timing::rtt_ns(flow.sent_ns, packet.captured_ns),
+                 flow.sent_ns);
+            return true;
+        };
+
+        // Entrega el paquete al flujo que corresponda, false si no le sirvió a ninguno
+        auto deliver_packet = [&](const CapturedPacket& packet, ResponseKey& key) {
+            if (!Sniffer::response_key(packet.data.data(), packet.caplen, link_layer_offset, target_addr, key)) {
+                return false;
+            }
+            bool used = false;
+            if (key.tcp_port >= 0) used |= try_deliver(Protocol::TCP, key.tcp_port, key.local_port, packet);
+            if (key.udp_port >= 0) used |= try_deliver(Protocol::UDP, key.udp_port, key.local_port, packet);
+            return used;
+        };
+
+        auto handle_packet = [&](const CapturedPacket& packet) {
+            ResponseKey key;
+            if (deliver_packet(packet, key)) return;
+            if (key.tcp_port < 0 && key.udp_port < 0) {
+                ignored.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            // Quizás el registro de su sondeo todavía no llega, se guarda un rato bajo el puerto
+            // que corresponde (en UDP e ICMP es udp_port, en TCP es tcp_port)
+            // Con objetivo local también se capturan nuestros propios sondeos: los UDP no van a udp_local_port
+            // y los SYN sin ACK no clasifican como respuesta, esos no se guardan
+            bool is_udp = key.udp_port >= 0;
+            bool plausible = is_udp ? key.local_port == udp_local_port : false;
+            if (!is_udp) {
+                SnifferResult probe_check;
+                plausible = Sniffer::classify_packet(packet.data.data(), packet.caplen, packet.len, link_layer_offset,
+                                                     key.tcp_port, probe_check)
+                            && probe_check.status != PortStatus::UNKNOWN;
+            }
+            if (!plausible || orphan_count >= MAX_ORPHANS) {
+                ignored.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            uint32_t k = is_udp ? flow_key(Protocol::UDP, key.udp_port) : flow_key(Protocol::TCP, key.tcp_port);
+            orphans[k].push_back(packet);
+            orphan_order.emplace_back(packet.arrival, k);
+            ++orphan_count;
+        };
+
+        Batch<SentProbe> sent;
+        Batch<CapturedPacket> packets;
+        unsigned spins = 0;
+        while (true) {
+            bool work = false;
+
+            // Primero los registros, así las respuestas de esta vuelta ya encuentran su flujo
+            while (sent_ring.try_pop(sent)) {
+                work = true;
+                for (const SentProbe& probe : sent) {
+                    Flow& flow = flows_for(probe.task.protocol)[probe.task.port];
+                    flow.active = true;
+                    flow.local_port = probe.local_port;
+                    flow.fallback = probe.fallback;
+                    flow.sent_ns = probe.sent_ns;
+                    ++pending;
+                    deadlines.push_back({probe.sent + timeout, probe.task});
+
+                    auto it = orphans.find(flow_key(probe.task.protocol, probe.task.port));
+                    if (it != orphans.end()) {
+                        for (const CapturedPacket& packet : it->second) {
+                            ResponseKey key;
+                            if (deliver_packet(packet, key)) break;
+                        }
+                        orphan_count -= it->second.size();
+                        orphans.erase(it);
+                    }
+                }
+            }
+
+            if (packet_ring.try_pop(packets)) {
+                work = true;
+                PerfCounters::Scope classify(PerfCounters::Phase::CLASSIFY);
+                for (const CapturedPacket& packet : packets) handle_packet(packet);
+            }
+
+            // Se acabó la gracia de una interrupción: lo que siga en vuelo (y lo que el transmisor alcance
+            // a mandar después) queda pendiente y se devuelve su lugar en la ventana. discard() también
+            // libera su lugar en la salida en vivo, si no lo que viene detrás se queda esperando hasta el final
+            if (Shutdown::expired() && pending > 0) {
+                for (const Deadline& entry : deadlines) {
+                    Flow& flow = flows_for(entry.task.protocol)[entry.task.port];
+                    if (!flow.active) continue;
+                    flow.active = false;
+                    Shutdown::abandoned(entry.task);
+                    ResultSink::discard(entry.task);
+                }
+                window.release(pending);
+                pending = 0;
+                deadlines.clear();
+                work = true;
+            }
+
+            auto now = Clock::now();
+            while (!deadlines.empty() && deadlines.front().when <= now) {
+                const ScanTask& task = deadlines.front().task;
+                Flow& flow = flows_for(task.protocol)[task.port];
+                if (flow.active) {
+                    flow.active = false;
+                    --pending;
+                    Trace::event(Trace::Event::TIMEOUT, task.protocol, task.port);
+                    Usdt::timeout(task.port, task.protocol, flow.sent_ns);
+                    emit(task, flow.fallback, {}, 0, flow.sent_ns);
+                }
+                deadlines.pop_front();
+                work = true;
+            }
+
+            while (!orphan_order.empty() && now - orphan_order.front().first > ORPHAN_TTL) {
+                auto it = orphans.find(orphan_order.front().second);
+                if (it != orphans.end()) {
+                    orphan_count -= it->second.size();
+                    ignored.fetch_add(it->second.size(), std::memory_order_relaxed);
+                    orphans.erase(it);
+                }
+                orphan_order.pop_front();
+            }
+
+            if (!work) {
+                if (!out.empty()) {
+                    result_ring.push(std::move(out));
+                    out = Batch<ScanResult>();
+                    out.reserve(BATCH_SIZE);
+                }
+                if (transmitter_done.load(std::memory_order_acquire) && sent_ring.empty() && pending == 0) break;
+                SpscRing<Batch<CapturedPacket>>::backoff(spins);
+            } else {
+                spins = 0;
+            }
+        }
+        if (!out.empty()) result_ring.push(std::move(out));
+        matcher_done.store(true, std::memory_order_release);
+    }
+
+    // Etapa 5: publica los resultados (journal, NDJSON) y los junta si hacen falta al final
+    template <PipelineNet Net>
+    void PipelineScan<Net>::sink_stage() {
+        Trace::name_thread("pipeline: sumidero");
+        Batch<ScanResult> batch;
+        unsigned spins = 0;
+        while (true) {
+            if (result_ring.try_pop(batch)) {
+                spins = 0;
+                for (auto& result : batch) {
+                    if (ResultSink::publish(result)) results.push_back(std::move(result));
+                }
+                continue;
+            }
+            if (matcher_done.load(std::memory_order_acquire) && result_ring.empty()) break;
+            SpscRing<Batch<ScanResult>>::backoff(spins);
+        }
+    }
+
+    template <PipelineNet Net>
+    std::vector<ScanResult> PipelineScan<Net>::run() {
+        // size() solo lee los índices atómicos, se puede consultar desde el hilo de métricas
+        Metrics::set_queue_depths([this] {
+            return std::vector<std::pair<std::string, size_t>>{
+                {"tasks", task_ring.size()}, {"sent", sent_ring.size()},
+                {"packets", packet_ring.size()}, {"results", result_ring.size()},
+            };
+        });
+        std::thread generator(&PipelineScan::generator_stage, this);
+        std::thread transmitter(&PipelineScan::transmitter_stage, this);
+        std::thread receiver(&PipelineScan::receiver_stage, this);
+        std::thread matcher(&PipelineScan::matcher_stage, this);
+
+        // El sumidero corre en el hilo que llamó
+        sink_stage();
+
+        generator.join();
+        transmitter.join();
+        receiver.join();
+        matcher.join();
+        Metrics::set_queue_depths(nullptr);
+        return std::move(results);
+    }
+
+    template <PipelineNet Net>
+    static std::vector<ScanResult> run_with(const AppConfig& config, Net& net) {
+        // El hilo que llama hace de sumidero. Se fija antes de construir las colas para que sus slots
+        // queden en el nodo de la NIC (los lotes en sí los reserva cada productor ya fijado). Es el hilo
+        // de main, así que al salir recupera su máscara
+        Affinity::ScopedPin pin(Affinity::Role::WORKER, 1);
+        PipelineScan<Net> scan(config, net);
+        if (!scan.setup()) return {};
+        return scan.run();
+    }
+
+    std::vector<ScanResult> run(const AppConfig& config) {
+        SocketNet net(config);
+        return run_with(config, net);
+    }
+
+#ifdef ESCANER_MOCK_NET
+    std::vector<ScanResult> run(const AppConfig& config, MockNet& net) {
+        return run_with(config, net);
+    }
+#endif
+
+}
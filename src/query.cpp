@@ -0,0 +1,270 @@
+#include "include/query.h"
+#include "include/binary_report.h"
+#include "include/JSONGen.h"
+#include "include/json_writer.h"
+#include "include/args.h"
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdio>
+
+namespace Query {
+
+    enum class Mode { TABLE, JSON, SUMMARY };
+
+    struct Filter {
+        bool by_host = false;
+        uint32_t host = 0;
+        std::vector<bool> ports;    // Vacío = todos
+        int min_port = 0;
+        int max_port = 65535;
+        int protocol = -1;          // Protocol, -1 = todos
+        int status = -1;            // PortStatus, -1 = todos
+    };
+
+    struct Summary {
+        uint64_t records = 0;
+        uint64_t by_status[5] = {};
+        uint64_t by_protocol[2] = {};
+        std::set<uint32_t> hosts;
+        std::vector<uint64_t> open_ports = std::vector<uint64_t>(65536);
+    };
+
+    static const char* STATUS_LABELS[] = {"Abierto", "Cerrado", "Filtrado", "Abierto|Filtrado", "Desconocido"};
+
+    static void usage(const char* prog) {
+        std::cout << "Uso: " << prog << " query ARCHIVO... [opciones]\n\n";
+        std::cout << "Consulta reportes binarios (--binary) sin cargarlos a memoria\n\n";
+        std::cout << "  --host IP                 Solo ese host (usa el índice por host)\n";
+        std::cout << "  -p PUERTOS                Solo esos puertos (ej. 22,80,8000-8100; usa el índice por puerto)\n";
+        std::cout << "  --tcp | --udp             Solo un protocolo\n";
+        std::cout << "  --status ESTADO           open, filtered, open_filtered o unknown\n";
+        std::cout << "  --json                    Un objeto JSON por línea, los mismos campos que --ndjson\n";
+        std::cout << "  --summary                 Totales por estado, protocolo y los puertos abiertos más comunes\n";
+    }
+
+    static bool parse_status(const std::string& text, int& status) {
+        if (text == "open") status = static_cast<int>(PortStatus::OPEN);
+        else if (text == "filtered") status = static_cast<int>(PortStatus::FILTERED);
+        else if (text == "open_filtered") status = static_cast<int>(PortStatus::OPEN_FILTERED);
+        else if (text == "unknown") status = static_cast<int>(PortStatus::UNKNOWN);
+        else return false;
+        return true;
+    }
+
+    static bool matches(const Filter& filter, const BinaryReport::Record& record) {
+        if (!filter.ports.empty() && !filter.ports[record.port]) return false;
+        if (filter.protocol >= 0 && record.protocol != filter.protocol) return false;
+        if (filter.status >= 0 && record.status != filter.status) return false;
+        return true;
+    }
+
+    // Llama a visit con cada registro que pasa el filtro. Con --host se recorre solo el rango del host
+    // (ordenado por puerto, así que se salta directo al primer puerto pedido); con -p y sin host se va
+    // por el índice por puerto; sin ninguno se recorre todo
+    static void scan(const BinaryReport::MappedFile& file, const Filter& filter,
+                     const std::function<void(const BinaryReport::Record&)>& visit) {
+        auto check = [&](const BinaryReport::Record& record) {
+            if (matches(filter, record) && file.valid(record)) visit(record);
+        };
+
+        if (filter.by_host) {
+            uint64_t first = 0, count = 0;
+            if (!file.host_range(filter.host, first, count)) return;
+            uint64_t lo = first, hi = first + count;
+            while (lo < hi) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                if (file.record(mid).port < filter.min_port) lo = mid + 1;
+                else hi = mid;
+            }
+            for (uint64_t i = lo; i < first + count; ++i) {
+                const BinaryReport::Record& record = file.record(i);
+                if (record.port > filter.max_port) break;
+                if (record.ipv4 == filter.host) check(record);
+            }
+            return;
+        }
+
+        if (!filter.ports.empty()) {
+            uint64_t size = file.size();
+            auto record_at = [&](uint64_t i) -> const BinaryReport::Record* {
+                uint64_t id = file.by_port(i);
+                return id < size ? &file.record(id) : nullptr;
+            };
+            uint64_t lo = 0, hi = size;
+            while (lo < hi) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                const BinaryReport::Record* record = record_at(mid);
+                if (record && record->port < filter.min_port) lo = mid + 1;
+                else hi = mid;
+            }
+            for (uint64_t i = lo; i < size; ++i) {
+                const BinaryReport::Record* record = record_at(i);
+                if (!record) continue;
+                if (record->port > filter.max_port) break;
+                check(*record);
+            }
+            return;
+        }
+
+        for (uint64_t i = 0; i < file.size(); ++i) check(file.record(i));
+    }
+
+    static void print_summary(const Summary& summary, size_t files) {
+        std::cout << "Archivos: " << files << "\n";
+        std::cout << "Registros: " << summary.records << " (" << summary.hosts.size() << " hosts)\n";
+        std::cout << "Por protocolo: TCP " << summary.by_protocol[0] << ", UDP " << summary.by_protocol[1] << "\n";
+        std::cout << "Por estado:\n";
+        for (int i = 0; i < 5; ++i) {
+            if (summary.by_status[i] > 0) std::cout << "  " << STATUS_LABELS[i] << ": " << summary.by_status[i] << "\n";
+        }
+
+        std::vector<int> ports;
+        for (int port = 0; port < 65536; ++port) {
+            if (summary.open_ports[port] > 0) ports.push_back(port);
+        }
+        std::stable_sort(ports.begin(), ports.end(), [&](int a, int b) {
+            return summary.open_ports[a] > summary.open_ports[b];
+        });
+        if (ports.size() > 10) ports.resize(10);
+        if (!ports.empty()) {
+            std::cout << "Puertos abiertos más comunes:\n";
+            for (int port : ports) std::cout << "  " << port << ": " << summary.open_ports[port] << "\n";
+        }
+        std::cout << std::flush;
+    }
+
+    int run(int argc, char* argv[]) {
+        const char* prog = argv[0];
+        std::vector<std::string> files;
+        Filter filter;
+        Mode mode = Mode::TABLE;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help") {
+                usage(prog);
+                return 0;
+            } else if (arg == "--host" && i + 1 < argc) {
+                if (!BinaryReport::parse_ipv4(argv[++i], filter.host)) {
+                    std::cerr << "error, --host espera una IPv4: " << argv[i] << std::endl;
+                    return 1;
+                }
+                filter.by_host = true;
+            } else if (arg == "-p" && i + 1 < argc) {
+                std::vector<int> ports = ArgsParser::parsearPuertos(argv[++i]);
+                if (ports.empty()) {
+                    std::cerr << "error, no se especificaron puertos válidos." << std::endl;
+                    return 1;
+                }
+                filter.ports.assign(65536, false);
+                for (int port : ports) filter.ports[port] = true;
+                filter.min_port = ports.front();
+                filter.max_port = ports.back();
+            } else if (arg == "--tcp") {
+                filter.protocol = static_cast<int>(Protocol::TCP);
+            } else if (arg == "--udp") {
+                filter.protocol = static_cast<int>(Protocol::UDP);
+            } else if (arg == "--status" && i + 1 < argc) {
+                if (!parse_status(argv[++i], filter.status)) {
+                    std::cerr << "error, estado desconocido: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--json") {
+                mode = Mode::JSON;
+            } else if (arg == "--summary") {
+                mode = Mode::SUMMARY;
+            } else if (!arg.empty() && arg[0] == '-') {
+                std::cerr << "error, opción desconocida: " << arg << std::endl;
+                return 1;
+            } else {
+                files.push_back(arg);
+            }
+        }
+        if (files.empty()) {
+            usage(prog);
+            return 1;
+        }
+
+        Summary summary;
+        JsonWriter writer;
+        bool table_header = false;
+        int status = 0;
+
+        for (const std::string& path : files) {
+            BinaryReport::MappedFile file;
+            std::string error;
+            if (!file.open(path, error)) {
+                std::cerr << path << ": " << error << std::endl;
+                status = 1;
+                continue;
+            }
+
+            scan(file, filter, [&](const BinaryReport::Record& record) {
+                Protocol protocol = record.protocol == 0 ? Protocol::TCP : Protocol::UDP;
+                PortStatus port_status = static_cast<PortStatus>(std::min<int>(record.status, 4));
+                std::string_view banner = file.banner(record);
+
+                if (mode == Mode::SUMMARY) {
+                    summary.records++;
+                    summary.by_status[static_cast<int>(port_status)]++;
+                    summary.by_protocol[static_cast<int>(protocol)]++;
+                    summary.hosts.insert(record.ipv4);
+                    if (port_status == PortStatus::OPEN) summary.open_ports[record.port]++;
+                    return;
+                }
+
+                if (mode == Mode::JSON) {
+                    // Mismas llaves y en el mismo orden que JSONGenerator::result_line
+                    writer.begin_object();
+                    if (!banner.empty()) {
+                        writer.key("banner");
+                        writer.value(banner);
+                    }
+                    writer.key("header_bytes");   writer.hex_value(record.header, record.header_len);
+                    writer.key("ip");             writer.value(BinaryReport::format_ipv4(record.ipv4));
+                    writer.key("port");           writer.value(static_cast<int>(record.port));
+                    writer.key("protocol");       writer.value(JSONGenerator::protocol_name(protocol));
+                    if (record.rtt_ns > 0) {
+                        writer.key("rtt_ns");
+                        writer.value(record.rtt_ns);
+                    }
+                    writer.key("service");        writer.value(file.service(record.service_id));
+                    writer.key("status");         writer.value(JSONGenerator::status_name(port_status));
+                    writer.end_object();
+                    writer.newline();
+                    if (writer.size() >= (1 << 20)) {
+                        fwrite(writer.buffer().data(), 1, writer.size(), stdout);
+                        writer.clear();
+                    }
+                    return;
+                }
+
+                if (!table_header) {
+                    std::cout << "HOST\t\tPUERTO\t\tESTADO\t\tSERVICIO\n";
+                    std::cout << "----\t\t------\t\t------\t\t--------\n";
+                    table_header = true;
+                }
+                std::cout << BinaryReport::format_ipv4(record.ipv4) << "\t" << record.port << "/"
+                          << JSONGenerator::protocol_name(protocol) << "\t\t" << STATUS_LABELS[static_cast<int>(port_status)]
+                          << "\t\t" << file.service(record.service_id);
+                if (!banner.empty()) std::cout << "\t" << banner;
+                std::cout << "\n";
+            });
+        }
+
+        if (mode == Mode::JSON) {
+            fwrite(writer.buffer().data(), 1, writer.size(), stdout);
+            fflush(stdout);
+        } else if (mode == Mode::SUMMARY) {
+            print_summary(summary, files.size());
+        } else {
+            std::cout << std::flush;
+        }
+        return status;
+    }
+
+}
@@ -0,0 +1,519 @@
+#include "include/reactor.h"
+#include "include/affinity.h"
+#include "include/event_loop.h"
+#include "include/coro.h"
+#include "include/scheduler.h"
+#include "include/shutdown.h"
+#include "include/result_sink.h"
+#include "include/live_output.h"
+#include "include/sniffer.h"
+#include "include/stats.h"
+#include "include/utils.h"
+#include "include/timing.h"
+#include "include/phases.h"
+#include "include/metrics.h"
+#include "include/trace.h"
+#include "include/usdt.h"
+#include "include/perf_counters.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+
+namespace Reactor {
+
+    // Después de que connect() termina se le da este margen a la captura para que llegue el SYN/ACK o RST
+    // (si ya llegó no se espera nada)
+    static constexpr auto CAPTURE_GRACE = std::chrono::milliseconds(50);
+
+    // Cada cuánto se le piden a pcap sus contadores para detectar pérdida a media captura
+    static constexpr auto STATS_INTERVAL = std::chrono::seconds(1);
+
+    // Cada cuánto se revisa si llegó SIGINT/SIGTERM (el handler no puede tocar el EventLoop)
+    static constexpr auto INTERRUPT_POLL = std::chrono::milliseconds(50);
+
+    static constexpr int NO_SLOT = -1;
+
+    // Cuánto del banner se guarda
+    static constexpr size_t BANNER_MAX = 128;
+
+    // Puerto local que el kernel le asignó al socket (connect/bind ya lo fijaron)
+    static int local_port_of(int fd) {
+        sockaddr_in local{};
+        socklen_t len = sizeof(local);
+        if (getsockname(fd, (struct sockaddr*)&local, &len) < 0) return -1;
+        return ntohs(local.sin_port);
+    }
+
+    // Estado de un sondeo en vuelo. Viven en un arreglo fijo de config.max_inflight slots que se reciclan
+    // La lógica del sondeo vive en una corrutina (tcp_probe/udp_probe), aquí solo queda lo que
+    // también necesita ver el callback de la captura
+    struct Probe {
+        ScanTask task{};
+        int fd = -1;
+        int local_port = -1; // Puerto de origen del sondeo, la respuesta tiene que ir dirigida a él
+        SnifferResult sniffer;
+        int64_t sent_ns = 0;  // Último envío, para el RTT
+        int64_t started_ns = 0; // Phases::now() al lanzarlo (0 sin --phases)
+        int attempts = 0;
+        Coro::OneShotEvent response; // Se dispara con el primer paquete de respuesta en la captura
+        std::string banner;
+    };
+
+    class ReactorScan {
+    public:
+        explicit ReactorScan(const AppConfig& cfg)
+            : config(cfg), sampler(cfg.interface), max_inflight(std::max<size_t>(1, cfg.max_inflight)),
+              probes(max_inflight), tcp_flows(65536, NO_SLOT), udp_flows(65536, NO_SLOT),
+              generator(cfg) {
+            for (size_t i = max_inflight; i > 0; --i) free_slots.push_back(i - 1);
+        }
+
+        ~ReactorScan() {
+            if (udp_fd >= 0) close(udp_fd);
+        }
+
+        bool setup();
+        std::vector<ScanResult> run();
+
+    private:
+        bool open_capture();
+        void close_capture();
+        static void capture_handler(u_char* user_data, const pcap_pkthdr* pkthdr, const u_char* packet);
+        void on_packet(const pcap_pkthdr* pkthdr, const u_char* packet);
+        bool deliver(int slot, int local_port, const pcap_pkthdr* pkthdr, const u_char* packet);
+
+        void fill();
+
+        // Pasos de un sondeo, cada uno es una corrutina que se suspende en el EventLoop
+        Coro::Task<void> tcp_probe(size_t slot);
+        Coro::Task<void> udp_probe(size_t slot);
+        Coro::Task<PortStatus> connect_step(Probe& probe);
+        Coro::Task<bool> send_udp_step(Probe& probe);
+        Coro::Task<void> banner_step(Probe& probe);
+        PortStatus open_or_self_connect(const Probe& probe) const;
+
+        EventLoop::Clock::time_point after(std::chrono::milliseconds delay) const {
+            return EventLoop::Clock::now() + delay;
+        }
+        std::chrono::milliseconds timeout() const { return std::chrono::milliseconds(config.timeout_ms); }
+        std::chrono::milliseconds capture_grace() const { return std::min<std::chrono::milliseconds>(CAPTURE_GRACE, timeout()); }
+
+        void finish(size_t slot, PortStatus status);
+        void release(size_t slot);
+        void abandon_inflight();
+        void close_probe_fd(Probe& probe);
+
+        const AppConfig& config;
+        EventLoop loop;
+
+        pcap_t* handle = nullptr;
+        int link_layer_offset = 14;
+        bool nano_timestamps = false;
+        CaptureSampler sampler;
+        uint64_t ignored = 0;
+
+        sockaddr_in target{};
+        int udp_fd = -1;
+        int udp_local_port = -1;
+        bool is_local_target = false;
+
+        size_t max_inflight;
+        std::vector<Probe> probes;
+        std::vector<size_t> free_slots;
+        std::vector<int> tcp_flows, udp_flows; // puerto -> slot del sondeo en vuelo
+        size_t inflight = 0;
+
+        // Las tareas se generan sobre la marcha (puerto x protocolo), nunca se arma la lista completa
+        TaskGenerator generator;
+        bool fill_pending = false;
+        bool in_fill = false;
+
+        std::vector<ScanResult> results;
+    };
+
+    bool ReactorScan::setup() {
+        if (!loop.valid()) return false;
+
+        target.sin_family = AF_INET;
+        if (inet_pton(AF_INET, config.target_ip.c_str(), &target.sin_addr) != 1) {
+            std::cerr << "Reactor: el objetivo debe ser una IPv4 (" << config.target_ip << ")" << std::endl;
+            return false;
+        }
+
+        // Un solo socket UDP para todos los sondeos, no bloqueante
+        udp_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (udp_fd < 0) {
+            perror("Error al crear socket UDP");
+            return false;
+        }
+        // Se fija el puerto de origen de una vez para poder reconocer las respuestas
+        sockaddr_in any{};
+        any.sin_family = AF_INET;
+        if (bind(udp_fd, (struct sockaddr*)&any, sizeof(any)) < 0) {
+            perror("Error en bind() del socket UDP");
+            return false;
+        }
+        udp_local_port = local_port_of(udp_fd);
+
+        // Si el objetivo es esta misma máquina (loopback o una IP propia) bind() a esa IP funciona
+        int probe_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_in self = target;
+        self.sin_port = 0;
+        is_local_target = probe_fd >= 0 && bind(probe_fd, (struct sockaddr*)&self, sizeof(self)) == 0;
+        if (probe_fd >= 0) close(probe_fd);
+
+        // Sin captura el escaneo sigue funcionando para TCP con connect(), igual que el motor de hilos
+        if (!open_capture()) {
+            std::cerr << "Reactor: no se pudo abrir la captura en " << config.interface
+                      << ", se usa solo connect() para TCP" << std::endl;
+        }
+        return true;
+    }
+
+    bool ReactorScan::open_capture() {
+        handle = Sniffer::open_host_capture(config.interface, config.target_ip);
+        if (!handle) return false;
+        link_layer_offset = Sniffer::link_layer_offset(pcap_datalink(handle));
+        nano_timestamps = Sniffer::nano_timestamps(handle);
+
+        int fd = pcap_get_selectable_fd(handle);
+        loop.watch(fd, EPOLLIN, [this](uint32_t) {
+            PerfCounters::Scope receive(PerfCounters::Phase::RECEIVE);
+            pcap_dispatch(handle, -1, capture_handler, reinterpret_cast<u_char*>(this));
+        });
+        return true;
+    }
+
+    void ReactorScan::close_capture() {
+        if (!handle) return;
+        int fd = pcap_get_selectable_fd(handle);
+        if (fd >= 0) loop.unwatch(fd);
+        pcap_close(handle);
+        handle = nullptr;
+    }
+
+    void ReactorScan::capture_handler(u_char* user_data, const pcap_pkthdr* pkthdr, const u_char* packet) {
+        reinterpret_cast<ReactorScan*>(user_data)->on_packet(pkthdr, packet);
+    }
+
+    void ReactorScan::on_packet(const pcap_pkthdr* pkthdr, const u_char* packet) {
+        Usdt::packet_received(-1, pkthdr->caplen, Timing::pcap_ns(pkthdr->ts, nano_timestamps));
+        ResponseKey key;
+        bool used = false;
+        if (Sniffer::response_key(packet, pkthdr->caplen, link_layer_offset, target.sin_addr.s_addr, key)) {
+            if (key.tcp_port >= 0) used |= deliver(tcp_flows[key.tcp_port], key.local_port, pkthdr, packet);
+            if (key.udp_port >= 0) used |= deliver(udp_flows[key.udp_port], key.local_port, pkthdr, packet);
+        }
+        if (!used) ++ignored;
+    }
+
+    // Igual que el sniffer en vivo: solo cuenta el PRIMER paquete de cada sondeo
+    // Como la captura es de todo el host, además se exige que la respuesta vaya a NUESTRO puerto local;
+    // si no, al escanearse a sí mismo los sondeos salientes (src = objetivo) se confundirían con respuestas
+    bool ReactorScan::deliver(int slot, int local_port, const pcap_pkthdr* pkthdr, const u_char* packet) {
+        if (slot == NO_SLOT) return false;
+        Probe& probe = probes[slot];
+        if (probe.response.is_set() || local_port != probe.local_port) return false;
+        PerfCounters::Scope classify(PerfCounters::Phase::CLASSIFY);
+        if (!Sniffer::classify_packet(packet, pkthdr->caplen, pkthdr->len, link_layer_offset,
+                                      probe.task.port, probe.sniffer)) {
+            return false;
+        }
+        if (probe.response.is_set()) return false;
+        probe.sniffer.capture_ns = Timing::capture_ns(pkthdr->ts, nano_timestamps);
+        Trace::event(Trace::Event::MATCHED, probe.task.protocol, probe.task.port);
+        Usdt::classified(probe.task.port, probe.task.protocol, probe.sniffer.status, probe.sniffer.capture_ns);
+        ScanStats::probe_answered();
+        probe.response.set(loop); // La corrutina del sondeo sigue en la siguiente vuelta del loop
+        return true;
+    }
+
+    // Lanza sondeos hasta llenar la ventana. Si ScanStats pide frenar por pérdida en la captura
+    // se lanza uno y el resto se reprograma con un timer
+    void ReactorScan::fill() {
+        // release() llama a fill(), y un sondeo que termina al instante llama a release() desde aquí
+        // mismo; sin este guard eso sería una recursión tan profunda como el número de puertos
+        if (fill_pending || in_fill) return;
+        in_fill = true;
+        ScanTask task;
+        // Con una interrupción pendiente ya no se lanza nada, solo se espera a los que están en vuelo
+        // Tampoco se adelanta más de la ventana a la tabla en vivo: si el del frente tarda, lo que termina
+        // detrás espera ahí. Cuando ese termine vuelve a llamar a fill(); sin nada en vuelo no hay frente
+        // que esperar
+        while (inflight < max_inflight && !Shutdown::requested() &&
+               (inflight == 0 || LiveOutput::room(generator.emitted(), max_inflight) > 0) && generator.next(task)) {
+            size_t slot = free_slots.back();
+            free_slots.pop_back();
+            ++inflight;
+            Metrics::inflight_add(1);
+            probes[slot] = Probe{};
+            probes[slot].task = task;
+            probes[slot].started_ns = Phases::now();
+            Trace::event(Trace::Event::DEQUEUED, task.protocol, task.port);
+            (task.protocol == Protocol::TCP ? tcp_flows : udp_flows)[task.port] = (int)slot;
+
+            // La corrutina arranca ya y corre hasta su primer co_await
+            Coro::spawn(task.protocol == Protocol::TCP ? tcp_probe(slot) : udp_probe(slot));
+
+            auto pacing = ScanStats::pacing_delay();
+            if (pacing.count() > 0) {
+                fill_pending = true;
+                loop.add_timer(EventLoop::Clock::now() + pacing, [this] {
+                    fill_pending = false;
+                    fill();
+                });
+                break;
+            }
+        }
+        in_fill = false;
+        if (inflight == 0 && !fill_pending) loop.stop(); // Ya no hay nada en vuelo ni por lanzar
+    }
+
+    // Un intento de connect() no bloqueante. Deja el socket en probe.fd (para el banner) y regresa
+    // lo que diría Scanner::scanTCP: abierto, cerrado, filtrado si venció el timeout o desconocido
+    Coro::Task<PortStatus> ReactorScan::connect_step(Probe& probe) {
+        close_probe_fd(probe);
+        int rc;
+        int connect_errno = 0;
+        {
+            // Sin ningún co_await adentro, si no otro sondeo correría en medio de la medición
+            PerfCounters::Scope send(PerfCounters::Phase::SEND);
+            probe.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (probe.fd < 0) co_return PortStatus::UNKNOWN;
+            Trace::event(Trace::Event::SOCKET, Protocol::TCP, probe.task.port);
+            ScanStats::probe_sent();
+
+            sockaddr_in addr = target;
+            addr.sin_port = htons(probe.task.port);
+            probe.sent_ns = Timing::monotonic_ns();
+            ++probe.attempts;
+            rc = connect(probe.fd, (struct sockaddr*)&addr, sizeof(addr));
+            if (rc < 0) connect_errno = errno; // Antes de que el trace o getsockname() lo pisen
+            Trace::event_at(Trace::Event::SENT, Protocol::TCP, probe.task.port, probe.sent_ns);
+            Usdt::probe_sent(probe.task.port, Protocol::TCP, probe.sent_ns);
+            probe.local_port = local_port_of(probe.fd);
+        }
+        if (rc == 0) co_return open_or_self_connect(probe); // Terminó al instante (típico en loopback)
+        // Solo ECONNREFUSED es respuesta del objetivo (el RST ya llegó, típico en loopback). Lo demás es
+        // un error local: sin puertos efímeros (EADDRNOTAVAIL/EAGAIN con muchos sondeos en vuelo), sin
+        // ruta, EACCES... no dice nada del puerto, igual que cuando falla socket()
+        if (connect_errno != EINPROGRESS) {
+            co_return connect_errno == ECONNREFUSED ? PortStatus::CLOSED : PortStatus::UNKNOWN;
+        }
+
+        // El socket se vuelve "writeable" cuando el handshake termina, con error o sin él
+        if (!co_await Coro::wait_fd(loop, probe.fd, EPOLLOUT, after(timeout()))) {
+            Trace::event(Trace::Event::TIMEOUT, Protocol::TCP, probe.task.port);
+            Usdt::timeout(probe.task.port, Protocol::TCP, probe.sent_ns);
+            co_return PortStatus::FILTERED;
+        }
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+        getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+        co_return (so_error == 0) ? open_or_self_connect(probe) : PortStatus::CLOSED;
+    }
+
+    // Con cientos de connect() en vuelo contra la propia máquina, a veces el kernel elige como puerto
+    // efímero justo el puerto destino y el socket "se conecta consigo mismo" (simultaneous open)
+    // Eso no es un servicio escuchando, el puerto en realidad está cerrado
+    PortStatus ReactorScan::open_or_self_connect(const Probe& probe) const {
+        return (probe.local_port == probe.task.port && is_local_target) ? PortStatus::CLOSED : PortStatus::OPEN;
+    }
+
+    // Lee lo primero que mande el servicio al conectarse (SSH, SMTP, FTP... saludan solos)
+    Coro::Task<void> ReactorScan::banner_step(Probe& probe) {
+        if (probe.fd < 0) co_return;
+        if (!co_await Coro::wait_fd(loop, probe.fd, EPOLLIN, after(timeout()))) co_return;
+
+        char buffer[BANNER_MAX];
+        ssize_t n = recv(probe.fd, buffer, sizeof(buffer), 0);
+        for (ssize_t i = 0; i < n; ++i) {
+            unsigned char c = buffer[i];
+            if (c == '\r' || c == '\n') break; // Solo la primera línea
+            probe.banner.push_back((c >= 0x20 && c < 0x7f) ? (char)c : '.');
+        }
+    }
+
+    Coro::Task<void> ReactorScan::tcp_probe(size_t slot) {
+        Probe& probe = probes[slot];
+        PortStatus connect_status = PortStatus::FILTERED;
+
+        // Los reintentos solo aplican si no hubo ninguna respuesta (ni en la captura ni en connect)
+        for (int attempt = 0; attempt <= config.retries; ++attempt) {
+            int64_t connect_start = Phases::now();
+            connect_status = co_await connect_step(probe);
+            Phases::record_since(Phases::Phase::CONNECT, connect_start);
+
+            // Si connect() terminó antes que la captura se le da un margen al SYN/ACK o RST
+            if (handle && !probe.response.is_set() && connect_status != PortStatus::FILTERED) {
+                int64_t wait_start = Phases::now();
+                co_await probe.response.wait(loop, after(capture_grace()));
+                Phases::record_since(Phases::Phase::WAIT_RESPONSE, wait_start);
+            }
+            if (probe.response.is_set() || connect_status != PortStatus::FILTERED) break;
+        }
+
+        // Misma prioridad que scan_task(): manda la captura si la respuesta es conocida y si no connect()
+        PortStatus status = (probe.response.is_set() && probe.sniffer.status != PortStatus::UNKNOWN)
+                            ? probe.sniffer.status
+                            : connect_status;
+
+        if (config.banner && status == PortStatus::OPEN && connect_status == PortStatus::OPEN) {
+            co_await banner_step(probe);
+        }
+        finish(slot, status);
+    }
+
+    // Payload vacío, igual que Scanner::sendUDPProbe. Si el buffer de envío está lleno se reintenta
+    // en un momento sin soltar el slot
+    Coro::Task<bool> ReactorScan::send_udp_step(Probe& probe) {
+        sockaddr_in addr = target;
+        addr.sin_port = htons(probe.task.port);
+        probe.sent_ns = Timing::monotonic_ns();
+        // Cada intento es su propio tramo de envío, entre uno y otro hay un co_await
+        auto send = [&] {
+            PerfCounters::Scope send(PerfCounters::Phase::SEND);
+            return sendto(udp_fd, "", 0, 0, (struct sockaddr*)&addr, sizeof(addr));
+        };
+        while (send() < 0) {
+            if (errno != EAGAIN && errno != ENOBUFS) {
+                perror("Error en sendto() al enviar paquete UDP");
+                co_return false;
+            }
+            co_await Coro::sleep_for(loop, std::chrono::milliseconds(1));
+            probe.sent_ns = Timing::monotonic_ns();
+        }
+        Trace::event_at(Trace::Event::SENT, Protocol::UDP, probe.task.port, probe.sent_ns);
+        Usdt::probe_sent(probe.task.port, Protocol::UDP, probe.sent_ns);
+        ++probe.attempts;
+        ScanStats::probe_sent();
+        probe.local_port = udp_local_port;
+        co_return true;
+    }
+
+    Coro::Task<void> ReactorScan::udp_probe(size_t slot) {
+        Probe& probe = probes[slot];
+        for (int attempt = 0; attempt <= config.retries; ++attempt) {
+            int64_t send_start = Phases::now();
+            bool sent = co_await send_udp_step(probe);
+            Phases::record_since(Phases::Phase::SEND, send_start);
+            if (!sent) {
+                ResultSink::discard(probe.task);
+                release(slot); // Igual que el motor de hilos, si el envío falla no se reporta nada
+                co_return;
+            }
+            // Cualquier respuesta (UDP o ICMP port unreachable) ya es el resultado
+            int64_t wait_start = Phases::now();
+            bool answered = co_await probe.response.wait(loop, after(timeout()));
+            Phases::record_since(Phases::Phase::WAIT_RESPONSE, wait_start);
+            if (answered) break;
+            Trace::event(Trace::Event::TIMEOUT, Protocol::UDP, probe.task.port);
+            Usdt::timeout(probe.task.port, Protocol::UDP, probe.sent_ns);
+        }
+        // Sin respuesta puede ser que el puerto SÍ esté abierto pero no sepa qué responder a un payload vacío
+        finish(slot, probe.response.is_set() ? probe.sniffer.status : PortStatus::OPEN_FILTERED);
+    }
+
+    // Tiene que ser lo ÚLTIMO que haga la corrutina: release() recicla el slot y puede lanzar otro sondeo en él
+    void ReactorScan::finish(size_t slot, PortStatus status) {
+        Probe& probe = probes[slot];
+
+        ScanResult result{};
+        result.port = probe.task.port;
+        result.protocol = probe.task.protocol;
+        result.service = get_service_name(probe.task.port, probe.task.protocol);
+        result.status = status;
+        result.header_bytes = std::move(probe.sniffer.header_bytes);
+        result.banner = std::move(probe.banner);
+        // Con reintentos no se sabe a cuál envío contesta la respuesta (algoritmo de Karn), no se mide
+        if (probe.attempts == 1) result.rtt_ns = Timing::rtt_ns(probe.sent_ns, probe.sniffer.capture_ns);
+        Phases::record_since(Phases::Phase::PROBE, probe.started_ns);
+        if (ResultSink::publish(result)) results.push_back(std::move(result));
+
+        release(slot);
+    }
+
+    void ReactorScan::close_probe_fd(Probe& probe) {
+        if (probe.fd < 0) return;
+        loop.unwatch(probe.fd);
+        close(probe.fd);
+        probe.fd = -1;
+    }
+
+    void ReactorScan::release(size_t slot) {
+        Probe& probe = probes[slot];
+        close_probe_fd(probe);
+        (probe.task.protocol == Protocol::TCP ? tcp_flows : udp_flows)[probe.task.port] = NO_SLOT;
+        probe = Probe{};
+        free_slots.push_back(slot);
+        --inflight;
+        Metrics::inflight_add(-1);
+        fill();
+    }
+
+    // Se acabó la gracia de la interrupción: lo que siga en vuelo queda pendiente para la próxima vez y
+    // su lugar en la salida en vivo se libera (discard). Las corrutinas se quedan suspendidas, el loop ya
+    // no las va a despertar
+    void ReactorScan::abandon_inflight() {
+        for (size_t slot = 0; slot < probes.size(); ++slot) {
+            Probe& probe = probes[slot];
+            if ((probe.task.protocol == Protocol::TCP ? tcp_flows : udp_flows)[probe.task.port] != (int)slot) continue;
+            Shutdown::abandoned(probe.task);
+            ResultSink::discard(probe.task);
+            close_probe_fd(probe);
+        }
+    }
+
+    std::vector<ScanResult> ReactorScan::run() {
+        // Muestreo periódico de pcap_stats mientras haya captura
+        std::function<void()> stats_tick = [this, &stats_tick] {
+            sampler.sample(handle, ignored);
+            if (handle) loop.add_timer(EventLoop::Clock::now() + STATS_INTERVAL, stats_tick);
+        };
+        if (handle) loop.add_timer(EventLoop::Clock::now() + STATS_INTERVAL, stats_tick);
+
+        // Al llegar la señal fill() deja de lanzar y el loop termina solo cuando se vacía la ventana;
+        // si al final de la gracia todavía hay sondeos en vuelo se abandonan
+        std::function<void()> interrupt_tick = [this, &interrupt_tick] {
+            if (!Shutdown::requested()) {
+                loop.add_timer(EventLoop::Clock::now() + INTERRUPT_POLL, interrupt_tick);
+                return;
+            }
+            if (inflight == 0) {
+                loop.stop();
+                return;
+            }
+            loop.add_timer(Shutdown::deadline(), [this] {
+                abandon_inflight();
+                loop.stop();
+            });
+        };
+        loop.add_timer(EventLoop::Clock::now() + INTERRUPT_POLL, interrupt_tick);
+
+        fill();
+        if (inflight > 0) loop.run();
+        Shutdown::set_position(generator.emitted(), generator.total());
+
+        sampler.sample(handle, ignored);
+        close_capture();
+        return std::move(results);
+    }
+
+    std::vector<ScanResult> run(const AppConfig& config) {
+        // Este hilo hace todo pero lo que más pesa es la captura, así que va con las CPUs de rx.
+        // Se fija antes de construir el escaneo para que sus buffers queden en ese nodo NUMA, y al
+        // terminar el hilo de main recupera su máscara
+        Affinity::ScopedPin pin(Affinity::Role::RX);
+        Trace::name_thread("reactor");
+        ReactorScan scan(config);
+        if (!scan.setup()) return {};
+        return scan.run();
+    }
+
+}
@@ -0,0 +1,120 @@
+#include "include/replay.h"
+#include "include/sniffer.h"
+#include "include/utils.h"
+#include "include/stats.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <arpa/inet.h>
+
+namespace Replay {
+
+    // Tabla puerto -> índice en el vector de resultados, una por protocolo
+    // Con 65536 entradas el lookup por paquete es un acceso directo y no un map
+    static constexpr int NO_FLOW = -1;
+
+    std::vector<ScanResult> run(const AppConfig& config) {
+        std::vector<ScanResult> results;
+
+        in_addr target{};
+        if (inet_pton(AF_INET, config.target_ip.c_str(), &target) != 1) {
+            std::cerr << "Replay: el objetivo debe ser una IPv4 (" << config.target_ip << ")" << std::endl;
+            return results;
+        }
+
+        char errbuf[PCAP_ERRBUF_SIZE];
+        pcap_t* handle = pcap_open_offline(config.replay_file.c_str(), errbuf);
+        if (!handle) {
+            std::cerr << "Replay: no se pudo abrir " << config.replay_file << ": " << errbuf << std::endl;
+            return results;
+        }
+        int link_layer_offset = Sniffer::link_layer_offset(pcap_datalink(handle));
+
+        // Se arman los resultados igual que en scan_worker, los que nunca reciban respuesta se quedan con
+        // lo que daría el escaneo en vivo sin captura: TCP sin respuesta es filtrado y UDP abierto|filtrado
+        std::vector<int> tcp_flows(65536, NO_FLOW), udp_flows(65536, NO_FLOW);
+        for (Protocol protocol : config.protocols_to_scan) {
+            for (int port : config.ports) {
+                ScanResult result{};
+                result.port = port;
+                result.protocol = protocol;
+                result.service = get_service_name(port, protocol);
+                result.status = (protocol == Protocol::TCP) ? PortStatus::FILTERED : PortStatus::OPEN_FILTERED;
+                (protocol == Protocol::TCP ? tcp_flows : udp_flows)[port] = (int)results.size();
+                results.push_back(std::move(result));
+            }
+        }
+        std::vector<bool> answered(results.size(), false);
+        size_t pending = results.size();
+
+        // Solo se entrega el PRIMER paquete de cada flujo, igual que el CAS de packet_handler
+        auto deliver = [&](int idx, const u_char* packet, const pcap_pkthdr* pkthdr) {
+            if (idx == NO_FLOW || answered[idx]) return false;
+            SnifferResult sniffer_result;
+            if (!Sniffer::classify_packet(packet, pkthdr->caplen, pkthdr->len, link_layer_offset,
+                                          results[idx].port, sniffer_result)) {
+                return false;
+            }
+            answered[idx] = true;
+            --pending;
+            results[idx].header_bytes = std::move(sniffer_result.header_bytes);
+            // Misma prioridad que el escaneo en vivo: en TCP un UNKNOWN cae al resultado de connect(),
+            // que aquí no existe, así que se queda como filtrado
+            if (results[idx].protocol == Protocol::UDP || sniffer_result.status != PortStatus::UNKNOWN) {
+                results[idx].status = sniffer_result.status;
+            }
+            return true;
+        };
+
+        size_t packets = 0;
+        size_t ignored = 0;
+        auto wall_start = std::chrono::steady_clock::now();
+        bool first = true;
+        struct timeval first_ts{};
+
+        pcap_pkthdr* pkthdr;
+        const u_char* packet;
+        int rc;
+        while (pending > 0 && (rc = pcap_next_ex(handle, &pkthdr, &packet)) >= 0) {
+            if (rc == 0) continue;
+            ++packets;
+
+            // Con --replay-timing se respeta el espaciado original de la captura
+            if (config.replay_timing) {
+                if (first) {
+                    first_ts = pkthdr->ts;
+                    first = false;
+                } else {
+                    auto offset = std::chrono::seconds(pkthdr->ts.tv_sec - first_ts.tv_sec)
+                                + std::chrono::microseconds(pkthdr->ts.tv_usec - first_ts.tv_usec);
+                    std::this_thread::sleep_until(wall_start + offset);
+                }
+            }
+
+            // Esto hace a mano lo que el filtro BPF hace en vivo y reparte el paquete a su(s) flujo(s)
+            ResponseKey key;
+            bool used = false;
+            if (Sniffer::response_key(packet, pkthdr->caplen, link_layer_offset, target.s_addr, key)) {
+                if (key.tcp_port >= 0) used |= deliver(tcp_flows[key.tcp_port], packet, pkthdr);
+                if (key.udp_port >= 0) used |= deliver(udp_flows[key.udp_port], packet, pkthdr);
+            }
+            if (!used) ++ignored;
+        }
+        pcap_close(handle);
+
+        // En un archivo no hay pérdida de kernel, solo se reporta lo leído y lo que no resolvió nada
+        ScanStats::InterfaceCounters counters;
+        counters.interface = config.replay_file;
+        counters.received = packets;
+        counters.ignored = ignored;
+        ScanStats::record_capture(counters);
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+        std::cout << "Replay: " << packets << " paquetes en " << elapsed * 1000.0 << " ms ("
+                  << (elapsed > 0 ? (size_t)(packets / elapsed) : packets) << " pps), "
+                  << (results.size() - pending) << "/" << results.size() << " puertos con respuesta" << std::endl;
+
+        return results;
+    }
+
+}
@@ -0,0 +1,54 @@
+#include "include/result_sink.h"
+#include "include/journal.h"
+#include "include/ndjson.h"
+#include "include/JSONGen.h"
+#include "include/live_output.h"
+#include "include/stats.h"
+#include "include/phases.h"
+#include "include/metrics.h"
+#include "include/trace.h"
+#include "include/usdt.h"
+#include "include/perf_counters.h"
+
+namespace ResultSink {
+
+    static const AppConfig* g_config = nullptr;
+    static bool g_retain = true;
+
+    void configure(const AppConfig& config) {
+        g_config = &config;
+        g_retain = !config.output_file.empty() || !config.binary_file.empty() || !config.diff_file.empty();
+    }
+
+    bool publish(const ScanResult& result, bool journal) {
+        Phases::Timer output(Phases::Phase::OUTPUT);
+        PerfCounters::Scope counters(PerfCounters::Phase::OUTPUT);
+        if (journal) Journal::record(result);
+        ScanStats::record_rtt(result.rtt_ns);
+        if (result.rtt_ns > 0) Phases::record(Phases::Phase::RTT, result.rtt_ns);
+        Metrics::result(result);
+        Usdt::result_commit(result.port, result.protocol, result.status, result.rtt_ns);
+        // Los que vienen de un journal o del replay no tuvieron sondeo que cerrar
+        if (journal) Trace::event(Trace::Event::STORED, result.protocol, result.port);
+        // Los cerrados no salen en el reporte ni en consola, tampoco aquí
+        if (NDJSON::active() && g_config && result.status != PortStatus::CLOSED) {
+            // Un writer por hilo: la línea se arma en un buffer que ya tiene capacidad y NDJSON la copia
+            thread_local JsonWriter writer;
+            writer.clear();
+            JSONGenerator::append_result_line(writer, *g_config, result);
+            NDJSON::write_line(writer.buffer());
+        }
+        LiveOutput::submit(result);
+        return g_retain;
+    }
+
+    void discard(const ScanTask& task) {
+        Trace::event(Trace::Event::DISCARDED, task.protocol, task.port);
+        LiveOutput::skip(task);
+    }
+
+    bool retain() {
+        return g_retain;
+    }
+
+}
@@ -0,0 +1,138 @@
+#include "include/scheduler.h"
+#include "include/journal.h"
+#include "include/live_output.h"
+#include "include/shutdown.h"
+#include <algorithm>
+
+TaskGenerator::TaskGenerator(const std::vector<int>& port_list, const std::vector<Protocol>& protocol_list)
+    : ports(port_list), protocols(protocol_list) {}
+
+TaskGenerator::TaskGenerator(const AppConfig& config)
+    : ports(config.ports), protocols(config.protocols_to_scan),
+      done(config.resume_done.empty() ? nullptr : &config.resume_done) {}
+
+bool TaskGenerator::next(ScanTask& task) {
+    while (true) {
+        if (protocol_index >= protocols.size()) {
+            protocol_index = 0;
+            ++port_index;
+        }
+        if (port_index >= ports.size() || protocols.empty()) return false;
+        task = {ports[port_index], protocols[protocol_index++]};
+        ++emitted_count;
+        Journal::set_position(emitted_count); // Solo un store atómico, el journal lo escribe en su checkpoint
+        if (!done || !(*done)[task_slot(task.protocol, task.port)]) return true;
+    }
+}
+
+size_t TaskGenerator::next_batch(std::vector<ScanTask>& out, size_t max) {
+    size_t added = 0;
+    ScanTask task;
+    while (added < max && next(task)) {
+        out.push_back(task);
+        ++added;
+    }
+    return added;
+}
+
+WorkStealingScheduler::WorkStealingScheduler(size_t num_workers, size_t batch)
+    : batch_size(std::max<size_t>(1, batch)) {
+    for (size_t i = 0; i < std::max<size_t>(1, num_workers); ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+// Cada cuánto se revisa Shutdown mientras se espera lugar en la tabla en vivo
+static constexpr auto ROOM_WAIT = std::chrono::milliseconds(50);
+
+void WorkStealingScheduler::attach(TaskGenerator& generator, size_t ahead) {
+    source = &generator;
+    max_ahead = ahead;
+}
+
+// Se sacan REFILL_BATCHES lotes contiguos de una vez: el primero es para quien pidió y el resto queda en
+// su deque, de donde los saca sin pasar por source_mutex o se los roban los que se queden sin nada
+bool WorkStealingScheduler::refill(size_t worker_id, std::vector<ScanTask>& batch) {
+    if (!source) return false;
+    std::lock_guard<std::mutex> lock(source_mutex);
+    size_t want = batch_size * REFILL_BATCHES;
+    if (max_ahead > 0) want = std::min(want, LiveOutput::room(source->emitted(), max_ahead));
+    refill_buffer.clear();
+    if (want == 0 || source->next_batch(refill_buffer, want) == 0) return false;
+    size_t take = std::min(batch_size, refill_buffer.size());
+    batch.assign(refill_buffer.begin(), refill_buffer.begin() + take);
+    if (take < refill_buffer.size()) {
+        WorkerQueue& own = *queues[worker_id];
+        std::lock_guard<std::mutex> own_lock(own.mutex);
+        own.tasks.insert(own.tasks.end(), refill_buffer.begin() + take, refill_buffer.end());
+    }
+    return true;
+}
+
+void WorkStealingScheduler::drain(std::vector<ScanTask>& leftover) {
+    for (auto& queue : queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        leftover.insert(leftover.end(), queue->tasks.begin(), queue->tasks.end());
+        queue->tasks.clear();
+    }
+}
+
+// refill() no saca nada si la tabla en vivo no tiene lugar aunque el generador no haya terminado: se
+// espera a que salga la fila del frente (la tiene en vuelo otro worker). false si ya no hay nada que esperar
+bool WorkStealingScheduler::wait_for_room() {
+    if (!source || max_ahead == 0 || Shutdown::requested()) return false;
+    size_t emitted;
+    {
+        std::lock_guard<std::mutex> lock(source_mutex);
+        if (source->exhausted()) return false;
+        emitted = source->emitted();
+    }
+    LiveOutput::wait_for_room(emitted, max_ahead, ROOM_WAIT);
+    return true;
+}
+
+bool WorkStealingScheduler::claim(size_t worker_id, std::vector<ScanTask>& batch) {
+    do {
+        batch.clear();
+        {
+            // Un solo lock por lote en lugar de uno por tarea
+            WorkerQueue& own = *queues[worker_id];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            size_t n = std::min(batch_size, own.tasks.size());
+            batch.assign(own.tasks.begin(), own.tasks.begin() + n);
+            own.tasks.erase(own.tasks.begin(), own.tasks.begin() + n);
+        }
+        if (!batch.empty()) return true;
+        // Primero lo que quede por generar, robar solo tiene sentido cuando ya no hay nada nuevo
+        if (refill(worker_id, batch)) return true;
+        if (steal(worker_id, batch)) return true;
+    } while (wait_for_room());
+    return false;
+}
+
+bool WorkStealingScheduler::steal(size_t thief_id, std::vector<ScanTask>& batch) {
+    // Se recorren los demás workers empezando por el vecino para no ir todos sobre la misma víctima
+    // Se roba la mitad desde el FINAL del deque, el dueño sigue sacando del frente sin chocar
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(thief_id + offset) % queues.size()];
+        std::vector<ScanTask> stolen;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty()) continue;
+            size_t n = (victim.tasks.size() + 1) / 2;
+            stolen.assign(victim.tasks.end() - n, victim.tasks.end());
+            victim.tasks.erase(victim.tasks.end() - n, victim.tasks.end());
+        }
+
+        // Lo que no cabe en el lote se queda en el deque propio para el siguiente claim (o para que otro lo robe)
+        size_t take = std::min(batch_size, stolen.size());
+        batch.assign(stolen.begin(), stolen.begin() + take);
+        if (take < stolen.size()) {
+            WorkerQueue& own = *queues[thief_id];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.tasks.insert(own.tasks.end(), stolen.begin() + take, stolen.end());
+        }
+        return true;
+    }
+    return false;
+}
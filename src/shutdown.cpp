@@ -0,0 +1,92 @@
+#include "include/shutdown.h"
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <csignal>
+#include <ctime>
+#include <unistd.h>
+
+namespace Shutdown {
+
+    // El handler solo toca atómicos lock-free y clock_gettime (async-signal-safe). steady_clock en Linux
+    // es CLOCK_MONOTONIC, así que el deadline en nanosegundos se compara directo con Clock::now()
+    // El deadline es también la marca de "ya llegó la señal" (INT64_MAX = no): con dos atómicos otro
+    // hilo podía ver la señal y todavía el deadline sin poner
+    static std::atomic<int64_t> g_deadline_ns{INT64_MAX};
+    static int64_t g_grace_ns = 0;
+
+    static std::mutex g_progress_mutex;
+    static Progress g_progress;
+
+    static void on_signal(int) {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t unset = INT64_MAX;
+        if (!g_deadline_ns.compare_exchange_strong(unset, (int64_t)now.tv_sec * 1000000000 + now.tv_nsec + g_grace_ns)) {
+            static const char msg[] = "\nSegunda señal, se sale sin reporte\n";
+            (void)!write(STDERR_FILENO, msg, sizeof(msg) - 1);
+            _exit(130);
+        }
+        static const char msg[] = "\nInterrumpido: se terminan los sondeos en vuelo (Ctrl-C otra vez para salir ya)\n";
+        (void)!write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    }
+
+    void install(std::chrono::milliseconds grace) {
+        g_grace_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(grace).count();
+        struct sigaction action{};
+        action.sa_handler = on_signal;
+        sigemptyset(&action.sa_mask);
+        // SA_RESTART para no romper connect()/sendto() a medias; poll y epoll_wait igual vuelven con EINTR
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGTERM, &action, nullptr);
+    }
+
+    bool requested() {
+        return g_deadline_ns.load(std::memory_order_relaxed) != INT64_MAX;
+    }
+
+    Clock::time_point deadline() {
+        int64_t ns = g_deadline_ns.load(std::memory_order_relaxed);
+        if (ns == INT64_MAX) return Clock::time_point::max();
+        return Clock::time_point(std::chrono::nanoseconds(ns));
+    }
+
+    bool expired() {
+        return requested() && Clock::now() >= deadline();
+    }
+
+    std::chrono::milliseconds clamp_wait(std::chrono::milliseconds wait) {
+        if (!requested()) return wait;
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline() - Clock::now());
+        return std::clamp(left, std::chrono::milliseconds(0), wait);
+    }
+
+    void set_position(size_t generated, size_t total) {
+        std::lock_guard<std::mutex> lock(g_progress_mutex);
+        g_progress.position = generated;
+        g_progress.total = total;
+    }
+
+    void abandoned(const ScanTask& task) {
+        std::lock_guard<std::mutex> lock(g_progress_mutex);
+        g_progress.incomplete.push_back(task);
+    }
+
+    void abandoned(const std::vector<ScanTask>& tasks) {
+        if (tasks.empty()) return;
+        std::lock_guard<std::mutex> lock(g_progress_mutex);
+        g_progress.incomplete.insert(g_progress.incomplete.end(), tasks.begin(), tasks.end());
+    }
+
+    Progress progress() {
+        std::lock_guard<std::mutex> lock(g_progress_mutex);
+        Progress copy = g_progress;
+        copy.interrupted = requested();
+        std::sort(copy.incomplete.begin(), copy.incomplete.end(), [](const ScanTask& a, const ScanTask& b) {
+            return a.port != b.port ? a.port < b.port : a.protocol < b.protocol;
+        });
+        return copy;
+    }
+
+}
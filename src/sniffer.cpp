@@ -1,6 +1,11 @@
 #include "include/sniffer.h"
+#include "include/stats.h"
+#include "include/timing.h"
+#include "include/phases.h"
+#include "include/trace.h"
+#include "include/usdt.h"
+#include "include/perf_counters.h"
 #include <iostream>
-#include <netinet/udp.h>
 #include <arpa/inet.h>
 #include <netinet/ip.h>
 #include <netinet/ip_icmp.h>
@@ -23,6 +28,15 @@ struct PcapUserData {
 
     // pointer a la instancia del Sniffer para poder usar sus métodos (stop())
     Sniffer* sniffer_instance;
+
+    // Paquetes que pasaron el BPF pero el handler descartó, solo los toca el hilo de pcap_loop
+    uint64_t ignored = 0;
+
+    // Unidad de pkthdr->ts.tv_usec
+    bool nano_timestamps = false;
+
+    // Del sondeo, para el trace
+    Protocol protocol = Protocol::TCP;
 };
 
 Sniffer::Sniffer(const std::string& iface, const std::string& ip, int port)
@@ -40,44 +54,59 @@ void Sniffer::stop() {
     }
 }
 
-// Función de callback estática que pcap usa para cada paquete
-void Sniffer::packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr, const u_char* packet) {
-    // Transforma el puntero genérico de nuevo a la estructura de datos
-    auto* pcap_data = reinterpret_cast<PcapUserData*>(user_data);
-    
+// En lugar de asumir un tamaño fijo (14 para eth), le preguntas a pcap el tipo de enlace, esto hace
+// que el sniffer sea más portable para eth, wifi, lo. También lo usa el modo replay con el DLT del archivo
+int Sniffer::link_layer_offset(int link_type) {
+    switch (link_type) {
+        case DLT_EN10MB:    return 14; // Ethernet
+        case DLT_NULL:
+        case DLT_LOOP:      return 4;  // Loopback / Null
+        case DLT_LINUX_SLL: return 16; // "any" o capturas hechas con tcpdump -i any
+        case DLT_RAW:       return 0;  // IP pelón sin capa de enlace
+        default:
+            std::cerr << "Link-layer type no reconocido (" << link_type << "). Asumiendo 14 bytes." << std::endl;
+            return 14; // Un valor por defecto
+    }
+}
+
+// Decodifica un paquete de respuesta y determina el estado del puerto. No toca pcap para nada,
+// así que la usan igual el sniffer en vivo y el modo replay (y así dan exactamente lo mismo)
+// Retorna false si el paquete no es para este puerto o viene truncado y hay que ignorarlo
+bool Sniffer::classify_packet(const u_char* packet, uint32_t caplen, uint32_t len,
+                              int link_layer_offset, int target_port, SnifferResult& result) {
+    if (caplen < (uint32_t)link_layer_offset + sizeof(struct ip)) return false;
+
     // Calcula la posición del encabezado IP saltando a la capa de enlace
-    const struct ip* ip_header = (const struct ip*)(packet + pcap_data->link_layer_offset);
+    const struct ip* ip_header = (const struct ip*)(packet + link_layer_offset);
     int ip_header_len = ip_header->ip_hl * 4;
-    
+    const u_char* end = packet + caplen;
+    const u_char* l4 = (const u_char*)ip_header + ip_header_len;
+
     // Esto es el pre-filtrado paca ICMP
     // Un paquete ICMP tiene el header IP/UDP oliginal que lo causó
     // así que se verifica que ese headel corresponde a el sondeo UDP que se hizo
     if (ip_header->ip_p == IPPROTO_ICMP) {
-        const auto* icmp_header = (struct icmp*)((u_char*)ip_header + ip_header_len);
+        if (l4 + 8 > end) return false;
+        const auto* icmp_header = (const struct icmp*)l4;
         if (icmp_header->icmp_type == ICMP_UNREACH && icmp_header->icmp_code == ICMP_UNREACH_PORT) {
             // "Desempaqueta" el header IP y UDP originales del payload ICMP
-            const struct ip* orig_ip = (const struct ip*)((u_char*)icmp_header + 8);
+            const struct ip* orig_ip = (const struct ip*)(l4 + 8);
+            if ((const u_char*)orig_ip + sizeof(struct ip) > end) return false;
             int orig_ip_len = orig_ip->ip_hl * 4;
-            const struct udphdr* orig_udp = (const struct udphdr*)((u_char*)orig_ip + orig_ip_len);
-            
+            const struct udphdr* orig_udp = (const struct udphdr*)((const u_char*)orig_ip + orig_ip_len);
+            if ((const u_char*)orig_udp + sizeof(struct udphdr) > end) return false;
+
             // Si el puerto de destino original NO es el que se está escaneando, se ignora el paquete
-            if (ntohs(orig_udp->uh_dport) != pcap_data->sniffer_instance->target_port) {
-                return;
+            if (ntohs(orig_udp->uh_dport) != target_port) {
+                return false;
             }
         }
     }
-    
-    // Se usa compare_exchange para asegurarse que 1 solo hilo (idealmente solo debería haber 1 hilo
-    // llamando este handler) pueda procesar el primer paquete
-    // Si packet_found_flag ya es true entonces la función retorna y ya
-    bool expected_false = false;
-    if (!pcap_data->packet_found_flag.compare_exchange_strong(expected_false, true)) return;
 
-    SnifferResult result;
     result.packet_found = true;
 
     // Esto copia los primeros bytes del header
-    int bytes_to_copy = std::min((int)pkthdr->len - pcap_data->link_layer_offset, 16);
+    int bytes_to_copy = std::min((int)std::min(len, caplen) - link_layer_offset, 16);
     if (bytes_to_copy > 0) {
         result.header_bytes.assign((const u_char*)ip_header, (const u_char*)ip_header + bytes_to_copy);
     }
@@ -85,7 +114,8 @@ void Sniffer::packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr
     // Esta función determina el estado del puerto basado en el protocolo y las flags del paquete de respuesta
     switch (ip_header->ip_p) {
         case IPPROTO_TCP: {
-            const struct tcphdr* tcp_header = (const struct tcphdr*)((u_char*)ip_header + ip_header_len);
+            if (l4 + sizeof(struct tcphdr) > end) { result.status = PortStatus::UNKNOWN; break; }
+            const struct tcphdr* tcp_header = (const struct tcphdr*)l4;
             if (tcp_header->rst) { // Un pacuete RST significa que está cerrado
                 result.status = PortStatus::CLOSED;
             } else if (tcp_header->syn && tcp_header->ack) { // SYN/ACk significa abierto
@@ -102,7 +132,7 @@ void Sniffer::packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr
             result.status = PortStatus::OPEN;
             break;
         case IPPROTO_ICMP: {
-            const auto* icmp_header = (struct icmp*)((u_char*)ip_header + ip_header_len);
+            const auto* icmp_header = (const struct icmp*)l4;
             // Si recibes un Port Unreachable es literalmente "puerto cerrado"
             if (icmp_header->icmp_type == ICMP_UNREACH && icmp_header->icmp_code == ICMP_UNREACH_PORT) {
                 result.status = PortStatus::CLOSED;
@@ -115,7 +145,109 @@ void Sniffer::packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr
             result.status = PortStatus::UNKNOWN;
             break;
     }
-    
+    return true;
+}
+
+bool Sniffer::response_key(const u_char* packet, uint32_t caplen, int link_layer_offset,
+                           uint32_t target_addr, ResponseKey& key) {
+    key = ResponseKey{};
+    // "src host <objetivo>"
+    if (caplen < (uint32_t)link_layer_offset + sizeof(struct ip)) return false;
+    const struct ip* ip_header = (const struct ip*)(packet + link_layer_offset);
+    if (ip_header->ip_v != 4 || ip_header->ip_src.s_addr != target_addr) return false;
+    const u_char* l4 = (const u_char*)ip_header + ip_header->ip_hl * 4;
+    const u_char* end = packet + caplen;
+
+    switch (ip_header->ip_p) {
+        case IPPROTO_TCP:
+        case IPPROTO_UDP: {
+            if (l4 + 4 > end) return false;
+            int src_port = ntohs(*(const uint16_t*)l4);
+            key.local_port = ntohs(*(const uint16_t*)(l4 + 2));
+            // El filtro TCP en vivo es "src port N" sin protocolo, así que también acepta UDP
+            key.tcp_port = src_port;
+            if (ip_header->ip_p == IPPROTO_UDP) key.udp_port = src_port;
+            return true;
+        }
+        case IPPROTO_ICMP: {
+            // Para el ICMP port unreachable el puerto es el destino del sondeo UDP original
+            if (l4 + 8 + sizeof(struct ip) > end) return false;
+            const auto* icmp_header = (const struct icmp*)l4;
+            if (icmp_header->icmp_type != ICMP_UNREACH || icmp_header->icmp_code != ICMP_UNREACH_PORT) return false;
+            const struct ip* orig_ip = (const struct ip*)(l4 + 8);
+            const u_char* orig_l4 = (const u_char*)orig_ip + orig_ip->ip_hl * 4;
+            if (orig_l4 + sizeof(struct udphdr) > end) return false;
+            key.udp_port = ntohs(((const struct udphdr*)orig_l4)->uh_dport);
+            key.local_port = ntohs(((const struct udphdr*)orig_l4)->uh_sport);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+pcap_t* Sniffer::open_host_capture(const std::string& interface, const std::string& target_ip) {
+    char errbuf[PCAP_ERRBUF_SIZE];
+    pcap_t* capture = pcap_create(interface.c_str(), errbuf);
+    if (!capture) return nullptr;
+
+    // Modo inmediato para que cada paquete llegue en cuanto se captura y no cuando se llene un bloque
+    // Solo interesan los headers, así que el snaplen puede ser chico
+    pcap_set_snaplen(capture, 256);
+    pcap_set_promisc(capture, 1);
+    pcap_set_immediate_mode(capture, 1);
+    pcap_set_buffer_size(capture, 8 * 1024 * 1024);
+    pcap_set_tstamp_precision(capture, PCAP_TSTAMP_PRECISION_NANO); // Para el RTT; si no se puede queda en µs
+    if (pcap_activate(capture) < 0) {
+        pcap_close(capture);
+        return nullptr;
+    }
+
+    // UNA sola captura para todos los puertos, el reparto por puerto se hace en user space
+    std::string filter_exp = "src host " + target_ip + " and (tcp or udp or (icmp and icmp[0] == 3 and icmp[1] == 3))";
+    bpf_program fp;
+    if (pcap_compile(capture, &fp, filter_exp.c_str(), 0, PCAP_NETMASK_UNKNOWN) == -1) { pcap_close(capture); return nullptr; }
+    if (pcap_setfilter(capture, &fp) == -1) { pcap_freecode(&fp); pcap_close(capture); return nullptr; }
+    pcap_freecode(&fp);
+
+    if (pcap_setnonblock(capture, 1, errbuf) == -1 || pcap_get_selectable_fd(capture) < 0) {
+        pcap_close(capture);
+        return nullptr;
+    }
+    return capture;
+}
+
+bool Sniffer::nano_timestamps(pcap_t* handle) {
+    return pcap_get_tstamp_precision(handle) == PCAP_TSTAMP_PRECISION_NANO;
+}
+
+// Función de callback estática que pcap usa para cada paquete
+void Sniffer::packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr, const u_char* packet) {
+    // Transforma el puntero genérico de nuevo a la estructura de datos
+    PerfCounters::Scope classify(PerfCounters::Phase::CLASSIFY);
+    auto* pcap_data = reinterpret_cast<PcapUserData*>(user_data);
+    Usdt::packet_received(pcap_data->sniffer_instance->target_port, pkthdr->caplen,
+                          Timing::pcap_ns(pkthdr->ts, pcap_data->nano_timestamps));
+
+    SnifferResult result;
+    if (!classify_packet(packet, pkthdr->caplen, pkthdr->len, pcap_data->link_layer_offset,
+                         pcap_data->sniffer_instance->target_port, result)) {
+        pcap_data->ignored++;
+        return;
+    }
+    result.capture_ns = Timing::capture_ns(pkthdr->ts, pcap_data->nano_timestamps);
+
+    // Se usa compare_exchange para asegurarse que 1 solo hilo (idealmente solo debería haber 1 hilo
+    // llamando este handler) pueda procesar el primer paquete
+    // Si packet_found_flag ya es true entonces la función retorna y ya
+    bool expected_false = false;
+    if (!pcap_data->packet_found_flag.compare_exchange_strong(expected_false, true)) {
+        pcap_data->ignored++;
+        return;
+    }
+    Trace::event(Trace::Event::MATCHED, pcap_data->protocol, pcap_data->sniffer_instance->target_port);
+    Usdt::classified(pcap_data->sniffer_instance->target_port, pcap_data->protocol, result.status, result.capture_ns);
+
     // Mandas el resultado al hilo principal usando la promise
     pcap_data->result_promise.set_value(std::move(result));
     
@@ -128,25 +260,26 @@ void Sniffer::packet_handler(u_char* user_data, const struct pcap_pkthdr* pkthdr
 
 // Esto configura e inicia el bucle de pcap
 void Sniffer::start(Protocol protocol, std::promise<SnifferResult> result_promise) {
+    // Lo mismo que pcap_open_live(BUFSIZ, promisc, 500 ms) pero por partes, para pedir timestamps en ns
     char errbuf[PCAP_ERRBUF_SIZE];
-    handle = pcap_open_live(interface.c_str(), BUFSIZ, 1, 500, errbuf);
+    int64_t open_start = Phases::now();
+    handle = pcap_create(interface.c_str(), errbuf);
+    if (handle) {
+        pcap_set_snaplen(handle, BUFSIZ);
+        pcap_set_promisc(handle, 1);
+        pcap_set_timeout(handle, 500);
+        pcap_set_tstamp_precision(handle, PCAP_TSTAMP_PRECISION_NANO);
+        if (pcap_activate(handle) < 0) {
+            pcap_close(handle);
+            handle = nullptr;
+        }
+    }
     if (!handle) {
         result_promise.set_value(SnifferResult{}); // Avisa del fallo si no se puede abrir la interfaz
         return;
     }
 
-    // En lugar de asumir un tamaño fijo (14 para eth), le preguntas a pcap el tipo de enlace, esto hace
-    // que el sniffer sea más portable para eth, wifi, lo
-    int link_layer_offset;
-    int link_type = pcap_datalink(handle);
-    if (link_type == DLT_EN10MB) {
-        link_layer_offset = 14; // Ethernet
-    } else if (link_type == DLT_NULL || link_type == DLT_LOOP) {
-        link_layer_offset = 4;  // Loopback / Null
-    } else {
-        std::cerr << "Link-layer type no reconocido (" << link_type << "). Asumiendo 14 bytes." << std::endl;
-        link_layer_offset = 14; // Un valor por defecto
-    }
+    int link_layer_offset = Sniffer::link_layer_offset(pcap_datalink(handle));
     
     // El filtro BPF se compila y se pasa al kernel lo que permite descartar paquetes indeseados a muy bajo nivel.
     // esto hace que tenga menos carga de CPU
@@ -166,15 +299,35 @@ void Sniffer::start(Protocol protocol, std::promise<SnifferResult> result_promis
     if (pcap_compile(handle, &fp, filter_exp.c_str(), 0, PCAP_NETMASK_UNKNOWN) == -1) { pcap_close(handle); handle = nullptr; result_promise.set_value(SnifferResult{}); return; }
     if (pcap_setfilter(handle, &fp) == -1) { pcap_freecode(&fp); pcap_close(handle); handle = nullptr; result_promise.set_value(SnifferResult{}); return; }
     pcap_freecode(&fp); // Ya no se necesita el filtro despues de pcap_setfilter
+    if (open_start > 0) open_ns = static_cast<uint64_t>(Timing::monotonic_ns() - open_start);
+    // Un hilo por sondeo: solo se registra si el sondeo va en el trace
+    if (Trace::traced(protocol, target_port)) {
+        Trace::name_thread("sniffer");
+        Trace::event(Trace::Event::CAPTURE_ARMED, protocol, target_port);
+    }
     
     PcapUserData pcap_data;
     pcap_data.result_promise = std::move(result_promise);
     pcap_data.link_layer_offset = link_layer_offset;
     pcap_data.sniffer_instance = this;
+    pcap_data.nano_timestamps = nano_timestamps(handle);
+    pcap_data.protocol = protocol;
 
     // Este es el bucle de captura, sí es una llamada bloqueante que solo retorna cuando
     // se llama a pcap_breakloop() o hay error. -1 es captura indefinidamente
     pcap_loop(handle, -1, packet_handler, reinterpret_cast<u_char*>(&pcap_data));
+
+    // Antes de cerrar se le piden a pcap sus contadores, si el buffer se desbordó aquí es donde se nota
+    ScanStats::InterfaceCounters counters;
+    counters.interface = interface;
+    counters.ignored = pcap_data.ignored;
+    pcap_stat stats{};
+    if (pcap_stats(handle, &stats) == 0) {
+        counters.received = stats.ps_recv;
+        counters.kernel_dropped = stats.ps_drop;
+        counters.interface_dropped = stats.ps_ifdrop;
+    }
+    ScanStats::record_capture(counters);
     
     pcap_close(handle);
     handle = nullptr;
@@ -185,3 +338,18 @@ void Sniffer::start(Protocol protocol, std::promise<SnifferResult> result_promis
         try { pcap_data.result_promise.set_value(SnifferResult{}); } catch (...) {}
     }
 }
+
+void CaptureSampler::sample(pcap_t* handle, uint64_t ignored_total) {
+    if (!handle) return;
+    pcap_stat now{};
+    if (pcap_stats(handle, &now) != 0) return;
+    ScanStats::InterfaceCounters delta;
+    delta.interface = interface;
+    delta.received = now.ps_recv - last_stats.ps_recv;
+    delta.kernel_dropped = now.ps_drop - last_stats.ps_drop;
+    delta.interface_dropped = now.ps_ifdrop - last_stats.ps_ifdrop;
+    delta.ignored = ignored_total - last_ignored;
+    ScanStats::record_capture(delta);
+    last_stats = now;
+    last_ignored = ignored_total;
+}
@@ -0,0 +1,130 @@
+#include "include/stats.h"
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+namespace ScanStats {
+
+    // Los sondeos se cuentan en cada tarea así que van con atómicos, las capturas solo se registran
+    // una vez por sniffer así que un mutex no estorba
+    static std::atomic<uint64_t> g_probes_sent{0};
+    static std::atomic<uint64_t> g_probes_answered{0};
+    static std::mutex g_capture_mutex;
+    static std::map<std::string, InterfaceCounters> g_interfaces;
+
+    // Un uint64 por puerto con respuesta, a lo más 2 x 65535
+    static std::mutex g_rtt_mutex;
+    static std::vector<uint64_t> g_rtt_samples;
+
+    // En microsegundos, 0 = sin freno
+    static std::atomic<int64_t> g_pacing_us{0};
+    static constexpr int64_t PACING_MIN_US = 1000;
+    static constexpr int64_t PACING_MAX_US = 500000;
+
+    void record_capture(const InterfaceCounters& counters) {
+        {
+            std::lock_guard<std::mutex> lock(g_capture_mutex);
+            auto& acc = g_interfaces[counters.interface];
+            acc.interface = counters.interface;
+            acc.received += counters.received;
+            acc.kernel_dropped += counters.kernel_dropped;
+            acc.interface_dropped += counters.interface_dropped;
+            acc.ignored += counters.ignored;
+        }
+
+        // Si la captura perdió paquetes se duplica la pausa (backoff), si no se relaja un 25%
+        int64_t current = g_pacing_us.load(std::memory_order_relaxed);
+        int64_t next;
+        do {
+            if (counters.kernel_dropped + counters.interface_dropped > 0) {
+                next = std::clamp(current * 2, PACING_MIN_US, PACING_MAX_US);
+            } else {
+                next = current * 3 / 4;
+                if (next < PACING_MIN_US / 4) next = 0;
+            }
+        } while (!g_pacing_us.compare_exchange_weak(current, next, std::memory_order_relaxed));
+    }
+
+    void probe_sent() { g_probes_sent.fetch_add(1, std::memory_order_relaxed); }
+    void probe_answered() { g_probes_answered.fetch_add(1, std::memory_order_relaxed); }
+
+    void record_rtt(uint64_t rtt_ns) {
+        if (rtt_ns == 0) return;
+        std::lock_guard<std::mutex> lock(g_rtt_mutex);
+        g_rtt_samples.push_back(rtt_ns);
+    }
+
+    // Percentil por rango más cercano sobre una copia (nth_element la reordena)
+    static RttSummary rtt_summary() {
+        std::vector<uint64_t> samples;
+        {
+            std::lock_guard<std::mutex> lock(g_rtt_mutex);
+            samples = g_rtt_samples;
+        }
+        RttSummary rtt;
+        rtt.samples = samples.size();
+        if (samples.empty()) return rtt;
+        auto rank = [&](double quantile) {
+            size_t index = static_cast<size_t>(std::ceil(quantile * samples.size()));
+            index = index > 0 ? index - 1 : 0;
+            std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+            return samples[index];
+        };
+        rtt.median_ns = rank(0.5);
+        rtt.p99_ns = rank(0.99);
+        rtt.min_ns = *std::min_element(samples.begin(), samples.end());
+        return rtt;
+    }
+
+    std::chrono::microseconds pacing_delay() {
+        return std::chrono::microseconds(g_pacing_us.load(std::memory_order_relaxed));
+    }
+
+    Summary summary() {
+        Summary result = counters();
+        result.rtt = rtt_summary();
+        return result;
+    }
+
+    Summary counters() {
+        Summary result;
+        {
+            std::lock_guard<std::mutex> lock(g_capture_mutex);
+            for (const auto& [name, counters] : g_interfaces) {
+                result.interfaces.push_back(counters);
+                result.total.received += counters.received;
+                result.total.kernel_dropped += counters.kernel_dropped;
+                result.total.interface_dropped += counters.interface_dropped;
+                result.total.ignored += counters.ignored;
+            }
+        }
+        result.total.interface = "total";
+        result.probes_sent = g_probes_sent.load();
+        result.probes_answered = g_probes_answered.load();
+        return result;
+    }
+
+    void print_summary(const Summary& summary) {
+        std::cout << "\nCAPTURA\t\tRECIBIDOS\tDESC. KERNEL\tDESC. INTERFAZ\tIGNORADOS" << std::endl;
+        for (const auto& c : summary.interfaces) {
+            std::cout << c.interface << "\t\t" << c.received << "\t\t" << c.kernel_dropped
+                      << "\t\t" << c.interface_dropped << "\t\t" << c.ignored << std::endl;
+        }
+        std::cout << "Sondeos enviados: " << summary.probes_sent
+                  << ", con respuesta: " << summary.probes_answered << std::endl;
+        if (summary.rtt.samples > 0) {
+            auto ms = [](uint64_t ns) { return ns / 1e6; };
+            std::cout << "RTT (" << summary.rtt.samples << " respuestas): mín " << ms(summary.rtt.min_ns)
+                      << " ms, mediana " << ms(summary.rtt.median_ns) << " ms, p99 " << ms(summary.rtt.p99_ns) << " ms" << std::endl;
+        }
+
+        // Con pérdida en la captura los filtrados y abierto|filtrado pueden ser falsos
+        if (summary.total.kernel_dropped + summary.total.interface_dropped > 0) {
+            std::cout << "AVISO: se perdieron paquetes en la captura, los puertos filtrados pueden no serlo" << std::endl;
+        }
+    }
+
+}
@@ -0,0 +1,193 @@
+#include "include/trace.h"
+#include "include/timing.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace Trace {
+
+    // Tope por hilo (16 bytes por evento): un escaneo completo TCP+UDP son ~1M eventos en total,
+    // más que eso en un solo hilo es que algo anda mal y no vale la pena quedarse sin memoria
+    static constexpr size_t MAX_EVENTS_PER_THREAD = 8u << 20;
+    // Se escribe en tramos para no armar el archivo entero en memoria
+    static constexpr size_t FLUSH_BYTES = 1 << 20;
+
+    static constexpr const char* EVENT_NAMES[] = {
+        "tomado", "socket", "enviado", "captura lista", "respuesta", "timeout", "guardado", "descartado",
+    };
+
+    struct Record {
+        int64_t ts_ns;
+        uint16_t port;
+        Protocol protocol;
+        Event event;
+    };
+
+    struct ThreadBuffer {
+        long tid = 0;
+        std::string name;
+        std::vector<Record> records;
+        uint64_t dropped = 0;
+    };
+
+    static bool g_enabled = false;
+    static uint32_t g_sample = 1;
+    static int64_t g_start_ns = 0;
+
+    // Los buffers son del registro, así sobreviven a los hilos (el motor de hilos crea uno por sniffer)
+    static std::mutex g_registry_mutex;
+    static std::vector<std::unique_ptr<ThreadBuffer>> g_registry;
+    static thread_local ThreadBuffer* t_buffer = nullptr;
+
+    static ThreadBuffer& local_buffer() {
+        if (!t_buffer) {
+            auto owned = std::make_unique<ThreadBuffer>();
+            owned->tid = syscall(SYS_gettid);
+            t_buffer = owned.get();
+            std::lock_guard<std::mutex> lock(g_registry_mutex);
+            g_registry.push_back(std::move(owned));
+        }
+        return *t_buffer;
+    }
+
+    // El mismo sondeo cae siempre del mismo lado, lo vea el hilo que lo vea
+    static bool sampled(Protocol protocol, int port) {
+        if (g_sample <= 1) return true;
+        uint64_t x = task_slot(protocol, port) + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return ((x ^ (x >> 31)) % g_sample) == 0;
+    }
+
+    bool traced(Protocol protocol, int port) {
+        return g_enabled && sampled(protocol, port);
+    }
+
+    void enable(uint32_t sample) {
+        g_enabled = true;
+        g_sample = sample == 0 ? 1 : sample;
+        g_start_ns = Timing::monotonic_ns();
+    }
+
+    bool enabled() {
+        return g_enabled;
+    }
+
+    void name_thread(const std::string& name) {
+        if (!g_enabled) return;
+        local_buffer().name = name;
+    }
+
+    static void store(Event event, Protocol protocol, int port, int64_t ts_ns) {
+        ThreadBuffer& buffer = local_buffer();
+        if (buffer.records.size() >= MAX_EVENTS_PER_THREAD) {
+            ++buffer.dropped;
+            return;
+        }
+        buffer.records.push_back({ts_ns, static_cast<uint16_t>(port), protocol, event});
+    }
+
+    void event_at(Event event, Protocol protocol, int port, int64_t ts_ns) {
+        if (traced(protocol, port)) store(event, protocol, port, ts_ns);
+    }
+
+    // El reloj se lee solo si el sondeo va en la muestra
+    void event(Event event, Protocol protocol, int port) {
+        if (traced(protocol, port)) store(event, protocol, port, Timing::monotonic_ns());
+    }
+
+    // ts de Chrome va en µs, con decimales para no perder los ns
+    static void append_ts(std::string& out, int64_t ts_ns) {
+        int64_t relative = std::max<int64_t>(0, ts_ns - g_start_ns);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%lld.%03lld", (long long)(relative / 1000), (long long)(relative % 1000));
+        out += text;
+    }
+
+    static void append_record(std::string& out, long tid, const Record& record) {
+        const char* protocol = record.protocol == Protocol::TCP ? "tcp" : "udp";
+        char head[160];
+        std::snprintf(head, sizeof(head), "{\"pid\":1,\"tid\":%ld,\"ts\":", tid);
+
+        // El tramo async del sondeo, id = su slot (único en el escaneo)
+        bool begins = record.event == Event::DEQUEUED;
+        bool ends = record.event == Event::STORED || record.event == Event::DISCARDED;
+        if (begins || ends) {
+            out += head;
+            append_ts(out, record.ts_ns);
+            char span[128];
+            std::snprintf(span, sizeof(span), ",\"ph\":\"%c\",\"cat\":\"sondeo\",\"id\":%zu,\"name\":\"%s/%u\"},\n",
+                          begins ? 'b' : 'e', task_slot(record.protocol, record.port), protocol, record.port);
+            out += span;
+        }
+
+        out += head;
+        append_ts(out, record.ts_ns);
+        char instant[160];
+        std::snprintf(instant, sizeof(instant),
+                      ",\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"args\":{\"port\":%u,\"protocol\":\"%s\"}},\n",
+                      EVENT_NAMES[static_cast<size_t>(record.event)], record.port, protocol);
+        out += instant;
+    }
+
+    static void append_json_string(std::string& out, const std::string& text) {
+        out += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            out += c;
+        }
+        out += '"';
+    }
+
+    bool write(const std::string& path) {
+        std::ofstream o(path, std::ios::binary);
+        if (!o) {
+            std::cerr << "Error al escribir " << path << std::endl;
+            return false;
+        }
+        std::string out;
+        out.reserve(FLUSH_BYTES + 4096);
+        out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        out += "{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"name\":\"process_name\",\"args\":{\"name\":\"escaner\"}},\n";
+
+        uint64_t events = 0, dropped = 0;
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        for (const auto& buffer : g_registry) {
+            if (!buffer->name.empty() && !buffer->records.empty()) {
+                char head[96];
+                std::snprintf(head, sizeof(head), "{\"pid\":1,\"tid\":%ld,\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":", buffer->tid);
+                out += head;
+                append_json_string(out, buffer->name);
+                out += "}},\n";
+            }
+            for (const Record& record : buffer->records) {
+                append_record(out, buffer->tid, record);
+                if (out.size() >= FLUSH_BYTES) {
+                    o.write(out.data(), static_cast<std::streamsize>(out.size()));
+                    out.clear();
+                }
+            }
+            events += buffer->records.size();
+            dropped += buffer->dropped;
+        }
+        // Un metadato al final para no tener que quitar la última coma
+        out += "{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"name\":\"process_labels\",\"args\":{\"labels\":\"1 de cada ";
+        out += std::to_string(g_sample) + " sondeos\"}}\n]}\n";
+        o.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!o) {
+            std::cerr << "Error al escribir " << path << std::endl;
+            return false;
+        }
+        std::cout << "Trace con " << events << " eventos en " << path;
+        if (dropped > 0) std::cout << " (" << dropped << " descartados por el tope por hilo)";
+        std::cout << std::endl;
+        return true;
+    }
+
+}
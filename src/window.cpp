@@ -0,0 +1,107 @@
+#include "include/window.h"
+#include "include/metrics.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <algorithm>
+#include <sys/resource.h>
+
+// Límites del modo auto. Arriba de unos miles de sondeos en vuelo la captura y la red del objetivo
+// son el cuello de botella, no los fds, así que no se pasa de AUTO_MAX aunque sobren recursos
+static constexpr size_t AUTO_MAX = 4096;
+static constexpr size_t HARD_MAX = 65536;
+static constexpr size_t RESERVED_FDS = 64; // stdio, el archivo de salida, epoll, la captura del motor...
+
+InflightWindow::InflightWindow(size_t limit) : max_inflight(std::max<size_t>(1, limit)) {}
+
+void InflightWindow::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (count >= max_inflight) {
+        ++waiters;
+        cv.wait(lock, [this] { return count < max_inflight; });
+        --waiters;
+    }
+    ++count;
+    Metrics::inflight_add(1);
+}
+
+bool InflightWindow::try_acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count >= max_inflight) return false;
+    ++count;
+    Metrics::inflight_add(1);
+    return true;
+}
+
+void InflightWindow::release(size_t n) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Metrics::inflight_add(-static_cast<int64_t>(std::min(n, count)));
+        count -= std::min(n, count);
+        wake = waiters > 0;
+    }
+    if (wake) cv.notify_all();
+}
+
+size_t InflightWindow::in_flight() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+static uint64_t available_memory_bytes() {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    uint64_t value;
+    std::string unit;
+    while (meminfo >> key >> value >> unit) {
+        if (key == "MemAvailable:") return value * 1024;
+    }
+    return 0;
+}
+
+// Cada sondeo del motor de hilos tiene su socket, su handle de pcap con buffer propio y un hilo de
+// sniffer; en los motores asíncronos es un socket y unos cientos de bytes de estado (lo demás es el
+// buffer del socket en el kernel)
+static size_t fds_per_probe(ScanEngine engine) {
+    return (engine == ScanEngine::THREADS) ? 3 : 1;
+}
+
+static uint64_t bytes_per_probe(ScanEngine engine) {
+    return (engine == ScanEngine::THREADS) ? (4u << 20) : (16u << 10);
+}
+
+// Sondeos que caben en RLIMIT_NOFILE, subiendo antes el límite soft hasta el hard
+static size_t fd_budget(ScanEngine engine) {
+    rlimit nofile{};
+    if (getrlimit(RLIMIT_NOFILE, &nofile) != 0) return HARD_MAX;
+    if (nofile.rlim_cur < nofile.rlim_max) {
+        rlimit raised = nofile;
+        raised.rlim_cur = nofile.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &raised) == 0) nofile = raised;
+    }
+    if (nofile.rlim_cur == RLIM_INFINITY) return HARD_MAX;
+    size_t usable = nofile.rlim_cur > RESERVED_FDS ? nofile.rlim_cur - RESERVED_FDS : 1;
+    return std::max<size_t>(1, usable / fds_per_probe(engine));
+}
+
+size_t InflightWindow::auto_limit(ScanEngine engine) {
+    // Como mucho una cuarta parte de la memoria libre
+    size_t memory_budget = HARD_MAX;
+    uint64_t available = available_memory_bytes();
+    if (available > 0) memory_budget = (size_t)std::min<uint64_t>(HARD_MAX, available / 4 / bytes_per_probe(engine));
+
+    return std::clamp<size_t>(std::min({fd_budget(engine), memory_budget, AUTO_MAX}), 1, HARD_MAX);
+}
+
+size_t InflightWindow::resolve(const AppConfig& config) {
+    if (config.max_inflight == 0) return auto_limit(config.engine);
+
+    size_t fds = fd_budget(config.engine);
+    size_t limit = std::min(config.max_inflight, HARD_MAX);
+    if (limit > fds) {
+        std::cerr << "AVISO: --max-inflight " << limit << " no cabe en RLIMIT_NOFILE, se usa " << fds << std::endl;
+        limit = fds;
+    }
+    return limit;
+}
@@ -0,0 +1,506 @@
+// Pruebas de las piezas que no necesitan red ni root. Cada caso imprime "ok" o "FALLA" con el detalle y
+// el programa sale con 1 si falló alguno
+//
+//   make check              compila esto, lo corre y después corre tests/cli.sh
+//
+// La referencia del JSON es nlohmann (src/include/nlohmann), que JsonWriter tiene que igualar byte a byte
+#include "json_writer.h"
+#include "JSONGen.h"
+#include "args.h"
+#include "binary_report.h"
+#include "diff.h"
+#include "journal.h"
+#include "nlohmann/json.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+    int g_passed = 0;
+    int g_failed = 0;
+
+    void check(bool ok, const std::string& name, const std::string& detail = "") {
+        if (ok) {
+            std::cout << "ok     " << name << "\n";
+            ++g_passed;
+        } else {
+            std::cout << "FALLA  " << name << (detail.empty() ? "" : ": " + detail) << "\n";
+            ++g_failed;
+        }
+    }
+
+    // Para los mensajes: lo que no es ASCII imprimible como \xNN
+    std::string printable(const std::string& text) {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string out;
+        for (unsigned char c : text) {
+            if (c >= 0x20 && c < 0x7f) {
+                out += static_cast<char>(c);
+            } else {
+                out += "\\x";
+                out += digits[c >> 4];
+                out += digits[c & 0x0f];
+            }
+        }
+        return out;
+    }
+
+    bool parses(const std::string& json) {
+        return nlohmann::json::accept(json);
+    }
+
+    // Mismo texto que nlohmann con error_handler_t::replace y JSON que se deja leer (nlohmann::accept
+    // rechaza el UTF-8 mal formado)
+    void json_writer_utf8() {
+        const std::vector<std::pair<std::string, std::string>> cases = {
+            {"UTF-8 válido", "SSH-2.0-OpenSSH ñandú € \xf0\x9f\x98\x80"},
+            {"Latin-1", "Servidor caf\xe9 listo"},
+            {"byte suelto 0xff", "SSH-2.0-\xff\xfe\r\n"},
+            {"continuación sin inicio", "a\x80z"},
+            {"secuencia cortada al final", "220 \xe2\x82"},
+            {"secuencia cortada a la mitad", "a\xc3(b"},
+            {"sobrelarga", "\xc0\xaf \xe0\x80\xaf \xf0\x80\x80\xaf"},
+            {"surrogate", "\xed\xa0\x80"},
+            {"más allá de U+10FFFF", "\xf4\x90\x80\x80 \xf5\x80"},
+            {"controles y comillas", "\"\\\b\f\n\r\t\x01\x1f\x7f"},
+        };
+        for (const auto& [name, text] : cases) {
+            JsonWriter writer;
+            writer.value(text);
+            std::string expected = nlohmann::json(text).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            check(writer.buffer() == expected && parses(writer.buffer()), "JsonWriter: " + name,
+                  printable(writer.buffer()) + " en lugar de " + printable(expected));
+        }
+    }
+
+    // Un banner que no es UTF-8 no puede romper la línea de NDJSON
+    void ndjson_banner() {
+        AppConfig config;
+        config.target_ip = "10.0.0.5";
+        ScanResult result;
+        result.port = 21;
+        result.protocol = Protocol::TCP;
+        result.status = PortStatus::OPEN;
+        result.service = "ftp";
+        result.banner = "220 Bienvenido \xe0 FTP\xff\r\n";
+        std::string line = JSONGenerator::result_line(config, result);
+        bool ok = parses(line);
+        check(ok, "NDJSON: banner que no es UTF-8", printable(line));
+        if (ok) {
+            std::string banner = nlohmann::json::parse(line)["banner"];
+            check(banner == "220 Bienvenido \xef\xbf\xbd FTP\xef\xbf\xbd\r\n", "NDJSON: banner con U+FFFD", printable(banner));
+        }
+    }
+
+    // Directorio temporal para los archivos de las pruebas, main lo borra al final
+    const std::string& temp_dir() {
+        static const std::string dir = [] {
+            char pattern[] = "/tmp/escaner-unit-XXXXXX";
+            return std::string(mkdtemp(pattern) ? pattern : "");
+        }();
+        return dir;
+    }
+
+    std::string read_file(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    void write_file(const std::string& path, const std::string& content) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    }
+
+    uint64_t align_up(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    // Misma línea que escribe el journal: "cuerpo *fnv1a"
+    std::string journal_line(const std::string& body) {
+        uint32_t hash = 2166136261u;
+        for (unsigned char c : body) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+        char checksum[16];
+        snprintf(checksum, sizeof(checksum), " *%08x\n", hash);
+        return body + checksum;
+    }
+
+    AppConfig journal_config() {
+        AppConfig config;
+        config.target_ip = "10.0.0.5";
+        config.protocols_to_scan = {Protocol::TCP};
+        config.ports = {21, 22, 80};
+        return config;
+    }
+
+    const ScanResult* find_result(const std::vector<ScanResult>& results, int port) {
+        for (const auto& result : results)
+            if (result.port == port) return &result;
+        return nullptr;
+    }
+
+    // Retoma el journal y devuelve lo recuperado. close() agrega un checkpoint "C <position> <resultados>";
+    // size queda con el largo sin esa línea, o sea lo que quedó después del recorte (npos si no está)
+    bool resume_journal(const std::string& path, size_t position, AppConfig& config, std::vector<ScanResult>& results,
+                        size_t& size) {
+        bool ok = Journal::resume(path, config, results);
+        Journal::close();
+        const std::string content = read_file(path);
+        const std::string checkpoint = journal_line("C " + std::to_string(position) + " " + std::to_string(results.size()));
+        bool closed = content.size() >= checkpoint.size() && content.ends_with(checkpoint);
+        size = closed ? content.size() - checkpoint.size() : std::string::npos;
+        return ok;
+    }
+
+    // --resume: lo que quedó sano se recupera y lo roto del final se corta
+    void journal_resume() {
+        if (temp_dir().empty()) {
+            check(false, "Journal: directorio temporal");
+            return;
+        }
+        const std::string path = temp_dir() + "/journal";
+        AppConfig original = journal_config();
+        if (!Journal::open(path, original)) {
+            check(false, "Journal: abrir", path);
+            return;
+        }
+        ScanResult ssh;
+        ssh.port = 22;
+        ssh.status = PortStatus::OPEN;
+        ssh.header_bytes = {0x45, 0x00, 0x00, 0x2c};
+        ssh.banner = "SSH-2.0-OpenSSH\r\n";
+        ssh.rtt_ns = 1234;
+        ScanResult http;
+        http.port = 80;
+        http.status = PortStatus::CLOSED;
+        Journal::record(ssh);
+        Journal::record(http);
+        Journal::set_position(2);
+        Journal::close();
+        const std::string intact = read_file(path);
+
+        {
+            AppConfig config = journal_config();
+            config.ports.clear(); // Los puertos salen del encabezado del journal
+            std::vector<ScanResult> results;
+            size_t size;
+            bool ok = resume_journal(path, 2, config, results, size);
+            const ScanResult* got = find_result(results, 22);
+            check(ok && results.size() == 2 && config.ports == original.ports, "Journal: retomar completo",
+                  std::to_string(results.size()) + " resultados");
+            check(config.resume_done.size() == TASK_SLOTS && config.resume_done[task_slot(Protocol::TCP, 22)] &&
+                      config.resume_done[task_slot(Protocol::TCP, 80)] && !config.resume_done[task_slot(Protocol::TCP, 21)] &&
+                      !config.resume_done[task_slot(Protocol::UDP, 22)],
+                  "Journal: resume_done");
+            check(got && got->status == PortStatus::OPEN && got->banner == ssh.banner &&
+                      got->header_bytes == ssh.header_bytes && got->rtt_ns == 1234,
+                  "Journal: resultado recuperado", got ? printable(got->banner) : "falta el 22");
+            check(size == intact.size(), "Journal: sano no se recorta", std::to_string(size));
+        }
+
+        // Corte a medio escribir: la última línea no llegó al '\n'
+        {
+            write_file(path, intact + "R 21 T 0 - - 99 *");
+            AppConfig config = journal_config();
+            std::vector<ScanResult> results;
+            size_t size;
+            bool ok = resume_journal(path, 2, config, results, size);
+            check(ok && results.size() == 2 && !config.resume_done[task_slot(Protocol::TCP, 21)] && size == intact.size(),
+                  "Journal: última línea a medias", std::to_string(results.size()) + " resultados, " + std::to_string(size) + " bytes");
+        }
+
+        // Checksum que no coincide: se corta desde ahí, también lo que venga después
+        {
+            write_file(path, intact + "R 21 T 0 - - 99 *00000000\n" + journal_line("R 443 T 0 - - 7"));
+            AppConfig config = journal_config();
+            std::vector<ScanResult> results;
+            size_t size;
+            bool ok = resume_journal(path, 2, config, results, size);
+            check(ok && results.size() == 2 && !config.resume_done[task_slot(Protocol::TCP, 21)] && size == intact.size(),
+                  "Journal: checksum malo", std::to_string(results.size()) + " resultados, " + std::to_string(size) + " bytes");
+        }
+
+        // Línea vieja sin RTT y un slot repetido: vale la primera vez que aparece
+        {
+            const std::string grown = intact + journal_line("R 21 T 0 - 6869") + journal_line("R 22 T 1 - - 99") +
+                                      journal_line("C 3 4");
+            write_file(path, grown);
+            AppConfig config = journal_config();
+            std::vector<ScanResult> results;
+            size_t size;
+            bool ok = resume_journal(path, 3, config, results, size);
+            const ScanResult* ftp = find_result(results, 21);
+            const ScanResult* ssh_again = find_result(results, 22);
+            check(ok && ftp && ftp->status == PortStatus::OPEN && ftp->banner == "hi" && ftp->rtt_ns == 0 &&
+                      config.resume_done[task_slot(Protocol::TCP, 21)],
+                  "Journal: línea sin RTT", ftp ? std::to_string(ftp->rtt_ns) : "falta el 21");
+            check(results.size() == 3 && ssh_again && ssh_again->status == PortStatus::OPEN && ssh_again->rtt_ns == 1234,
+                  "Journal: slot repetido", std::to_string(results.size()) + " resultados");
+            check(size == grown.size(), "Journal: líneas válidas no se recortan", std::to_string(size));
+        }
+    }
+
+    // Reporte binario: escribir, abrir con mmap y leer lo mismo de vuelta
+    void binary_roundtrip() {
+        if (temp_dir().empty()) return;
+        AppConfig config;
+        config.target_ip = "10.0.0.5";
+        config.binary_file = temp_dir() + "/reporte.bin";
+        ScanResult ssh;
+        ssh.port = 22;
+        ssh.status = PortStatus::OPEN;
+        ssh.service = "ssh";
+        ssh.header_bytes = {0x45, 0x00, 0x00, 0x2c, 0x12, 0x34};
+        ssh.banner = "SSH-2.0-OpenSSH\r\n";
+        ssh.rtt_ns = 4321;
+        ScanResult dns;
+        dns.port = 53;
+        dns.protocol = Protocol::UDP;
+        dns.status = PortStatus::OPEN_FILTERED;
+        dns.service = "domain";
+        ScanResult http;
+        http.port = 80;
+        http.status = PortStatus::CLOSED;
+        http.service = "http";
+        if (!BinaryReport::write(config, {dns, http, ssh})) {
+            check(false, "Binario: escribir", config.binary_file);
+            return;
+        }
+
+        BinaryReport::MappedFile file;
+        std::string error;
+        if (!file.open(config.binary_file, error)) {
+            check(false, "Binario: abrir", error);
+            return;
+        }
+        // Los cerrados no van y el orden es (puerto, protocolo)
+        check(file.size() == 2, "Binario: sin cerrados", std::to_string(file.size()) + " registros");
+        if (file.size() != 2) return;
+        const BinaryReport::Record& first = file.record(0);
+        const BinaryReport::Record& second = file.record(1);
+        uint32_t ipv4 = 0;
+        BinaryReport::parse_ipv4(config.target_ip, ipv4);
+        check(file.valid(first) && first.ipv4 == ipv4 && first.port == 22 &&
+                  first.status == static_cast<uint8_t>(PortStatus::OPEN) && first.rtt_ns == 4321 &&
+                  file.service(first.service_id) == "ssh" && file.banner(first) == ssh.banner &&
+                  std::vector<unsigned char>(first.header, first.header + first.header_len) == ssh.header_bytes,
+              "Binario: registro TCP", printable(std::string(file.banner(first))));
+        check(file.valid(second) && second.port == 53 && second.protocol == static_cast<uint8_t>(Protocol::UDP) &&
+                  second.status == static_cast<uint8_t>(PortStatus::OPEN_FILTERED) &&
+                  file.service(second.service_id) == "domain" && file.banner(second).empty() && second.header_len == 0,
+              "Binario: registro UDP");
+        uint64_t start = 0, count = 0;
+        bool found = file.host_range(ipv4, start, count);
+        check(found && start == 0 && count == 2 && !file.host_range(ipv4 + 1, start, count) &&
+                  file.by_port(0) == 0 && file.by_port(1) == 1,
+              "Binario: índices por host y por puerto");
+    }
+
+    // Cabecera, tabla de servicios o índice por host que apuntan fuera del archivo: open tiene que rechazarlo
+    void binary_bad_offsets() {
+        if (temp_dir().empty()) return;
+        const std::string good = read_file(temp_dir() + "/reporte.bin");
+        if (good.size() < sizeof(BinaryReport::FileHeader)) {
+            check(false, "Binario: archivo base", std::to_string(good.size()) + " bytes");
+            return;
+        }
+        BinaryReport::FileHeader header;
+        std::memcpy(&header, good.data(), sizeof(header));
+        const std::string path = temp_dir() + "/roto.bin";
+
+        auto rejected = [&](const std::string& name, const std::string& content) {
+            write_file(path, content);
+            BinaryReport::MappedFile file;
+            std::string error;
+            bool opened = file.open(path, error);
+            check(!opened && !error.empty(), "Binario: " + name, opened ? "se abrió" : error);
+        };
+        auto patched = [&](size_t offset, uint64_t value, size_t size) {
+            std::string content = good;
+            std::memcpy(content.data() + offset, &value, size);
+            return content;
+        };
+        const uint64_t length = good.size();
+
+        rejected("header_size más allá del final", patched(offsetof(BinaryReport::FileHeader, header_size), 0xfff8, 2));
+        rejected("sección dentro de la cabecera", patched(offsetof(BinaryReport::FileHeader, banners_offset), 64, 8));
+        rejected("servicios más allá del final", patched(offsetof(BinaryReport::FileHeader, services_offset), align_up(length), 8));
+        rejected("servicios con tamaño de más", patched(offsetof(BinaryReport::FileHeader, services_size), length, 8));
+        rejected("servicios con offset que desborda", patched(offsetof(BinaryReport::FileHeader, services_offset), UINT64_MAX - 3, 8));
+        rejected("cuenta de servicios de más", patched(header.services_offset, 0x10000, 4));
+        rejected("índice por host más allá del final", patched(offsetof(BinaryReport::FileHeader, hosts_offset), align_up(length), 8));
+        rejected("rango de host fuera de los registros",
+                 patched(header.hosts_offset + offsetof(BinaryReport::HostIndex, first), header.record_count, 8));
+        rejected("archivo cortado", good.substr(0, header.hosts_offset));
+    }
+
+    // Lo que fn escribe en stdout (cout y fwrite), para revisar la salida de los subcomandos
+    std::string capture_stdout(const std::function<void()>& fn) {
+        const std::string path = temp_dir() + "/stdout";
+        std::cout.flush();
+        fflush(stdout);
+        int saved = dup(STDOUT_FILENO);
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(fd, STDOUT_FILENO);
+        ::close(fd);
+        fn();
+        std::cout.flush();
+        fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        ::close(saved);
+        return read_file(path);
+    }
+
+    // "diff ANTERIOR NUEVO --json": código de salida y los cambios, uno por línea
+    int run_diff(const std::string& before, const std::string& after, std::string& output) {
+        std::vector<std::string> args = {"escaner", "diff", before, after, "--json"};
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(arg.data());
+        int code = 0;
+        output = capture_stdout([&] { code = Diff::run(static_cast<int>(argv.size()), argv.data()); });
+        return code;
+    }
+
+    std::string ndjson_file(const std::string& name, const std::vector<std::string>& lines) {
+        std::string content;
+        for (const auto& line : lines) content += line + "\n";
+        const std::string path = temp_dir() + "/" + name;
+        write_file(path, content);
+        return path;
+    }
+
+    std::string ndjson_entry(int port, const std::string& status, const std::string& header = "") {
+        return "{\"header_bytes\":\"" + header + "\",\"ip\":\"10.0.0.5\",\"port\":" + std::to_string(port) +
+               ",\"protocol\":\"TCP\",\"service\":\"x\",\"status\":\"" + status + "\"}";
+    }
+
+    bool has_change(const std::string& output, const std::string& change, int port, const std::string& before,
+                    const std::string& after) {
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (!parses(line)) continue;
+            auto json = nlohmann::json::parse(line);
+            if (json["change"] == change && json["port"] == port && json["before"] == before && json["after"] == after)
+                return true;
+        }
+        return false;
+    }
+
+    // diff: merge de dos entradas ordenadas, lo que está de un solo lado va contra "closed"
+    void diff_merge() {
+        if (temp_dir().empty()) return;
+        std::string output;
+
+        int code = run_diff(ndjson_file("a.ndjson", {ndjson_entry(22, "open"), ndjson_entry(53, "filtered")}),
+                            ndjson_file("b.ndjson", {ndjson_entry(80, "open"), ndjson_entry(53, "filtered")}), output);
+        check(code == 1 && has_change(output, "closed", 22, "open", "closed") &&
+                  has_change(output, "opened", 80, "closed", "open") && output.find("\"port\":53") == std::string::npos,
+              "Diff: puertos de un solo lado", printable(output));
+
+        code = run_diff(ndjson_file("a.ndjson", {ndjson_entry(22, "open")}), ndjson_file("b.ndjson", {ndjson_entry(22, "open")}),
+                        output);
+        check(code == 0 && output.empty(), "Diff: sin cambios", printable(output));
+
+        // Solo cambian la identificación (bytes 4-5) y el checksum (10-11) de la cabecera IPv4
+        const std::string header = "45 00 00 1c 12 34 00 00 40 11 ab cd 0a 00 00 05";
+        const std::string other_id = "45 00 00 1c 56 78 00 00 40 11 ef 01 0a 00 00 05";
+        const std::string other_ttl = "45 00 00 1c 12 34 00 00 3f 11 ab cd 0a 00 00 05";
+        code = run_diff(ndjson_file("a.ndjson", {ndjson_entry(53, "open", header)}),
+                        ndjson_file("b.ndjson", {ndjson_entry(53, "open", other_id)}), output);
+        check(code == 0, "Diff: se ignoran id y checksum IPv4", printable(output));
+        code = run_diff(ndjson_file("a.ndjson", {ndjson_entry(53, "open", header)}),
+                        ndjson_file("b.ndjson", {ndjson_entry(53, "open", other_ttl)}), output);
+        check(code == 1 && has_change(output, "header", 53, header, other_ttl), "Diff: cambio en el resto de la cabecera",
+              printable(output));
+
+        // El reporte de -o se lee en streaming, así que tiene que venir ordenado
+        const std::string unordered = temp_dir() + "/desordenado.json";
+        write_file(unordered, "{\"results\":[" + ndjson_entry(80, "open") + "," + ndjson_entry(22, "open") + "]}");
+        code = run_diff(unordered, ndjson_file("b.ndjson", {ndjson_entry(22, "open")}), output);
+        check(code == 2, "Diff: entrada desordenada", "salió con " + std::to_string(code));
+
+        // open|filtered contra unknown: el binario los distingue, el JSON no
+        AppConfig config;
+        config.target_ip = "10.0.0.5";
+        ScanResult result;
+        result.port = 53;
+        result.protocol = Protocol::UDP;
+        result.service = "domain";
+        result.status = PortStatus::OPEN_FILTERED;
+        config.binary_file = temp_dir() + "/open_filtered.bin";
+        BinaryReport::write(config, {result});
+        result.status = PortStatus::UNKNOWN;
+        config.binary_file = temp_dir() + "/unknown.bin";
+        BinaryReport::write(config, {result});
+        code = run_diff(temp_dir() + "/open_filtered.bin", temp_dir() + "/unknown.bin", output);
+        check(code == 1 && has_change(output, "status", 53, "open_filtered", "unknown"), "Diff: open_filtered contra unknown",
+              printable(output));
+        const std::string json_unknown = ndjson_file(
+            "unknown.ndjson",
+            {"{\"ip\":\"10.0.0.5\",\"port\":53,\"protocol\":\"UDP\",\"service\":\"domain\",\"status\":\"unknown\"}"});
+        code = run_diff(temp_dir() + "/open_filtered.bin", json_unknown, output);
+        check(code == 0, "Diff: unknown del JSON contra open_filtered", printable(output));
+    }
+
+    // --diff: lo que el escaneo no sondeó (fuera de -p o sin terminar al interrumpir) no cuenta como cerrado
+    void diff_scope() {
+        if (temp_dir().empty()) return;
+        const std::string previous =
+            ndjson_file("anterior.ndjson", {ndjson_entry(22, "open"), ndjson_entry(80, "open"), ndjson_entry(443, "open")});
+        AppConfig config;
+        config.target_ip = "10.0.0.5";
+        config.protocols_to_scan = {Protocol::TCP};
+        config.ports = {22, 80};
+        ScanResult ssh;
+        ssh.port = 22;
+        ssh.status = PortStatus::OPEN;
+        ssh.service = "x";
+        Shutdown::Progress progress;
+        progress.total = 2;
+        bool ok = false;
+
+        std::string output = capture_stdout([&] { ok = Diff::against(config, {ssh}, previous, progress); });
+        check(ok && output.find("\t80/TCP") != std::string::npos && output.find("443") == std::string::npos,
+              "Diff: --diff solo dentro de -p", printable(output));
+
+        // Interrumpido después del 22: el 80 no se volvió a ver
+        progress.interrupted = true;
+        progress.position = 1;
+        output = capture_stdout([&] { ok = Diff::against(config, {ssh}, previous, progress); });
+        check(ok && output.find("Sin cambios.") != std::string::npos, "Diff: --diff interrumpido", printable(output));
+
+        // En vuelo al interrumpir tampoco cuenta
+        progress.position = 2;
+        progress.incomplete = {{80, Protocol::TCP}};
+        output = capture_stdout([&] { ok = Diff::against(config, {ssh}, previous, progress); });
+        check(ok && output.find("Sin cambios.") != std::string::npos, "Diff: --diff con sondeos en vuelo", printable(output));
+    }
+
+}
+
+int main() {
+    json_writer_utf8();
+    ndjson_banner();
+    journal_resume();
+    binary_roundtrip();
+    binary_bad_offsets();
+    diff_merge();
+    diff_scope();
+    if (!temp_dir().empty()) std::filesystem::remove_all(temp_dir());
+    std::cout << g_passed << " bien, " << g_failed << " mal" << std::endl;
+    return g_failed == 0 ? 0 : 1;
+}